@@ -2,7 +2,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "abb.h"
-#include "pila.h"
+#include "pool.h"
 
 typedef struct abb_nodo abb_nodo_t;
 
@@ -11,6 +11,7 @@ struct abb_nodo {
 	void* dato;
 	abb_nodo_t* izq;
 	abb_nodo_t* der;
+	abb_nodo_t* padre;
 };
 
 struct abb {
@@ -18,11 +19,11 @@ struct abb {
 	size_t cantidad;
 	abb_comparar_clave_t comparar;
 	abb_destruir_dato_t destruir;
+	pool_t* pool;
 };
 
 struct abb_iter {
-	pila_t* pila;
-	abb_nodo_t* actual;
+	abb_recorrido_t recorrido;
 };
 
 /* *****************************************************************
@@ -42,24 +43,26 @@ char* crear_clave(const char* clave){
 // Crea un nuevo nodo del árbol
 // Pre: Ninguna.
 // Post: Devuelve un nuevo nodo hoja.
-abb_nodo_t* abb_nodo_crear(const char* clave, void* dato) {
-	abb_nodo_t* nodo = malloc(sizeof(abb_nodo_t));
+abb_nodo_t* abb_nodo_crear(abb_t* arbol, const char* clave, void* dato) {
+	abb_nodo_t* nodo = arbol->pool ? pool_pedir(arbol->pool) : malloc(sizeof(abb_nodo_t));
 	if (!nodo) return NULL;
 	nodo->clave = crear_clave(clave);
 	nodo->dato = dato;
 	nodo->izq = NULL,
 	nodo->der = NULL;
+	nodo->padre = NULL;
 	return nodo;
 }
 
 // Destruye un nodo del árbol
 // Pre: El nodo existe.
 // Post: Destruye el nodo y su contenido.
-void* abb_nodo_destruir(abb_nodo_t* nodo) {
+void* abb_nodo_destruir(abb_t* arbol, abb_nodo_t* nodo) {
 	if (!nodo) return NULL;
 	void* dato = nodo->dato;
 	free((char*)nodo->clave);
-	free(nodo);
+	if (arbol->pool) pool_devolver(arbol->pool, nodo);
+	else free(nodo);
 	return dato;
 }
 
@@ -85,16 +88,18 @@ void* abb_borrar_con_hijo_unico(abb_nodo_t* nodo, abb_nodo_t* padre, int lado, a
 		if (!padre) arbol->raiz = nodo->izq;
 		else if (lado == -1) padre->der = nodo->izq;
 		else if (lado == 1)	padre->izq = nodo->izq;
+		nodo->izq->padre = padre;
 		arbol->cantidad--;
-		return abb_nodo_destruir(nodo);
+		return abb_nodo_destruir(arbol, nodo);
 	}
 	// Si tiene hijo derecho
 	else if ((nodo->der) && (!nodo->izq)){
 		if (!padre) arbol->raiz = nodo->der;
 		else if (lado == -1) padre->der = nodo->der;
 		else if (lado == 1)	padre->izq = nodo->der;
+		nodo->der->padre = padre;
 		arbol->cantidad--;
-		return abb_nodo_destruir(nodo);
+		return abb_nodo_destruir(arbol, nodo);
 	}
 	return NULL;
 }
@@ -120,14 +125,18 @@ void* abb_borrar_con_2hijos(abb_nodo_t* nodo, abb_nodo_t* padre, int lado, abb_t
 	else {
 		reemplazante = padre_del_reemplazante->izq;
 		padre_del_reemplazante->izq = reemplazante->der;
+		if (reemplazante->der) reemplazante->der->padre = padre_del_reemplazante;
 		reemplazante->izq = nodo->izq;
 		reemplazante->der = nodo->der;
+		reemplazante->der->padre = reemplazante;
 	}
+	reemplazante->izq->padre = reemplazante;
+	reemplazante->padre = padre;
 	if (!padre) arbol->raiz = reemplazante;
 	else if (lado == -1) padre->der = reemplazante;
 	else if (lado == 1)	padre->izq = reemplazante;
 	arbol->cantidad--;
-	return abb_nodo_destruir(nodo);
+	return abb_nodo_destruir(arbol, nodo);
 }
 
 /* *****************************************************************
@@ -138,15 +147,29 @@ void* abb_borrar_con_2hijos(abb_nodo_t* nodo, abb_nodo_t* padre, int lado, abb_t
 // Pre: Ninguna.
 // Post: Devuelve un nuevo árbol vacío.
 abb_t* abb_crear(abb_comparar_clave_t cmp, abb_destruir_dato_t destruir_dato) {
+	return abb_crear_con_pool(cmp, destruir_dato, NULL);
+}
+
+// Crea un nuevo árbol cuyos nodos se piden al pool recibido.
+// Pre: El pool fue creado con abb_pool_crear(), o es NULL.
+// Post: Devuelve un nuevo árbol vacío.
+abb_t* abb_crear_con_pool(abb_comparar_clave_t cmp, abb_destruir_dato_t destruir_dato, pool_t* pool) {
 	abb_t* abb = malloc(sizeof(abb_t));
 	if (!abb) return NULL;
 	abb->raiz = NULL;
 	abb->cantidad = 0;
 	abb->comparar = cmp;
 	abb->destruir = destruir_dato;
+	abb->pool = pool;
 	return abb;
 }
 
+// Crea un pool de nodos de árbol, que puede compartirse entre varios árboles.
+// Post: Devuelve el pool, NULL si no se pudo crear.
+pool_t* abb_pool_crear(void) {
+	return pool_crear(sizeof(abb_nodo_t));
+}
+
 // Función que busca recursivamente la ubicación donde guardar el nodo, y lo guarda.
 // Pre: El árbol existe.
 // Post: Devuelve TRUE si pudo guardar el nodo, FALSE si no.
@@ -164,7 +187,9 @@ bool abb_guardar_r(abb_t *arbol, abb_nodo_t* nodo_actual, const char *clave, voi
 	else if (r == 1) {
 		// Si no hay nada a la izquierda, guardo el nodo
 		if (!nodo_actual->izq) {
-			abb_nodo_t* nuevo_nodo = abb_nodo_crear(clave, dato);
+			abb_nodo_t* nuevo_nodo = abb_nodo_crear(arbol, clave, dato);
+			if (!nuevo_nodo) return false;
+			nuevo_nodo->padre = nodo_actual;
 			nodo_actual->izq = nuevo_nodo;
 			arbol->cantidad++;
 			return true;
@@ -175,7 +200,9 @@ bool abb_guardar_r(abb_t *arbol, abb_nodo_t* nodo_actual, const char *clave, voi
 	else if (r == -1) {
 		// Si no hay nada a la derecha, guardo el nodo
 		if (!nodo_actual->der) {
-			abb_nodo_t* nuevo_nodo = abb_nodo_crear(clave, dato);
+			abb_nodo_t* nuevo_nodo = abb_nodo_crear(arbol, clave, dato);
+			if (!nuevo_nodo) return false;
+			nuevo_nodo->padre = nodo_actual;
 			nodo_actual->der = nuevo_nodo;
 			arbol->cantidad++;
 			return true;
@@ -192,7 +219,7 @@ bool abb_guardar(abb_t *arbol, const char *clave, void *dato) {
 	if (!arbol) return false;
 	// Si el árbol está vacío, lo guardo en la raíz
 	if (abb_cantidad(arbol) == 0) {
-		abb_nodo_t* nuevo_nodo = abb_nodo_crear(clave, dato);
+		abb_nodo_t* nuevo_nodo = abb_nodo_crear(arbol, clave, dato);
 		if (!nuevo_nodo) return false;
 		arbol->raiz = nuevo_nodo;
 		arbol->cantidad++;
@@ -213,7 +240,7 @@ void* abb_borrar_r(abb_nodo_t* nodo, abb_nodo_t* padre, int lado, const char* cl
 			// Si nodo es el hijo derecho de su padre
 			else if (lado == -1) padre->der = NULL;
 			arbol->cantidad--;
-			return abb_nodo_destruir(nodo);
+			return abb_nodo_destruir(arbol, nodo);
 		}
 		// Si tiene un solo hijo
 		else if ((!nodo->der && nodo->izq) || (!nodo->izq && nodo->der)) return abb_borrar_con_hijo_unico(nodo, padre, lado, arbol);
@@ -267,11 +294,11 @@ size_t abb_cantidad(abb_t *arbol) {
 // Función recursiva para destruir el contenido de un árbol.
 // Pre: El árbol existe.
 // Post: Se destruyó el contenido del árbol.
-void abb_destruir_r(abb_nodo_t* nodo, abb_destruir_dato_t destruir){
-	if (nodo->izq) abb_destruir_r(nodo->izq, destruir);
-	if (nodo->der) abb_destruir_r(nodo->der, destruir);
-	void* dato = abb_nodo_destruir(nodo);
-	if (destruir) destruir(dato);
+void abb_destruir_r(abb_t* arbol, abb_nodo_t* nodo){
+	if (nodo->izq) abb_destruir_r(arbol, nodo->izq);
+	if (nodo->der) abb_destruir_r(arbol, nodo->der);
+	void* dato = abb_nodo_destruir(arbol, nodo);
+	if (arbol->destruir) arbol->destruir(dato);
 	return;
 }
 
@@ -280,7 +307,7 @@ void abb_destruir_r(abb_nodo_t* nodo, abb_destruir_dato_t destruir){
 // Post: Se destruyó el árbol y todo lo que contiene.
 void abb_destruir(abb_t *arbol) {
 	if (!arbol) return;
-	if (arbol->raiz) abb_destruir_r(arbol->raiz, arbol->destruir);
+	if (arbol->raiz) abb_destruir_r(arbol, arbol->raiz);
 	free(arbol);
 }
 
@@ -301,6 +328,60 @@ void abb_in_order(abb_t *arbol, bool funcion(const char *, void *, void *), void
 	return;
 }
 
+/* *****************************************************************
+ *                    PRIMITIVAS DEL RECORRIDO
+ * *****************************************************************/
+
+// Inicializa un recorrido in order sobre un árbol existente, posicionado en
+// la menor clave.
+// Pre: El árbol existe.
+void abb_recorrido_iniciar(abb_recorrido_t *recorrido, const abb_t *arbol) {
+	abb_nodo_t* nodo = arbol ? arbol->raiz : NULL;
+	if (nodo) {
+		while (nodo->izq) nodo = nodo->izq;
+	}
+	recorrido->_actual = nodo;
+}
+
+// Avanza a la clave siguiente. Si el nodo actual tiene hijo derecho, la
+// siguiente es la menor de ese subárbol; si no, es el primer ancestro al que
+// se llega subiendo desde un hijo izquierdo.
+// Pre: El recorrido fue iniciado.
+bool abb_recorrido_avanzar(abb_recorrido_t *recorrido) {
+	const abb_nodo_t* nodo = recorrido->_actual;
+	if (!nodo) return false;
+	if (nodo->der) {
+		nodo = nodo->der;
+		while (nodo->izq) nodo = nodo->izq;
+	}
+	else {
+		while (nodo->padre && nodo->padre->der == nodo) nodo = nodo->padre;
+		nodo = nodo->padre;
+	}
+	recorrido->_actual = nodo;
+	return true;
+}
+
+// Devuelve la clave actual del recorrido, NULL si está al final.
+// Pre: El recorrido fue iniciado.
+const char *abb_recorrido_ver_actual(const abb_recorrido_t *recorrido) {
+	if (!recorrido->_actual) return NULL;
+	return recorrido->_actual->clave;
+}
+
+// Devuelve el dato de la clave actual del recorrido, NULL si está al final.
+// Pre: El recorrido fue iniciado.
+void *abb_recorrido_ver_dato(const abb_recorrido_t *recorrido) {
+	if (!recorrido->_actual) return NULL;
+	return recorrido->_actual->dato;
+}
+
+// Devuelve TRUE si el recorrido se encuentra al final, FALSE si no.
+// Pre: El recorrido fue iniciado.
+bool abb_recorrido_al_final(const abb_recorrido_t *recorrido) {
+	return !recorrido->_actual;
+}
+
 /* *****************************************************************
  *                    PRIMITIVAS DEL ITERADOR EXTERNO
  * *****************************************************************/
@@ -312,16 +393,7 @@ abb_iter_t *abb_iter_in_crear(const abb_t *arbol) {
 	if (!arbol) return NULL;
 	abb_iter_t* iter = malloc(sizeof(abb_iter_t));
 	if (!iter) return NULL;
-	iter->pila = pila_crear();
-	if (!iter->pila) return NULL;
-	abb_nodo_t* nodo = arbol->raiz;
-	if (arbol->raiz){
-		while (nodo->izq) {
-			pila_apilar(iter->pila, nodo);
-			nodo = nodo->izq;
-		}
-	}
-	iter->actual = nodo;
+	abb_recorrido_iniciar(&iter->recorrido, arbol);
 	return iter;
 }
 
@@ -329,38 +401,25 @@ abb_iter_t *abb_iter_in_crear(const abb_t *arbol) {
 // FALSE si se encuentra al final.
 // Pre: El iterador existe.
 bool abb_iter_in_avanzar(abb_iter_t *iter) {
-	if (abb_iter_in_al_final(iter)) return false;
-	if (!iter->actual->der)
-		iter->actual = pila_desapilar(iter->pila);
-	else {
-		iter->actual = iter->actual->der;
-		while (iter->actual->izq) {
-			pila_apilar(iter->pila, iter->actual);
-			iter->actual = iter->actual->izq;
-		}
-	}
-	return true;
+	return abb_recorrido_avanzar(&iter->recorrido);
 }
 
 // Devuelve la clave actual a la cual apunta el iterador
 // Pre: El iterador existe.
 const char *abb_iter_in_ver_actual(const abb_iter_t *iter) {
-	if (!iter->actual) return NULL;
-	return iter->actual->clave;
+	return abb_recorrido_ver_actual(&iter->recorrido);
 }
 
 // Devuelve TRUE si el iterador se encuentra al final, FALSE si no
 // Pre: El iterador existe.
 bool abb_iter_in_al_final(const abb_iter_t *iter) {
-	if (!iter->actual) return true;
-	return false;
+	return abb_recorrido_al_final(&iter->recorrido);
 }
 
 // Destruye el iterador.
 // Pre: El iterador existe.
 // Post: Se destruyó el iterador
 void abb_iter_in_destruir(abb_iter_t* iter) {
-	pila_destruir(iter->pila);
 	free(iter);
 	return;
 }
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "pool.h"
 
 /* ******************************************************************
  *                DEFINICION DE LOS TIPOS DE DATOS
@@ -10,6 +11,8 @@
 
 typedef struct abb abb_t;
 
+struct abb_nodo;
+
 typedef int (*abb_comparar_clave_t) (const char *, const char *);
 
 typedef void (*abb_destruir_dato_t) (void *);
@@ -23,6 +26,17 @@ typedef void (*abb_destruir_dato_t) (void *);
 // Post: Devuelve un nuevo árbol vacío.
 abb_t* abb_crear(abb_comparar_clave_t cmp, abb_destruir_dato_t destruir_dato);
 
+// Crea un nuevo árbol cuyos nodos se piden al pool recibido en lugar de a
+// malloc. Si pool es NULL equivale a abb_crear().
+// Pre: El pool fue creado con abb_pool_crear(), y se destruirá después que
+// el árbol.
+// Post: Devuelve un nuevo árbol vacío.
+abb_t* abb_crear_con_pool(abb_comparar_clave_t cmp, abb_destruir_dato_t destruir_dato, pool_t* pool);
+
+// Crea un pool de nodos de árbol, que puede compartirse entre varios árboles.
+// Post: Devuelve el pool, NULL si no se pudo crear.
+pool_t* abb_pool_crear(void);
+
 // Guarda una clave en el árbol
 // Pre: El árbol existe.
 // Post: Devuelve TRUE si pudo guardar la clave, FALSE si no.
@@ -75,4 +89,24 @@ bool abb_iter_in_al_final(const abb_iter_t *iter);
 
 void abb_iter_in_destruir(abb_iter_t* iter);
 
+// Recorrido in order que no pide memoria dinámica: ocupa un puntero y puede
+// declararse en el stack del llamador. Cada nodo conoce a su padre, por lo
+// que avanzar no necesita recordar el camino desde la raíz. Los miembros que
+// empiezan con '_' son privados. Como el iterador externo, deja de ser
+// válido si se modifica el árbol.
+
+typedef struct abb_recorrido {
+	const struct abb_nodo* _actual;
+} abb_recorrido_t;
+
+void abb_recorrido_iniciar(abb_recorrido_t *recorrido, const abb_t *arbol);
+
+bool abb_recorrido_avanzar(abb_recorrido_t *recorrido);
+
+const char *abb_recorrido_ver_actual(const abb_recorrido_t *recorrido);
+
+void *abb_recorrido_ver_dato(const abb_recorrido_t *recorrido);
+
+bool abb_recorrido_al_final(const abb_recorrido_t *recorrido);
+
 #endif // ABB_H
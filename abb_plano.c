@@ -0,0 +1,286 @@
+#include <stdlib.h>
+#include <string.h>
+#include "abb_plano.h"
+
+// Los descendientes de la posición k cuatro niveles más abajo ocupan las
+// posiciones 16k a 16k + 15, contiguas en la tabla: se piden por adelantado
+// mientras se compara el nivel actual, si la tabla llega hasta ahí.
+#define PRECARGA 16
+#ifdef __GNUC__
+#define ABB_PLANO_PRECARGAR(dir) __builtin_prefetch(dir)
+#else
+#define ABB_PLANO_PRECARGAR(dir) ((void) (dir))
+#endif
+
+typedef struct abb_plano_entrada {
+	const char* clave;
+	void* dato;
+} abb_plano_entrada_t;
+
+struct abb_plano {
+	abb_plano_entrada_t* tabla; // Posiciones 1..cantidad, en orden de Eytzinger
+	char* claves;               // Bloque con todas las claves, en el orden de la tabla
+	size_t cantidad;
+	abb_comparar_clave_t comparar;
+	abb_destruir_dato_t destruir;
+};
+
+struct abb_plano_iter {
+	const abb_plano_t* arbol;
+	size_t pos;
+};
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Ordena (de forma estable) los índices de las claves, mediante merge sort.
+// Pre: aux tiene lugar para cant índices.
+// Post: indices quedó ordenado según el orden de las claves.
+void abb_plano_ordenar(const char *claves[], size_t* indices, size_t* aux, size_t cant, abb_comparar_clave_t cmp) {
+	if (cant < 2) return;
+	size_t medio = cant / 2;
+	abb_plano_ordenar(claves, indices, aux, medio, cmp);
+	abb_plano_ordenar(claves, indices + medio, aux, cant - medio, cmp);
+	size_t i = 0, j = medio, k = 0;
+	while (i < medio && j < cant) {
+		// Ante claves iguales va primero la de la izquierda, para que sea estable
+		if (cmp(claves[indices[j]], claves[indices[i]]) < 0) aux[k++] = indices[j++];
+		else aux[k++] = indices[i++];
+	}
+	while (i < medio) aux[k++] = indices[i++];
+	while (j < cant) aux[k++] = indices[j++];
+	memcpy(indices, aux, cant * sizeof(size_t));
+}
+
+// Ubica los elementos ordenados en la tabla recorriéndola in order a partir
+// de la posición k.
+// Post: Devuelve la cantidad de elementos ordenados ya ubicados.
+size_t abb_plano_llenar(abb_plano_entrada_t* tabla, size_t cant, const abb_plano_entrada_t* ordenadas, size_t i, size_t k) {
+	if (k > cant) return i;
+	i = abb_plano_llenar(tabla, cant, ordenadas, i, 2 * k);
+	tabla[k] = ordenadas[i++];
+	return abb_plano_llenar(tabla, cant, ordenadas, i, 2 * k + 1);
+}
+
+// Devuelve la posición de la primera clave mayor o igual a la buscada, 0
+// si no hay ninguna. La comparación de cada nivel sólo decide el índice del
+// siguiente, sin ramificar en el resultado.
+size_t abb_plano_cota_inferior(const abb_plano_t* arbol, const char* clave) {
+	size_t k = 1;
+	while (k <= arbol->cantidad) {
+		if (PRECARGA * k <= arbol->cantidad) ABB_PLANO_PRECARGAR(arbol->tabla + PRECARGA * k);
+		k = 2 * k + (size_t) (arbol->comparar(arbol->tabla[k].clave, clave) < 0);
+	}
+	// Se deshacen los pasos a la derecha dados después del último a la izquierda
+	while (k & 1) k >>= 1;
+	return k >> 1;
+}
+
+// Devuelve la posición de la clave buscada, 0 si no está en el árbol.
+size_t abb_plano_buscar(const abb_plano_t* arbol, const char* clave) {
+	size_t k = abb_plano_cota_inferior(arbol, clave);
+	if (k && arbol->comparar(arbol->tabla[k].clave, clave) == 0) return k;
+	return 0;
+}
+
+// Devuelve la posición de la menor clave del árbol, 0 si está vacío.
+size_t abb_plano_primero(const abb_plano_t* arbol) {
+	if (!arbol->cantidad) return 0;
+	size_t k = 1;
+	while (2 * k <= arbol->cantidad) k = 2 * k;
+	return k;
+}
+
+// Devuelve la posición de la clave siguiente in order a la de la posición
+// k, 0 si no hay más.
+size_t abb_plano_siguiente(const abb_plano_t* arbol, size_t k) {
+	if (2 * k + 1 <= arbol->cantidad) {
+		k = 2 * k + 1;
+		while (2 * k <= arbol->cantidad) k = 2 * k;
+		return k;
+	}
+	while (k & 1) k >>= 1;
+	return k >> 1;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ÁRBOL
+ * *****************************************************************/
+
+// Crea un árbol con los cant pares (claves[i], datos[i]).
+// Pre: claves y datos tienen al menos cant elementos.
+// Post: Devuelve el árbol creado, NULL si no se pudo crear.
+abb_plano_t* abb_plano_crear(const char *claves[], void *datos[], size_t cant, abb_comparar_clave_t cmp, abb_destruir_dato_t destruir_dato) {
+	abb_plano_t* arbol = malloc(sizeof(abb_plano_t));
+	if (!arbol) return NULL;
+	size_t* indices = malloc(2 * cant * sizeof(size_t) + 1);
+	abb_plano_entrada_t* ordenadas = malloc(cant * sizeof(abb_plano_entrada_t) + 1);
+	arbol->tabla = malloc((cant + 1) * sizeof(abb_plano_entrada_t));
+	if (!indices || !ordenadas || !arbol->tabla) {
+		free(indices);
+		free(ordenadas);
+		free(arbol->tabla);
+		free(arbol);
+		return NULL;
+	}
+	for (size_t i = 0; i < cant; i++) indices[i] = i;
+	abb_plano_ordenar(claves, indices, indices + cant, cant, cmp);
+
+	// Elimino las claves repetidas, conservando el último dato de cada una
+	size_t unicas = 0;
+	size_t largo_claves = 0;
+	for (size_t i = 0; i < cant; i++) {
+		size_t actual = indices[i];
+		if (unicas && cmp(ordenadas[unicas - 1].clave, claves[actual]) == 0) {
+			if (destruir_dato) destruir_dato(ordenadas[unicas - 1].dato);
+			ordenadas[unicas - 1].dato = datos[actual];
+			continue;
+		}
+		ordenadas[unicas].clave = claves[actual];
+		ordenadas[unicas].dato = datos[actual];
+		largo_claves += strlen(claves[actual]) + 1;
+		unicas++;
+	}
+	free(indices);
+	arbol->cantidad = unicas;
+	abb_plano_llenar(arbol->tabla, unicas, ordenadas, 0, 1);
+	free(ordenadas);
+
+	// Copio las claves a un único bloque, en el orden de la tabla
+	arbol->claves = malloc(largo_claves + 1);
+	if (!arbol->claves) {
+		free(arbol->tabla);
+		free(arbol);
+		return NULL;
+	}
+	char* destino = arbol->claves;
+	for (size_t k = 1; k <= unicas; k++) {
+		size_t largo = strlen(arbol->tabla[k].clave) + 1;
+		memcpy(destino, arbol->tabla[k].clave, largo);
+		arbol->tabla[k].clave = destino;
+		destino += largo;
+	}
+	arbol->comparar = cmp;
+	arbol->destruir = destruir_dato;
+	return arbol;
+}
+
+// Obtiene el dato asociado a una clave del árbol.
+// Pre: El árbol existe.
+// Post: Devuelve el dato asociado a la clave (si existe), NULL si no existe.
+void *abb_plano_obtener(const abb_plano_t *arbol, const char *clave) {
+	if (!arbol) return NULL;
+	size_t k = abb_plano_buscar(arbol, clave);
+	if (!k) return NULL;
+	return arbol->tabla[k].dato;
+}
+
+// Verifica si una clave pertenece a un árbol.
+// Pre: El árbol existe.
+// Post: Devuelve TRUE si la clave pertenece al árbol, FALSE si no.
+bool abb_plano_pertenece(const abb_plano_t *arbol, const char *clave) {
+	if (!arbol) return false;
+	return abb_plano_buscar(arbol, clave) != 0;
+}
+
+// Devuelve la cantidad de claves del árbol.
+// Pre: El árbol existe.
+size_t abb_plano_cantidad(const abb_plano_t *arbol) {
+	if (!arbol) return 0;
+	return arbol->cantidad;
+}
+
+// Destruye un árbol, llamando a destruir_dato para cada dato.
+// Pre: El árbol existe.
+// Post: Se destruyó el árbol y todo lo que contiene.
+void abb_plano_destruir(abb_plano_t *arbol) {
+	if (!arbol) return;
+	if (arbol->destruir) {
+		for (size_t k = 1; k <= arbol->cantidad; k++)
+			arbol->destruir(arbol->tabla[k].dato);
+	}
+	free(arbol->claves);
+	free(arbol->tabla);
+	free(arbol);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ITERADOR INTERNO
+ * *****************************************************************/
+
+void abb_plano_in_order(const abb_plano_t *arbol, abb_plano_visitar_t visitar, void *extra) {
+	abb_plano_rango(arbol, NULL, NULL, visitar, extra);
+}
+
+void abb_plano_rango(const abb_plano_t *arbol, const char *desde, const char *hasta, abb_plano_visitar_t visitar, void *extra) {
+	if (!arbol) return;
+	size_t k = desde ? abb_plano_cota_inferior(arbol, desde) : abb_plano_primero(arbol);
+	while (k) {
+		const abb_plano_entrada_t* entrada = &arbol->tabla[k];
+		if (hasta && arbol->comparar(entrada->clave, hasta) > 0) return;
+		if (!visitar(entrada->clave, entrada->dato, extra)) return;
+		k = abb_plano_siguiente(arbol, k);
+	}
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ITERADOR EXTERNO
+ * *****************************************************************/
+
+// Crea un nuevo iterador sobre un árbol existente.
+// Pre: El árbol existe.
+// Post: Se creó el iterador.
+abb_plano_iter_t *abb_plano_iter_crear(const abb_plano_t *arbol) {
+	if (!arbol) return NULL;
+	abb_plano_iter_t* iter = malloc(sizeof(abb_plano_iter_t));
+	if (!iter) return NULL;
+	iter->arbol = arbol;
+	iter->pos = abb_plano_primero(arbol);
+	return iter;
+}
+
+// Crea un iterador posicionado en la primera clave mayor o igual a desde.
+// Pre: El árbol existe.
+// Post: Se creó el iterador.
+abb_plano_iter_t *abb_plano_iter_crear_desde(const abb_plano_t *arbol, const char *desde) {
+	abb_plano_iter_t* iter = abb_plano_iter_crear(arbol);
+	if (iter) iter->pos = abb_plano_cota_inferior(arbol, desde);
+	return iter;
+}
+
+// Avanza a la siguiente clave del árbol. Devuelve TRUE si pudo avanzar,
+// FALSE si se encuentra al final.
+// Pre: El iterador existe.
+bool abb_plano_iter_avanzar(abb_plano_iter_t *iter) {
+	if (abb_plano_iter_al_final(iter)) return false;
+	iter->pos = abb_plano_siguiente(iter->arbol, iter->pos);
+	return true;
+}
+
+// Devuelve la clave actual a la cual apunta el iterador, NULL si está al final.
+// Pre: El iterador existe.
+const char *abb_plano_iter_ver_actual(const abb_plano_iter_t *iter) {
+	if (abb_plano_iter_al_final(iter)) return NULL;
+	return iter->arbol->tabla[iter->pos].clave;
+}
+
+// Devuelve el dato de la clave actual, NULL si está al final.
+// Pre: El iterador existe.
+void *abb_plano_iter_ver_dato(const abb_plano_iter_t *iter) {
+	if (abb_plano_iter_al_final(iter)) return NULL;
+	return iter->arbol->tabla[iter->pos].dato;
+}
+
+// Devuelve TRUE si el iterador se encuentra al final, FALSE si no
+// Pre: El iterador existe.
+bool abb_plano_iter_al_final(const abb_plano_iter_t *iter) {
+	return iter->pos == 0;
+}
+
+// Destruye el iterador.
+// Pre: El iterador existe.
+// Post: Se destruyó el iterador
+void abb_plano_iter_destruir(abb_plano_iter_t *iter) {
+	free(iter);
+}
@@ -0,0 +1,87 @@
+#ifndef ABB_PLANO_H
+#define ABB_PLANO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "abb.h"
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Árbol de búsqueda estático almacenado en un único arreglo con la
+ * disposición de Eytzinger (la raíz en la posición 1 y los hijos de la
+ * posición k en 2k y 2k + 1). Se construye una sola vez a partir de todos
+ * sus pares (clave, dato) y no admite altas ni bajas posteriores, a cambio
+ * de búsquedas sin seguir punteros entre nodos dispersos en memoria.
+ * Las claves se copian a un único bloque contiguo, en el mismo orden que
+ * el arreglo. */
+
+typedef struct abb_plano abb_plano_t;
+
+typedef bool (*abb_plano_visitar_t) (const char *, void *, void *);
+
+/* ******************************************************************
+ *                  PRIMITIVAS BÁSICAS DEL ÁRBOL
+ * *****************************************************************/
+
+// Crea un árbol con los cant pares (claves[i], datos[i]), que no necesitan
+// estar ordenados. Si una clave aparece más de una vez se conserva el último
+// dato, y los anteriores se destruyen con destruir_dato (si no es NULL).
+// Pre: claves y datos tienen al menos cant elementos.
+// Post: Devuelve el árbol creado, NULL si no se pudo crear.
+abb_plano_t* abb_plano_crear(const char *claves[], void *datos[], size_t cant, abb_comparar_clave_t cmp, abb_destruir_dato_t destruir_dato);
+
+// Obtiene el dato asociado a una clave del árbol.
+// Pre: El árbol existe.
+// Post: Devuelve el dato asociado a la clave (si existe), NULL si no existe.
+void *abb_plano_obtener(const abb_plano_t *arbol, const char *clave);
+
+// Verifica si una clave pertenece a un árbol.
+// Pre: El árbol existe.
+// Post: Devuelve TRUE si la clave pertenece al árbol, FALSE si no.
+bool abb_plano_pertenece(const abb_plano_t *arbol, const char *clave);
+
+// Devuelve la cantidad de claves del árbol.
+// Pre: El árbol existe.
+size_t abb_plano_cantidad(const abb_plano_t *arbol);
+
+// Destruye un árbol, llamando a destruir_dato para cada dato.
+// Pre: El árbol existe.
+// Post: Se destruyó el árbol y todo lo que contiene.
+void abb_plano_destruir(abb_plano_t *arbol);
+
+/* ******************************************************************
+ *                     PRIMITIVAS DE ITERACIÓN
+ * *****************************************************************/
+
+// Primitivas iterador interno
+
+// Recorre el árbol in order mientras visitar devuelva TRUE.
+void abb_plano_in_order(const abb_plano_t *arbol, abb_plano_visitar_t visitar, void *extra);
+
+// Recorre in order las claves comprendidas entre desde y hasta (ambas
+// inclusive) mientras visitar devuelva TRUE. Si desde o hasta son NULL, el
+// rango no tiene cota inferior o superior respectivamente.
+void abb_plano_rango(const abb_plano_t *arbol, const char *desde, const char *hasta, abb_plano_visitar_t visitar, void *extra);
+
+// Primitivas iterador externo
+
+typedef struct abb_plano_iter abb_plano_iter_t;
+
+abb_plano_iter_t *abb_plano_iter_crear(const abb_plano_t *arbol);
+
+// Crea un iterador posicionado en la primera clave mayor o igual a desde.
+abb_plano_iter_t *abb_plano_iter_crear_desde(const abb_plano_t *arbol, const char *desde);
+
+bool abb_plano_iter_avanzar(abb_plano_iter_t *iter);
+
+const char *abb_plano_iter_ver_actual(const abb_plano_iter_t *iter);
+
+void *abb_plano_iter_ver_dato(const abb_plano_iter_t *iter);
+
+bool abb_plano_iter_al_final(const abb_plano_iter_t *iter);
+
+void abb_plano_iter_destruir(abb_plano_iter_t *iter);
+
+#endif // ABB_PLANO_H
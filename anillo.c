@@ -0,0 +1,121 @@
+#include "anillo.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/* 'publicados' sólo la modifica el productor, y 'devueltos' sólo el
+ * consumidor; ambas crecen sin volver a cero, y el bloque número n está en
+ * la posición n % cantidad. El anillo está vacío si son iguales, y lleno si
+ * difieren en 'cantidad'.
+ *
+ * Para no perder un aviso, el que espera anota que está esperando antes de
+ * volver a mirar las cantidades, y el otro mira si alguien espera después
+ * de actualizarlas; con operaciones secuencialmente consistentes, alguno de
+ * los dos ve lo que hizo el otro. */
+
+struct anillo {
+	anillo_bloque_t* bloques;
+	size_t cantidad;
+	size_t publicados;
+	size_t devueltos;
+	bool cerrado;
+	int esperando;           // Hilos dormidos (o por dormirse) en 'cond'
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Lee una de las cantidades que modifica el otro hilo.
+size_t anillo_leer(const size_t* cantidad) {
+	return __atomic_load_n(cantidad, __ATOMIC_SEQ_CST);
+}
+
+// Devuelve true si hay un bloque libre para el productor.
+bool anillo_hay_libre(anillo_t* anillo) {
+	return anillo->publicados - anillo_leer(&anillo->devueltos) < anillo->cantidad;
+}
+
+// Devuelve true si hay un bloque publicado para el consumidor, o si el
+// anillo se cerró.
+bool anillo_hay_publicado(anillo_t* anillo) {
+	return anillo_leer(&anillo->publicados) != anillo->devueltos || __atomic_load_n(&anillo->cerrado, __ATOMIC_SEQ_CST);
+}
+
+// Espera a que 'listo' devuelva true.
+void anillo_esperar(anillo_t* anillo, bool (*listo)(anillo_t*)) {
+	if (listo(anillo)) return;
+	pthread_mutex_lock(&anillo->mutex);
+	__atomic_add_fetch(&anillo->esperando, 1, __ATOMIC_SEQ_CST);
+	while (!listo(anillo)) pthread_cond_wait(&anillo->cond, &anillo->mutex);
+	__atomic_sub_fetch(&anillo->esperando, 1, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&anillo->mutex);
+}
+
+// Despierta al otro hilo si está esperando.
+void anillo_avisar(anillo_t* anillo) {
+	if (__atomic_load_n(&anillo->esperando, __ATOMIC_SEQ_CST) == 0) return;
+	pthread_mutex_lock(&anillo->mutex);
+	pthread_cond_broadcast(&anillo->cond);
+	pthread_mutex_unlock(&anillo->mutex);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ANILLO
+ * *****************************************************************/
+
+anillo_t* anillo_crear(size_t cantidad) {
+	anillo_t* anillo = malloc(sizeof(anillo_t));
+	if (!anillo) return NULL;
+	anillo->bloques = calloc(cantidad, sizeof(anillo_bloque_t));
+	if (!anillo->bloques) {
+		free(anillo);
+		return NULL;
+	}
+	anillo->cantidad = cantidad;
+	anillo->publicados = 0;
+	anillo->devueltos = 0;
+	anillo->cerrado = false;
+	anillo->esperando = 0;
+	pthread_mutex_init(&anillo->mutex, NULL);
+	pthread_cond_init(&anillo->cond, NULL);
+	return anillo;
+}
+
+anillo_bloque_t* anillo_reservar(anillo_t* anillo) {
+	anillo_esperar(anillo, anillo_hay_libre);
+	anillo_bloque_t* bloque = &anillo->bloques[anillo->publicados % anillo->cantidad];
+	bloque->largo = 0;
+	return bloque;
+}
+
+void anillo_publicar(anillo_t* anillo) {
+	__atomic_store_n(&anillo->publicados, anillo->publicados + 1, __ATOMIC_SEQ_CST);
+	anillo_avisar(anillo);
+}
+
+void anillo_cerrar(anillo_t* anillo) {
+	__atomic_store_n(&anillo->cerrado, true, __ATOMIC_SEQ_CST);
+	anillo_avisar(anillo);
+}
+
+anillo_bloque_t* anillo_tomar(anillo_t* anillo) {
+	anillo_esperar(anillo, anillo_hay_publicado);
+	// Se cerró después de publicar el último bloque
+	if (anillo_leer(&anillo->publicados) == anillo->devueltos) return NULL;
+	return &anillo->bloques[anillo->devueltos % anillo->cantidad];
+}
+
+void anillo_devolver(anillo_t* anillo) {
+	__atomic_store_n(&anillo->devueltos, anillo->devueltos + 1, __ATOMIC_SEQ_CST);
+	anillo_avisar(anillo);
+}
+
+void anillo_destruir(anillo_t* anillo) {
+	for (size_t i = 0; i < anillo->cantidad; i++) free(anillo->bloques[i].datos);
+	pthread_mutex_destroy(&anillo->mutex);
+	pthread_cond_destroy(&anillo->cond);
+	free(anillo->bloques);
+	free(anillo);
+}
@@ -0,0 +1,85 @@
+#ifndef ANILLO_H
+#define ANILLO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Anillo de bloques para pasar datos de un hilo productor a un hilo
+ * consumidor (uno solo de cada uno), en orden. El anillo tiene una
+ * cantidad fija de bloques que se reutilizan: el productor llena un bloque
+ * libre y lo publica, y el consumidor toma los bloques publicados y los
+ * devuelve cuando termina de usarlos. El buffer de cada bloque es del hilo
+ * que lo tiene en ese momento, que puede agrandarlo o reemplazarlo.
+ *
+ * Publicar, tomar y devolver un bloque no toma ningún lock mientras haya
+ * bloques disponibles: sólo se actualiza con operaciones atómicas la
+ * cantidad de bloques publicados o devueltos. Un hilo que tiene que esperar
+ * (el anillo está lleno o vacío) se duerme en una variable de condición, y
+ * el otro lo despierta sólo si sabe que está esperando.
+ *
+ * Uso
+ * ===
+ *
+ *     // Productor
+ *     anillo_bloque_t* bloque = anillo_reservar(anillo);
+ *     ... se llenan bloque->datos y bloque->largo ...
+ *     anillo_publicar(anillo);
+ *     ...
+ *     anillo_cerrar(anillo);
+ *
+ *     // Consumidor
+ *     anillo_bloque_t* bloque;
+ *     while ((bloque = anillo_tomar(anillo))) {
+ *       ... se usan bloque->datos y bloque->largo ...
+ *       anillo_devolver(anillo);
+ *     }
+ */
+
+typedef struct anillo anillo_t;
+
+typedef struct anillo_bloque {
+	char* datos;       // Buffer del bloque, NULL hasta que se reserve uno
+	size_t largo;      // Bytes usados
+	size_t tam;        // Bytes reservados
+} anillo_bloque_t;
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ANILLO
+ * *****************************************************************/
+
+// Crea un anillo de 'cantidad' bloques, sin buffers.
+// Post: Devuelve el anillo vacío, NULL si no se pudo crear.
+anillo_t* anillo_crear(size_t cantidad);
+
+// Espera a que haya un bloque libre y lo devuelve, con largo 0, para que el
+// productor lo llene.
+// Pre: El anillo fue creado y no fue cerrado. No hay otro bloque reservado.
+anillo_bloque_t* anillo_reservar(anillo_t* anillo);
+
+// Publica el bloque reservado, que deja de ser del productor.
+// Pre: Hay un bloque reservado.
+void anillo_publicar(anillo_t* anillo);
+
+// Indica que no se van a publicar más bloques.
+// Pre: El anillo fue creado.
+void anillo_cerrar(anillo_t* anillo);
+
+// Espera a que haya un bloque publicado y lo devuelve, en el orden en que
+// se publicaron.
+// Pre: El anillo fue creado. No hay otro bloque tomado.
+// Post: Devuelve NULL si el anillo se cerró y ya se tomaron todos los bloques.
+anillo_bloque_t* anillo_tomar(anillo_t* anillo);
+
+// Devuelve el bloque tomado, que vuelve a estar libre para el productor.
+// Pre: Hay un bloque tomado.
+void anillo_devolver(anillo_t* anillo);
+
+// Destruye el anillo y los buffers de sus bloques.
+// Pre: El anillo fue creado, y ningún hilo lo está usando.
+void anillo_destruir(anillo_t* anillo);
+
+#endif // ANILLO_H
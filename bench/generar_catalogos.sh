@@ -0,0 +1,44 @@
+#!/bin/bash
+# Genera catálogos sintéticos para las mediciones de arranque y de lectura
+# de CSV, siempre con los mismos datos:
+#
+#   DIRECTORIO/doctores.csv   FILAS doctores ("Dr N.º 0000000"), repartidos
+#                             en 20000 especialidades
+#   DIRECTORIO/pacientes.csv  FILAS pacientes ("Paciente 0000000"), con
+#                             aportes de hasta 9 dígitos
+#   DIRECTORIO/largo.csv      FILAS / 3 doctores con nombres y
+#                             especialidades de largo variable (unos 100
+#                             bytes por línea en promedio)
+#
+# Uso: bench/generar_catalogos.sh FILAS DIRECTORIO
+
+set -eu
+
+if [ $# -ne 2 ]; then
+	echo "Uso: $0 FILAS DIRECTORIO" >&2
+	exit 1
+fi
+FILAS=$1
+DIRECTORIO=$2
+mkdir -p "$DIRECTORIO"
+
+# Generador congruencial de Park y Miller: los productos entran en un double
+# sin redondeo, así que da lo mismo con cualquier awk
+awk -v filas="$FILAS" -v dir="$DIRECTORIO" 'BEGIN {
+	x = 1
+	for (i = 0; i < filas; i++) {
+		x = (x * 48271) % 2147483647
+		printf "Dr N.º %07d,Especialidad %04X\n", i, x % 20000 > (dir "/doctores.csv")
+		x = (x * 48271) % 2147483647
+		printf "Paciente %07d,%d\n", i, x % 1000000000 > (dir "/pacientes.csv")
+	}
+	for (i = 0; i < filas / 3; i++) {
+		x = (x * 48271) % 2147483647
+		nombre = substr(sprintf("%0150d", 0), 1, x % 80)
+		x = (x * 48271) % 2147483647
+		especialidad = substr(sprintf("%0150d", 0), 1, x % 80)
+		gsub(/0/, "x", nombre)
+		gsub(/0/, "y", especialidad)
+		printf "Dr %s %07d,Especialidad %s\n", nombre, i, especialidad > (dir "/largo.csv")
+	}
+}'
@@ -0,0 +1,46 @@
+#define _POSIX_C_SOURCE 200809L  // Para clock_gettime().
+#include "medicion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LARGO_CLAVE 15
+
+static uint64_t estado = 88172645463325252u;
+
+double medicion_reloj(void) {
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (double) ahora.tv_sec + (double) ahora.tv_nsec * 1e-9;
+}
+
+void medicion_semilla(uint64_t semilla) {
+	estado = semilla ? semilla : 1;
+}
+
+uint64_t medicion_aleatorio(void) {
+	estado ^= estado >> 12;
+	estado ^= estado << 25;
+	estado ^= estado >> 27;
+	return estado * 2685821657736338717u;
+}
+
+char** medicion_claves(size_t cant) {
+	char** claves = malloc(cant * sizeof(char*));
+	if (!claves) return NULL;
+	for (size_t i = 0; i < cant; i++) {
+		claves[i] = malloc(LARGO_CLAVE + 1);
+		if (!claves[i]) {
+			medicion_claves_destruir(claves, i);
+			return NULL;
+		}
+		// Un prefijo aleatorio, y el índice para que no se repitan
+		snprintf(claves[i], LARGO_CLAVE + 1, "k%06x%08zu", (unsigned) (medicion_aleatorio() & 0xffffff), i % 100000000);
+	}
+	return claves;
+}
+
+void medicion_claves_destruir(char** claves, size_t cant) {
+	for (size_t i = 0; i < cant; i++) free(claves[i]);
+	free(claves);
+}
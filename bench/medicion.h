@@ -0,0 +1,28 @@
+#ifndef MEDICION_H
+#define MEDICION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Utilidades comunes de los programas de medición de bench/: un reloj, y
+ * un generador de números pseudoaleatorios con semilla fija, para que cada
+ * corrida mida exactamente los mismos datos.
+ */
+
+// Devuelve el tiempo de un reloj monotónico, en segundos.
+double medicion_reloj(void);
+
+// Fija la semilla del generador.
+void medicion_semilla(uint64_t semilla);
+
+// Devuelve el siguiente número pseudoaleatorio (xorshift64*).
+uint64_t medicion_aleatorio(void);
+
+// Devuelve un arreglo de 'cant' claves distintas de 15 caracteres, en
+// orden aleatorio. Se liberan con medicion_claves_destruir().
+// Post: Devuelve NULL si no hay memoria.
+char** medicion_claves(size_t cant);
+
+void medicion_claves_destruir(char** claves, size_t cant);
+
+#endif // MEDICION_H
@@ -0,0 +1,103 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "abb.h"
+#include "abb_plano.h"
+#include "medicion.h"
+
+/* Compara abb_t con abb_plano_t sobre las mismas CLAVES claves aleatorias
+ * de 15 caracteres: lo que tarda construir cada uno, BUSQUEDAS búsquedas
+ * de claves al azar (todas presentes), y un recorrido in order completo.
+ * Verifica además que los dos devuelvan los mismos datos y el mismo orden.
+ *
+ * Uso: ./medir_abb_plano CLAVES [BUSQUEDAS]     (por omisión, 2000000)
+ */
+
+#define BUSQUEDAS 2000000
+
+int comparar(const char* a, const char* b) {
+	int r = strcmp(a, b);
+	return (r > 0) - (r < 0);
+}
+
+bool contar(const char* clave, void* dato, void* extra) {
+	(void) clave;
+	(void) dato;
+	(*(size_t*) extra)++;
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "Uso: %s CLAVES [BUSQUEDAS]\n", argv[0]);
+		return 1;
+	}
+	size_t cant = strtoul(argv[1], NULL, 10);
+	size_t busquedas = argc > 2 ? strtoul(argv[2], NULL, 10) : BUSQUEDAS;
+	if (!cant) return 1;
+
+	medicion_semilla(1);
+	char** claves = medicion_claves(cant);
+	void** datos = malloc(cant * sizeof(void*));
+	size_t* buscadas = malloc(busquedas * sizeof(size_t));
+	if (!claves || !datos || !buscadas) return 1;
+	for (size_t i = 0; i < cant; i++) datos[i] = (void*) (uintptr_t) (i + 1);
+	for (size_t i = 0; i < busquedas; i++) buscadas[i] = (size_t) (medicion_aleatorio() % cant);
+
+	double inicio = medicion_reloj();
+	abb_t* abb = abb_crear(comparar, NULL);
+	for (size_t i = 0; i < cant; i++) abb_guardar(abb, claves[i], datos[i]);
+	double crear_abb = medicion_reloj() - inicio;
+
+	inicio = medicion_reloj();
+	abb_plano_t* plano = abb_plano_crear((const char**) claves, datos, cant, comparar, NULL);
+	double crear_plano = medicion_reloj() - inicio;
+
+	size_t suma_abb = 0, suma_plano = 0;
+	inicio = medicion_reloj();
+	for (size_t i = 0; i < busquedas; i++) suma_abb += (uintptr_t) abb_obtener(abb, claves[buscadas[i]]);
+	double buscar_abb = medicion_reloj() - inicio;
+	inicio = medicion_reloj();
+	for (size_t i = 0; i < busquedas; i++) suma_plano += (uintptr_t) abb_plano_obtener(plano, claves[buscadas[i]]);
+	double buscar_plano = medicion_reloj() - inicio;
+
+	size_t vistas_abb = 0, vistas_plano = 0;
+	inicio = medicion_reloj();
+	abb_in_order(abb, contar, &vistas_abb);
+	double recorrer_abb = medicion_reloj() - inicio;
+	inicio = medicion_reloj();
+	abb_plano_in_order(plano, contar, &vistas_plano);
+	double recorrer_plano = medicion_reloj() - inicio;
+
+	// El recorrido externo del plano tiene que dar todas las claves, en orden
+	bool ordenado = true;
+	size_t vistas_iter = 0;
+	const char* anterior = NULL;
+	abb_plano_iter_t* iter = abb_plano_iter_crear(plano);
+	for (; !abb_plano_iter_al_final(iter); abb_plano_iter_avanzar(iter), vistas_iter++) {
+		const char* actual = abb_plano_iter_ver_actual(iter);
+		if (anterior && strcmp(anterior, actual) >= 0) ordenado = false;
+		anterior = actual;
+	}
+	abb_plano_iter_destruir(iter);
+
+	int estado = 0;
+	if (suma_abb != suma_plano || !ordenado || vistas_abb != cant || vistas_plano != cant || vistas_iter != cant) {
+		fprintf(stderr, "ERROR: abb_t y abb_plano_t no coinciden\n");
+		estado = 1;
+	}
+	printf("%zu claves, %zu búsquedas\n", cant, busquedas);
+	printf("              abb_t        abb_plano_t\n");
+	printf("crear         %9.3f s  %9.3f s\n", crear_abb, crear_plano);
+	printf("buscar        %9.0f ns %9.0f ns  (por búsqueda)\n", buscar_abb / (double) busquedas * 1e9, buscar_plano / (double) busquedas * 1e9);
+	printf("in order      %9.1f ms %9.1f ms\n", recorrer_abb * 1e3, recorrer_plano * 1e3);
+
+	abb_destruir(abb);
+	abb_plano_destruir(plano);
+	medicion_claves_destruir(claves, cant);
+	free(datos);
+	free(buscadas);
+	return estado;
+}
@@ -0,0 +1,43 @@
+#!/bin/bash
+# Mide cuánto tarda PROGRAMA en cargar los catálogos y terminar (con la
+# entrada vacía), con cada cantidad de hilos pedida. Informa el mínimo y
+# la mediana de VUELTAS corridas (3 por omisión). Sin HILOS, lo corre sin
+# --hilos, para medir versiones anteriores a esa opción.
+#
+# Uso: [VUELTAS=n] bench/medir_arranque.sh PROGRAMA DOCTORES PACIENTES [HILOS...]
+#
+# Por ejemplo, con los catálogos de bench/generar_catalogos.sh:
+#
+#   bench/medir_arranque.sh ./tp /tmp/cat/doctores.csv /tmp/cat/pacientes.csv 1 2 4 8
+
+set -eu
+
+if [ $# -lt 3 ]; then
+	echo "Uso: $0 PROGRAMA DOCTORES PACIENTES [HILOS...]" >&2
+	exit 1
+fi
+PROGRAMA=$1
+DOCTORES=$2
+PACIENTES=$3
+shift 3
+VUELTAS=${VUELTAS:-3}
+
+# Imprime el mínimo y la mediana de los tiempos (uno por línea)
+resumir() {
+	sort -n | awk '{ t[NR] = $1 } END { printf "mínimo %.2f s, mediana %.2f s\n", t[1], t[int((NR + 1) / 2)] }'
+}
+
+# Corre el programa VUELTAS veces con los argumentos dados, y resume
+medir() {
+	TIMEFORMAT=%R
+	for _ in $(seq "$VUELTAS"); do
+		{ time "$PROGRAMA" "$@" "$DOCTORES" "$PACIENTES" </dev/null >/dev/null; } 2>&1
+	done | resumir
+}
+
+if [ $# -eq 0 ]; then
+	echo "sin --hilos: $(medir)"
+fi
+for HILOS in "$@"; do
+	echo "--hilos $HILOS: $(medir --hilos "$HILOS")"
+done
@@ -0,0 +1,77 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "cola.h"
+#include "medicion.h"
+
+/* Mide cola_t con OPERACIONES elementos en cuatro patrones de uso: encolar
+ * todo y después desencolar todo; encolar dos y desencolar uno; encolar y
+ * desencolar alternados; y en lotes de LOTE con cola_encolar_lote() y
+ * cola_desencolar_lote(). Verifica que los elementos salgan en el orden
+ * en que entraron.
+ *
+ * Con -DANTERIOR (ver Makefile) no se miden los lotes.
+ *
+ * Uso: ./medir_cola [OPERACIONES]     (por omisión, 10000000)
+ */
+
+#define OPERACIONES 10000000
+#define LOTE 1024
+
+int main(int argc, char* argv[]) {
+	size_t cant = argc > 1 ? strtoul(argv[1], NULL, 10) : OPERACIONES;
+	cola_t* cola = cola_crear();
+	if (!cola) return 1;
+	bool en_orden = true;
+	printf("%zu elementos\n", cant);
+
+	double inicio = medicion_reloj();
+	for (uintptr_t i = 1; i <= cant; i++) cola_encolar(cola, (void*) i);
+	for (uintptr_t i = 1; i <= cant; i++) {
+		if ((uintptr_t) cola_desencolar(cola) != i) en_orden = false;
+	}
+	printf("encolar todo, desencolar todo  %.3f s\n", medicion_reloj() - inicio);
+
+	inicio = medicion_reloj();
+	uintptr_t siguiente = 1;
+	for (uintptr_t i = 1; i <= cant; i += 2) {
+		cola_encolar(cola, (void*) i);
+		cola_encolar(cola, (void*) (i + 1));
+		if ((uintptr_t) cola_desencolar(cola) != siguiente++) en_orden = false;
+	}
+	while (!cola_esta_vacia(cola)) {
+		if ((uintptr_t) cola_desencolar(cola) != siguiente++) en_orden = false;
+	}
+	printf("2 encolar : 1 desencolar       %.3f s\n", medicion_reloj() - inicio);
+
+	inicio = medicion_reloj();
+	for (uintptr_t i = 1; i <= cant; i++) {
+		cola_encolar(cola, (void*) i);
+		if ((uintptr_t) cola_desencolar(cola) != i) en_orden = false;
+	}
+	printf("alternados                     %.3f s\n", medicion_reloj() - inicio);
+
+#ifndef ANTERIOR
+	void** lote = malloc(LOTE * sizeof(void*));
+	if (!lote) return 1;
+	inicio = medicion_reloj();
+	siguiente = 1;
+	for (uintptr_t i = 1; i + LOTE <= cant + 1; i += LOTE) {
+		for (size_t j = 0; j < LOTE; j++) lote[j] = (void*) (i + j);
+		cola_encolar_lote(cola, lote, LOTE);
+	}
+	while (!cola_esta_vacia(cola)) {
+		size_t sacados = cola_desencolar_lote(cola, lote, LOTE);
+		for (size_t j = 0; j < sacados; j++) {
+			if ((uintptr_t) lote[j] != siguiente++) en_orden = false;
+		}
+	}
+	printf("lotes de %-4d                  %.3f s\n", LOTE, medicion_reloj() - inicio);
+	free(lote);
+#endif
+
+	if (!en_orden) fprintf(stderr, "ERROR: los elementos no salieron en orden\n");
+	cola_destruir(cola, NULL);
+	return en_orden ? 0 : 1;
+}
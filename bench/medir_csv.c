@@ -0,0 +1,69 @@
+#define _POSIX_C_SOURCE 200809L  // Para fileno().
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "csv.h"
+#include "medicion.h"
+
+/* Mide la velocidad de lectura de un CSV de dos columnas, sin hacer nada
+ * con los campos: con csv_mapa_siguiente() (la carga de los catálogos,
+ * con el archivo ya en memoria), y con csv_siguiente() (getline()
+ * y dividir la línea, como se leían los comandos). Informa la mejor de
+ * VUELTAS corridas, en MB/s, y verifica que las dos lean los mismos campos.
+ *
+ * Para comparar los escáneres, compilar con DEFINES=-mavx2 (ver Makefile).
+ *
+ * Uso: ./medir_csv ARCHIVO [VUELTAS]     (por omisión, 6)
+ */
+
+#define VUELTAS 6
+
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "Uso: %s ARCHIVO [VUELTAS]\n", argv[0]);
+		return 1;
+	}
+	size_t vueltas = argc > 2 ? strtoul(argv[2], NULL, 10) : VUELTAS;
+	struct stat datos;
+	if (stat(argv[1], &datos) != 0 || !vueltas) return 1;
+	double tam = (double) datos.st_size;
+
+	double mapa = 1e9, getline = 1e9;
+	size_t bytes_mapa = 0, bytes_getline = 0;
+	for (size_t i = 0; i < vueltas; i++) {
+		csv_mapa_t csv = {.delim = ','};
+		if (!csv_mapa_abrir(&csv, argv[1])) return 1;
+		// Se escribe en cada página antes de medir, para que las versiones
+		// que proyectan el archivo con mmap() no cuenten los fallos de página
+		// (la lectura escribe en la proyección)
+		for (size_t j = 0; j < csv._tam; j += 4096) ((volatile char*) csv._mapa)[j] = csv._mapa[j];
+		bytes_mapa = 0;
+		double inicio = medicion_reloj();
+		while (csv_mapa_siguiente(&csv)) bytes_mapa += csv.primero.largo + csv.segundo.largo;
+		double duracion = medicion_reloj() - inicio;
+		if (duracion < mapa) mapa = duracion;
+		csv_mapa_cerrar(&csv);
+
+		FILE* archivo = fopen(argv[1], "r");
+		if (!archivo) return 1;
+		csv_t linea = {.delim = ','};
+		bytes_getline = 0;
+		inicio = medicion_reloj();
+		while (csv_siguiente(&linea, archivo)) bytes_getline += strlen(linea.primero) + strlen(linea.segundo);
+		duracion = medicion_reloj() - inicio;
+		if (duracion < getline) getline = duracion;
+		csv_terminar(&linea);
+		fclose(archivo);
+	}
+
+	printf("%s, %.1f MB, mejor de %zu vueltas\n", argv[1], tam / 1e6, vueltas);
+	printf("csv_mapa_siguiente  %7.1f MB/s\n", tam / mapa / 1e6);
+	printf("csv_siguiente       %7.1f MB/s\n", tam / getline / 1e6);
+	if (bytes_mapa != bytes_getline) {
+		fprintf(stderr, "ERROR: las lecturas no coinciden (%zu y %zu bytes)\n", bytes_mapa, bytes_getline);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+#include "medicion.h"
+
+/* Mide lo que cuesta en memoria dinámica armar y destruir un hash_t: se
+ * guardan como claves los primeros campos de ARCHIVO (por ejemplo, los
+ * nombres de ../doctores.csv), cada uno con un dato de 24 bytes pedido
+ * con malloc(), y se destruye el hash. Cuenta los pedidos a malloc(),
+ * calloc() y realloc(), y las llamadas a free(), envolviéndolas al
+ * enlazar (-Wl,--wrap, ver Makefile). Se repite VUELTAS veces y se
+ * informa el menor tiempo de cada parte.
+ *
+ * Uso: ./medir_hash ARCHIVO [VUELTAS]     (por omisión, 7)
+ */
+
+#define VUELTAS 7
+#define TAM_DATO 24
+#define LARGO_LINEA 256
+
+size_t pedidos = 0;
+size_t liberados = 0;
+
+void* __real_malloc(size_t tam);
+void* __real_calloc(size_t cantidad, size_t tam);
+void* __real_realloc(void* ptr, size_t tam);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t tam) {
+	pedidos++;
+	return __real_malloc(tam);
+}
+
+void* __wrap_calloc(size_t cantidad, size_t tam) {
+	pedidos++;
+	return __real_calloc(cantidad, tam);
+}
+
+void* __wrap_realloc(void* ptr, size_t tam) {
+	pedidos++;
+	return __real_realloc(ptr, tam);
+}
+
+void __wrap_free(void* ptr) {
+	if (ptr) liberados++;
+	__real_free(ptr);
+}
+
+// Devuelve los primeros campos de las líneas del archivo, y su cantidad en
+// 'cant'.
+char** leer_claves(const char* ruta, size_t* cant) {
+	FILE* archivo = fopen(ruta, "r");
+	if (!archivo) return NULL;
+	size_t capacidad = 1024;
+	char** claves = malloc(capacidad * sizeof(char*));
+	char linea[LARGO_LINEA];
+	*cant = 0;
+	while (claves && fgets(linea, LARGO_LINEA, archivo)) {
+		linea[strcspn(linea, ",\n")] = '\0';
+		if (*cant == capacidad) {
+			capacidad *= 2;
+			char** mas = realloc(claves, capacidad * sizeof(char*));
+			if (!mas) free(claves);
+			claves = mas;
+			if (!claves) break;
+		}
+		claves[*cant] = malloc(strlen(linea) + 1);
+		if (claves[*cant]) strcpy(claves[(*cant)++], linea);
+	}
+	fclose(archivo);
+	return claves;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "Uso: %s ARCHIVO [VUELTAS]\n", argv[0]);
+		return 1;
+	}
+	size_t vueltas = argc > 2 ? strtoul(argv[2], NULL, 10) : VUELTAS;
+	size_t cant;
+	char** claves = leer_claves(argv[1], &cant);
+	if (!claves || !vueltas) return 1;
+
+	double crear = 1e9, destruir = 1e9;
+	size_t pedidos_crear = 0, liberados_destruir = 0;
+	int estado = 0;
+	for (size_t i = 0; i < vueltas; i++) {
+		size_t pedidos_antes = pedidos;
+		double inicio = medicion_reloj();
+		hash_t* hash = hash_crear(free);
+		for (size_t j = 0; j < cant; j++) hash_guardar(hash, claves[j], malloc(TAM_DATO));
+		double duracion = medicion_reloj() - inicio;
+		if (duracion < crear) crear = duracion;
+		pedidos_crear = pedidos - pedidos_antes;
+		if (!hash_pertenece(hash, claves[0]) || !hash_pertenece(hash, claves[cant - 1])) estado = 1;
+
+		size_t liberados_antes = liberados;
+		inicio = medicion_reloj();
+		hash_destruir(hash);
+		duracion = medicion_reloj() - inicio;
+		if (duracion < destruir) destruir = duracion;
+		liberados_destruir = liberados - liberados_antes;
+	}
+	if (estado) fprintf(stderr, "ERROR: faltan claves en el hash\n");
+	printf("%zu claves, mínimo de %zu vueltas\n", cant, vueltas);
+	printf("crear:         %9zu pedidos de memoria, %7.3f s\n", pedidos_crear, crear);
+	printf("hash_destruir: %9zu llamadas a free(), %7.1f ms\n", liberados_destruir, destruir * 1e3);
+
+	for (size_t i = 0; i < cant; i++) free(claves[i]);
+	free(claves);
+	return estado;
+}
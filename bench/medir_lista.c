@@ -0,0 +1,101 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "lista.h"
+#include "medicion.h"
+
+/* Mide lista_t común y desenrollada con ELEMENTOS elementos: insertar
+ * todo al principio, recorrerla con lista_iterar() y con el iterador
+ * externo, borrar 100000 elementos seguidos desde la mitad, borrar uno de
+ * cada dos, e insertar todo al final con el iterador externo. Verifica
+ * los largos y la suma de los elementos recorridos.
+ *
+ * Con -DANTERIOR (ver Makefile) sólo se mide la lista común.
+ *
+ * Uso: ./medir_lista [ELEMENTOS]     (por omisión, 1000000)
+ */
+
+#define ELEMENTOS 1000000
+#define BORRADOS_SEGUIDOS 100000
+#define VUELTAS 20
+
+bool sumar(void* dato, void* extra) {
+	*(uintptr_t*) extra += (uintptr_t) dato;
+	return true;
+}
+
+// Mide una lista vacía, y devuelve false si algún resultado está mal.
+bool medir(lista_t* lista, const char* modo, size_t cant) {
+	bool bien = true;
+	double inicio = medicion_reloj();
+	for (uintptr_t i = 1; i <= cant; i++) lista_insertar_primero(lista, (void*) i);
+	double insertar = medicion_reloj() - inicio;
+
+	uintptr_t suma_esperada = (uintptr_t) cant * (cant + 1) / 2;
+	inicio = medicion_reloj();
+	for (size_t i = 0; i < VUELTAS; i++) {
+		uintptr_t suma = 0;
+		lista_iterar(lista, sumar, &suma);
+		if (suma != suma_esperada) bien = false;
+	}
+	double iterar = (medicion_reloj() - inicio) / VUELTAS;
+
+	inicio = medicion_reloj();
+	for (size_t i = 0; i < VUELTAS; i++) {
+		uintptr_t suma = 0;
+		lista_iter_t* iter = lista_iter_crear(lista);
+		for (; !lista_iter_al_final(iter); lista_iter_avanzar(iter)) suma += (uintptr_t) lista_iter_ver_actual(iter);
+		lista_iter_destruir(iter);
+		if (suma != suma_esperada) bien = false;
+	}
+	double recorrer = (medicion_reloj() - inicio) / VUELTAS;
+
+	size_t seguidos = cant / 2 < BORRADOS_SEGUIDOS ? cant / 2 : BORRADOS_SEGUIDOS;
+	inicio = medicion_reloj();
+	lista_iter_t* iter = lista_iter_crear(lista);
+	for (size_t i = 0; i < cant / 2; i++) lista_iter_avanzar(iter);
+	for (size_t i = 0; i < seguidos; i++) lista_borrar(lista, iter);
+	lista_iter_destruir(iter);
+	double borrar_seguidos = medicion_reloj() - inicio;
+
+	size_t largo = lista_largo(lista);
+	inicio = medicion_reloj();
+	iter = lista_iter_crear(lista);
+	while (!lista_iter_al_final(iter)) {
+		lista_borrar(lista, iter);
+		lista_iter_avanzar(iter);
+	}
+	lista_iter_destruir(iter);
+	double borrar_alternados = medicion_reloj() - inicio;
+	if (lista_largo(lista) != largo / 2) bien = false;
+
+	largo = lista_largo(lista);
+	inicio = medicion_reloj();
+	iter = lista_iter_crear(lista);
+	while (!lista_iter_al_final(iter)) lista_iter_avanzar(iter);
+	for (uintptr_t i = 1; i <= cant; i++) {
+		lista_insertar(lista, iter, (void*) i);
+		lista_iter_avanzar(iter);
+	}
+	lista_iter_destruir(iter);
+	double insertar_final = medicion_reloj() - inicio;
+	if (lista_largo(lista) != largo + cant) bien = false;
+
+	printf("%-13s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", modo, insertar * 1e3, iterar * 1e3, recorrer * 1e3,
+	       borrar_seguidos * 1e3, borrar_alternados * 1e3, insertar_final * 1e3);
+	lista_destruir(lista, NULL);
+	return bien;
+}
+
+int main(int argc, char* argv[]) {
+	size_t cant = argc > 1 ? strtoul(argv[1], NULL, 10) : ELEMENTOS;
+	printf("%zu elementos, en ms: insertar al principio, lista_iterar, iterador externo,\n", cant);
+	printf("borrar %d seguidos, borrar 1 de cada 2, insertar al final con el iterador\n", BORRADOS_SEGUIDOS);
+	bool bien = medir(lista_crear(), "común", cant);
+#ifndef ANTERIOR
+	bien = medir(lista_crear_desenrollada(), "desenrollada", cant) && bien;
+#endif
+	if (!bien) fprintf(stderr, "ERROR: la lista no dio los resultados esperados\n");
+	return bien ? 0 : 1;
+}
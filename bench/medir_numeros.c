@@ -0,0 +1,137 @@
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csv.h"
+#include "medicion.h"
+
+/* Compara csv_campo_numero() con strtoull(): primero verifica que acepten
+ * y conviertan igual PRUEBAS campos aleatorios (dígitos, otros caracteres,
+ * ceros a la izquierda, valores cerca de ULLONG_MAX), donde strtoull() se
+ * usa sólo en los campos formados por dígitos; después mide lo que tarda
+ * cada una en convertir los segundos campos de ARCHIVO (los aportes de
+ * un catálogo de pacientes), VUELTAS veces.
+ *
+ * Uso: ./medir_numeros ARCHIVO
+ */
+
+#define PRUEBAS 3000000
+#define VUELTAS 5
+#define LARGO_MAXIMO 26
+#define LARGO_LINEA 256
+
+// La conversión de referencia: el campo tiene que tener sólo dígitos, y
+// entrar en un unsigned long long.
+bool convertir_referencia(const char* campo, size_t largo, unsigned long long* numero) {
+	if (!largo) return false;
+	for (size_t i = 0; i < largo; i++) {
+		if (campo[i] < '0' || campo[i] > '9') return false;
+	}
+	char copia[LARGO_MAXIMO + 1];
+	memcpy(copia, campo, largo);
+	copia[largo] = '\0';
+	errno = 0;
+	*numero = strtoull(copia, NULL, 10);
+	return errno == 0;
+}
+
+// Arma un campo aleatorio en 'campo', y devuelve su largo.
+size_t campo_aleatorio(char campo[]) {
+	const char* otros = "x /-+:.";
+	size_t largo = (size_t) (medicion_aleatorio() % LARGO_MAXIMO);
+	for (size_t i = 0; i < largo; i++) {
+		if (medicion_aleatorio() % 50 == 0) campo[i] = otros[medicion_aleatorio() % 7];
+		else campo[i] = (char) ('0' + medicion_aleatorio() % 10);
+	}
+	if (medicion_aleatorio() % 4 == 0) {
+		size_t ceros = (size_t) (medicion_aleatorio() % 8);
+		for (size_t i = 0; i < ceros && i < largo; i++) campo[i] = '0';
+	}
+	// Cerca de ULLONG_MAX (18446744073709551615)
+	if (largo == 20 && medicion_aleatorio() % 10 == 0) memcpy(campo, "1844674407370955161", 19);
+	return largo;
+}
+
+// Devuelve los segundos campos de las líneas del archivo, y su cantidad en
+// 'cant'.
+char** leer_valores(const char* ruta, size_t* cant) {
+	FILE* archivo = fopen(ruta, "r");
+	if (!archivo) return NULL;
+	size_t capacidad = 1024;
+	char** valores = malloc(capacidad * sizeof(char*));
+	char linea[LARGO_LINEA];
+	*cant = 0;
+	while (valores && fgets(linea, LARGO_LINEA, archivo)) {
+		char* coma = strchr(linea, ',');
+		if (!coma) continue;
+		coma[1 + strcspn(coma + 1, "\n")] = '\0';
+		if (*cant == capacidad) {
+			capacidad *= 2;
+			char** mas = realloc(valores, capacidad * sizeof(char*));
+			if (!mas) free(valores);
+			valores = mas;
+			if (!valores) break;
+		}
+		valores[*cant] = malloc(strlen(coma + 1) + 1);
+		if (valores[*cant]) strcpy(valores[(*cant)++], coma + 1);
+	}
+	fclose(archivo);
+	return valores;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc != 2) {
+		fprintf(stderr, "Uso: %s ARCHIVO\n", argv[0]);
+		return 1;
+	}
+	medicion_semilla(5);
+	char campo[LARGO_MAXIMO];
+	for (size_t i = 0; i < PRUEBAS; i++) {
+		size_t largo = campo_aleatorio(campo);
+		unsigned long long numero = 7, referencia = 7;
+		bool convertido = csv_campo_numero((csv_campo_t) {campo, largo}, &numero);
+		bool esperado = convertir_referencia(campo, largo, &referencia);
+		if (convertido != esperado || (convertido && numero != referencia)) {
+			fprintf(stderr, "ERROR: '%.*s' da %d (%llu), se esperaba %d (%llu)\n", (int) largo, campo, convertido, numero, esperado, referencia);
+			return 1;
+		}
+	}
+	printf("%d campos aleatorios: igual que strtoull()\n", PRUEBAS);
+
+	size_t cant;
+	char** valores = leer_valores(argv[1], &cant);
+	size_t* largos = malloc(cant * sizeof(size_t));
+	if (!valores || !largos || !cant) return 1;
+	for (size_t i = 0; i < cant; i++) largos[i] = strlen(valores[i]);
+
+	unsigned long long suma_strtoull = 0, suma_campo = 0;
+	double inicio = medicion_reloj();
+	for (size_t v = 0; v < VUELTAS; v++) {
+		for (size_t i = 0; i < cant; i++) suma_strtoull += strtoull(valores[i], NULL, 10);
+	}
+	double duracion_strtoull = medicion_reloj() - inicio;
+	inicio = medicion_reloj();
+	for (size_t v = 0; v < VUELTAS; v++) {
+		for (size_t i = 0; i < cant; i++) {
+			unsigned long long numero = 0;
+			csv_campo_numero((csv_campo_t) {valores[i], largos[i]}, &numero);
+			suma_campo += numero;
+		}
+	}
+	double duracion_campo = medicion_reloj() - inicio;
+
+	double conversiones = (double) (cant * VUELTAS);
+	printf("%zu valores de %s, %d vueltas\n", cant, argv[1], VUELTAS);
+	printf("strtoull()          %5.1f ns/valor\n", duracion_strtoull / conversiones * 1e9);
+	printf("csv_campo_numero()  %5.1f ns/valor\n", duracion_campo / conversiones * 1e9);
+	for (size_t i = 0; i < cant; i++) free(valores[i]);
+	free(valores);
+	free(largos);
+	if (suma_strtoull != suma_campo) {
+		fprintf(stderr, "ERROR: las conversiones no coinciden\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,93 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "abb.h"
+#include "medicion.h"
+
+/* Mide el recorrido in order completo de un abb_t con el iterador externo
+ * (abb_iter_in_*) y con abb_recorrido_t. El árbol se arma con CLAVES
+ * claves aleatorias, de las que después se borra la mitad, para que tenga
+ * nodos con uno y dos hijos; se recorre VUELTAS veces. Verifica que cada
+ * recorrido dé todas las claves, en orden.
+ *
+ * Con -DANTERIOR (ver Makefile) sólo se mide el iterador externo.
+ *
+ * Uso: ./medir_recorrido_abb CLAVES VUELTAS
+ */
+
+int comparar(const char* a, const char* b) {
+	int r = strcmp(a, b);
+	return (r > 0) - (r < 0);
+}
+
+// Recorre el árbol con el iterador externo y devuelve cuántas claves vio,
+// o 0 si no estaban en orden.
+size_t recorrer_iter(const abb_t* abb) {
+	size_t vistas = 0;
+	const char* anterior = NULL;
+	abb_iter_t* iter = abb_iter_in_crear(abb);
+	for (; !abb_iter_in_al_final(iter); abb_iter_in_avanzar(iter), vistas++) {
+		const char* actual = abb_iter_in_ver_actual(iter);
+		if (anterior && strcmp(anterior, actual) >= 0) vistas = 0;
+		anterior = actual;
+	}
+	abb_iter_in_destruir(iter);
+	return vistas;
+}
+
+#ifndef ANTERIOR
+// Igual que recorrer_iter(), con abb_recorrido_t.
+size_t recorrer_recorrido(const abb_t* abb) {
+	size_t vistas = 0;
+	const char* anterior = NULL;
+	abb_recorrido_t recorrido;
+	abb_recorrido_iniciar(&recorrido, abb);
+	for (; !abb_recorrido_al_final(&recorrido); abb_recorrido_avanzar(&recorrido), vistas++) {
+		const char* actual = abb_recorrido_ver_actual(&recorrido);
+		if (anterior && strcmp(anterior, actual) >= 0) vistas = 0;
+		anterior = actual;
+	}
+	return vistas;
+}
+#endif
+
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		fprintf(stderr, "Uso: %s CLAVES VUELTAS\n", argv[0]);
+		return 1;
+	}
+	size_t cant = strtoul(argv[1], NULL, 10);
+	size_t vueltas = strtoul(argv[2], NULL, 10);
+	if (!cant || !vueltas) return 1;
+
+	medicion_semilla(7);
+	char** claves = medicion_claves(cant);
+	abb_t* abb = abb_crear(comparar, NULL);
+	if (!claves || !abb) return 1;
+	for (size_t i = 0; i < cant; i++) abb_guardar(abb, claves[i], NULL);
+	for (size_t i = 0; i < cant; i += 2) abb_borrar(abb, claves[i]);
+	size_t quedan = abb_cantidad(abb);
+
+	int estado = 0;
+	printf("%zu claves, %zu vueltas\n", quedan, vueltas);
+	double inicio = medicion_reloj();
+	for (size_t i = 0; i < vueltas; i++) {
+		if (recorrer_iter(abb) != quedan) estado = 1;
+	}
+	double duracion = medicion_reloj() - inicio;
+	printf("abb_iter_in      %6.1f ns/clave\n", duracion / (double) (vueltas * quedan) * 1e9);
+#ifndef ANTERIOR
+	inicio = medicion_reloj();
+	for (size_t i = 0; i < vueltas; i++) {
+		if (recorrer_recorrido(abb) != quedan) estado = 1;
+	}
+	duracion = medicion_reloj() - inicio;
+	printf("abb_recorrido_t  %6.1f ns/clave\n", duracion / (double) (vueltas * quedan) * 1e9);
+#endif
+	if (estado) fprintf(stderr, "ERROR: el recorrido no dio todas las claves en orden\n");
+
+	abb_destruir(abb);
+	medicion_claves_destruir(claves, cant);
+	return estado;
+}
@@ -0,0 +1,254 @@
+#define _POSIX_C_SOURCE 200809L  // Para fdatasync(), getline() y ftruncate().
+#include "bitacora.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define ENCABEZADO_BITACORA "BITACORA"
+#define ENCABEZADO_INSTANTANEA "INSTANTANEA"
+#define FIN_INSTANTANEA "FIN"
+#define SUFIJO_INSTANTANEA ".instantanea"
+#define SUFIJO_TEMPORAL ".tmp"
+#define MIN_BITACORA (1 << 20)   // Tamaño a partir del cual conviene una instantánea
+
+struct bitacora {
+	salida_t registros;          // Escribe en 'fd'
+	int fd;
+	char* ruta;
+	char* ruta_instantanea;
+	char* ruta_temporal;         // Instantánea en curso, hasta renombrarla
+	size_t generacion;
+	off_t sincronizado;          // Bytes de la bitácora ya en el disco
+	off_t tam_instantanea;
+	salida_t instantanea;        // Escribe en la instantánea en curso
+	size_t recuperados;          // Registros aplicados al abrirla
+	bool error;
+};
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Devuelve una copia de 'ruta' con 'sufijo' agregado, NULL si no hubo memoria.
+char* bitacora_ruta(const char* ruta, const char* sufijo) {
+	size_t largo = strlen(ruta);
+	char* copia = malloc(largo + strlen(sufijo) + 1);
+	if (!copia) return NULL;
+	memcpy(copia, ruta, largo);
+	strcpy(copia + largo, sufijo);
+	return copia;
+}
+
+// Lee el encabezado 'nombre' y su generación de la primera línea de 'linea'.
+// Post: Devuelve false si la línea no es ese encabezado.
+bool bitacora_leer_encabezado(const char* linea, const char* nombre, size_t* generacion) {
+	size_t largo = strlen(nombre);
+	if (strncmp(linea, nombre, largo) != 0 || linea[largo] != ' ') return false;
+	char* fin;
+	*generacion = (size_t) strtoull(linea + largo + 1, &fin, 10);
+	return fin != linea + largo + 1 && *fin == '\n';
+}
+
+// Aplica los registros de la instantánea, y guarda su generación y su
+// tamaño. Si no existe, es la generación 0.
+// Post: Devuelve false si no se pudo leer, o no está completa.
+bool bitacora_leer_instantanea(bitacora_t* bitacora, bitacora_aplicar_t aplicar, void* extra) {
+	FILE* archivo = fopen(bitacora->ruta_instantanea, "r");
+	if (!archivo) return access(bitacora->ruta_instantanea, F_OK) != 0;
+	char* linea = NULL;
+	size_t tam = 0;
+	ssize_t largo = getline(&linea, &tam, archivo);
+	bool ok = largo > 0 && bitacora_leer_encabezado(linea, ENCABEZADO_INSTANTANEA, &bitacora->generacion);
+	bool completa = false;
+	while (ok && !completa && (largo = getline(&linea, &tam, archivo)) > 0) {
+		// Se escribe entera antes de renombrarla: todas las líneas tienen '\n'
+		if (linea[largo - 1] != '\n') ok = false;
+		else {
+			linea[largo - 1] = '\0';
+			if (strcmp(linea, FIN_INSTANTANEA) == 0) completa = true;
+			else {
+				aplicar(linea, extra);
+				bitacora->recuperados++;
+			}
+		}
+	}
+	bitacora->tam_instantanea = ftello(archivo);
+	free(linea);
+	fclose(archivo);
+	return ok && completa;
+}
+
+// Aplica los registros de la bitácora si es de la generación de la
+// instantánea (o posterior), y guarda hasta dónde es válida: hasta el
+// último registro completo, o 0 si hay que descartarla.
+// Post: Devuelve false si no se pudo leer, o no empieza con un encabezado.
+bool bitacora_leer(bitacora_t* bitacora, bitacora_aplicar_t aplicar, void* extra) {
+	bitacora->sincronizado = 0;
+	FILE* archivo = fopen(bitacora->ruta, "r");
+	if (!archivo) return access(bitacora->ruta, F_OK) != 0;
+	char* linea = NULL;
+	size_t tam = 0;
+	ssize_t largo = getline(&linea, &tam, archivo);
+	bool ok = true;
+	size_t generacion;
+	// Vacía, o cortada al escribir el encabezado: se descarta
+	if (largo > 0 && linea[largo - 1] == '\n') {
+		ok = bitacora_leer_encabezado(linea, ENCABEZADO_BITACORA, &generacion);
+		if (ok && generacion >= bitacora->generacion) {
+			bitacora->generacion = generacion;
+			off_t valido = largo;
+			while ((largo = getline(&linea, &tam, archivo)) > 0 && linea[largo - 1] == '\n') {
+				valido += largo;
+				linea[largo - 1] = '\0';
+				aplicar(linea, extra);
+				bitacora->recuperados++;
+			}
+			bitacora->sincronizado = valido;
+		}
+	}
+	free(linea);
+	fclose(archivo);
+	return ok;
+}
+
+// Vacía la bitácora, y escribe el encabezado de su generación.
+// Post: Devuelve false si no se pudo escribir.
+bool bitacora_reiniciar(bitacora_t* bitacora) {
+	if (ftruncate(bitacora->fd, 0) != 0) return false;
+	salida_formato(&bitacora->registros, ENCABEZADO_BITACORA " %zu\n", bitacora->generacion);
+	bitacora->sincronizado = 0;
+	return bitacora_sincronizar(bitacora);
+}
+
+// Espera a que el directorio de 'ruta' tenga en el disco sus cambios (un
+// archivo renombrado).
+bool bitacora_sincronizar_directorio(const char* ruta) {
+	const char* barra = strrchr(ruta, '/');
+	// La raíz es "/"
+	char* directorio = barra ? strndup(ruta, barra == ruta ? 1 : (size_t) (barra - ruta)) : NULL;
+	if (barra && !directorio) return false;
+	int fd = open(directorio ? directorio : ".", O_RDONLY);
+	free(directorio);
+	if (fd < 0) return false;
+	bool ok = fsync(fd) == 0;
+	close(fd);
+	return ok;
+}
+
+// Deja de escribir la bitácora: los registros que se agreguen se descartan
+// al sincronizar.
+void bitacora_descartar(bitacora_t* bitacora) {
+	bitacora->registros.fd = SALIDA_MEMORIA;
+	salida_descartar(&bitacora->registros);
+}
+
+void bitacora_destruir(bitacora_t* bitacora) {
+	if (bitacora->fd >= 0) close(bitacora->fd);
+	salida_terminar(&bitacora->registros);
+	free(bitacora->ruta);
+	free(bitacora->ruta_instantanea);
+	free(bitacora->ruta_temporal);
+	free(bitacora);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA BITÁCORA
+ * *****************************************************************/
+
+bitacora_t* bitacora_abrir(const char* ruta, bitacora_aplicar_t aplicar, void* extra) {
+	bitacora_t* bitacora = calloc(1, sizeof(bitacora_t));
+	if (!bitacora) return NULL;
+	bitacora->fd = -1;
+	bitacora->ruta = bitacora_ruta(ruta, "");
+	bitacora->ruta_instantanea = bitacora_ruta(ruta, SUFIJO_INSTANTANEA);
+	bitacora->ruta_temporal = bitacora_ruta(ruta, SUFIJO_INSTANTANEA SUFIJO_TEMPORAL);
+	if (!bitacora->ruta || !bitacora->ruta_instantanea || !bitacora->ruta_temporal
+	    || !bitacora_leer_instantanea(bitacora, aplicar, extra) || !bitacora_leer(bitacora, aplicar, extra)) {
+		bitacora_destruir(bitacora);
+		return NULL;
+	}
+	bitacora->fd = open(ruta, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	bitacora->registros.fd = bitacora->fd;
+	if (bitacora->fd < 0) {
+		bitacora_destruir(bitacora);
+		return NULL;
+	}
+	// Sin registros válidos se empieza de nuevo; si no, se descarta lo que
+	// haya después del último registro completo
+	bool ok = bitacora->sincronizado ? ftruncate(bitacora->fd, bitacora->sincronizado) == 0 : bitacora_reiniciar(bitacora);
+	if (!ok) {
+		bitacora_destruir(bitacora);
+		return NULL;
+	}
+	return bitacora;
+}
+
+salida_t* bitacora_registros(bitacora_t* bitacora) {
+	return &bitacora->registros;
+}
+
+size_t bitacora_recuperados(const bitacora_t* bitacora) {
+	return bitacora->recuperados;
+}
+
+bool bitacora_sincronizar(bitacora_t* bitacora) {
+	if (bitacora->error) {
+		salida_descartar(&bitacora->registros);
+		return false;
+	}
+	if (!salida_vaciar(&bitacora->registros)) bitacora->error = true;
+	off_t tam = lseek(bitacora->fd, 0, SEEK_END);
+	if (tam < 0) bitacora->error = true;
+	else if (!bitacora->error && tam != bitacora->sincronizado) {
+		if (fdatasync(bitacora->fd) != 0) bitacora->error = true;
+		bitacora->sincronizado = tam;
+	}
+	// No se escribe nada más: lo siguiente podría aplicarse sin lo anterior
+	if (bitacora->error) bitacora_descartar(bitacora);
+	return !bitacora->error;
+}
+
+bool bitacora_conviene_instantanea(const bitacora_t* bitacora) {
+	return !bitacora->error && bitacora->sincronizado >= MIN_BITACORA && bitacora->sincronizado >= 2 * bitacora->tam_instantanea;
+}
+
+salida_t* bitacora_empezar_instantanea(bitacora_t* bitacora) {
+	if (!bitacora_sincronizar(bitacora)) return NULL;
+	// Si falla, no se vuelve a intentar enseguida
+	bitacora->tam_instantanea = bitacora->sincronizado;
+	int fd = open(bitacora->ruta_temporal, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return NULL;
+	bitacora->instantanea = (salida_t) {.fd = fd};
+	// Reemplaza a las bitácoras hasta la actual
+	salida_formato(&bitacora->instantanea, ENCABEZADO_INSTANTANEA " %zu\n", bitacora->generacion + 1);
+	return &bitacora->instantanea;
+}
+
+bool bitacora_terminar_instantanea(bitacora_t* bitacora) {
+	int fd = bitacora->instantanea.fd;
+	salida_cadena(&bitacora->instantanea, FIN_INSTANTANEA "\n");
+	bool ok = salida_terminar(&bitacora->instantanea);
+	off_t tam = lseek(fd, 0, SEEK_END);
+	ok = ok && tam >= 0 && fsync(fd) == 0;
+	close(fd);
+	if (!ok || rename(bitacora->ruta_temporal, bitacora->ruta_instantanea) != 0) {
+		unlink(bitacora->ruta_temporal);
+		return false;
+	}
+	bitacora->tam_instantanea = tam;
+	bitacora->generacion++;
+	// Si no se puede vaciar, lo que se agregue no se aplicaría al recuperar
+	if (!bitacora_sincronizar_directorio(bitacora->ruta_instantanea) || !bitacora_reiniciar(bitacora)) {
+		bitacora->error = true;
+		bitacora_descartar(bitacora);
+		return false;
+	}
+	return true;
+}
+
+void bitacora_cerrar(bitacora_t* bitacora) {
+	bitacora_sincronizar(bitacora);
+	bitacora_destruir(bitacora);
+}
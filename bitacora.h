@@ -0,0 +1,96 @@
+#ifndef BITACORA_H
+#define BITACORA_H
+
+#include "salida.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Bitácora de registros (write-ahead log) en un archivo, para recuperar un
+ * estado después de que el programa termine de cualquier forma. Cada
+ * registro es una línea de texto, cuyo significado es de quien la usa.
+ *
+ * Los registros se agregan a la salida de la bitácora (ver salida.h) y
+ * quedan en su buffer hasta sincronizarla: entonces se escriben todos
+ * juntos, y se espera a que estén en el disco con un único fdatasync().
+ * Sincronizar una vez por cada grupo de cambios, y no por cada uno, hace
+ * que la espera del disco no limite la cantidad de cambios por segundo.
+ *
+ * Para que la bitácora no crezca indefinidamente, cada tanto se reemplaza
+ * por una instantánea: un archivo aparte (RUTA.instantanea) con los
+ * registros mínimos para reconstruir el estado actual. Al recuperar se
+ * aplican los registros de la instantánea, y después los de la bitácora.
+ *
+ * Cada instantánea y cada bitácora empiezan con un número de generación:
+ * una instantánea de generación g reemplaza a las bitácoras de generación
+ * menor que g. La instantánea nueva se escribe en un archivo temporal que
+ * después se renombra, y recién entonces se vacía la bitácora, de modo
+ * que si el programa termina en cualquier momento hay una instantánea
+ * completa, y una bitácora que se aplica sobre ella o se descarta.
+ *
+ * Uso
+ * ===
+ *
+ *     bitacora_t* bitacora = bitacora_abrir(ruta, aplicar, estado);
+ *     salida_formato(bitacora_registros(bitacora), "E:%s,%s\n", ...);
+ *     bitacora_sincronizar(bitacora);
+ *     ...
+ *     bitacora_cerrar(bitacora);
+ */
+
+typedef struct bitacora bitacora_t;
+
+// Función que aplica un registro (una línea, sin su '\n') al recuperar.
+typedef void (*bitacora_aplicar_t)(char* registro, void* extra);
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LA BITÁCORA
+ * *****************************************************************/
+
+// Recupera el estado guardado en 'ruta': aplica en orden los registros de
+// su instantánea si hay una, y los de la bitácora si no es anterior a la
+// instantánea. Un último registro sin '\n' (se cortó su escritura) se
+// descarta. Si la bitácora no existe, la crea.
+// Post: Devuelve la bitácora, lista para agregarle registros, o NULL si no
+// se pudo abrir, o si la instantánea o la bitácora no son válidas.
+bitacora_t* bitacora_abrir(const char* ruta, bitacora_aplicar_t aplicar, void* extra);
+
+// Devuelve la salida en la que se agregan los registros, de a una línea
+// terminada en '\n' cada uno.
+salida_t* bitacora_registros(bitacora_t* bitacora);
+
+// Devuelve la cantidad de registros (de la instantánea y de la bitácora)
+// que se aplicaron al abrirla.
+size_t bitacora_recuperados(const bitacora_t* bitacora);
+
+// Escribe los registros agregados desde la última vez, y espera a que
+// estén en el disco.
+// Post: Devuelve false si falló alguna escritura. La bitácora ya no
+// escribe nada más.
+bool bitacora_sincronizar(bitacora_t* bitacora);
+
+// Devuelve true si la bitácora creció desde la última instantánea lo
+// suficiente para que convenga tomar una nueva: al menos el doble de lo que
+// ocupa la instantánea, y al menos un mínimo. Si no se pudo tomar la
+// última, hasta que la bitácora duplique lo que ocupaba al intentarlo.
+bool bitacora_conviene_instantanea(const bitacora_t* bitacora);
+
+// Sincroniza la bitácora, y empieza una instantánea nueva.
+// Post: Devuelve la salida en la que se escriben los registros de la
+// instantánea, NULL si no se pudo crear.
+salida_t* bitacora_empezar_instantanea(bitacora_t* bitacora);
+
+// Termina la instantánea en curso: la escribe en el disco, reemplaza con
+// ella a la anterior, y vacía la bitácora.
+// Pre: Se empezó una instantánea, y no se agregaron registros desde entonces.
+// Post: Devuelve false si no se pudo escribir; la instantánea anterior y la
+// bitácora siguen siendo válidas.
+bool bitacora_terminar_instantanea(bitacora_t* bitacora);
+
+// Sincroniza y cierra la bitácora.
+void bitacora_cerrar(bitacora_t* bitacora);
+
+#endif // BITACORA_H
@@ -0,0 +1,177 @@
+#include "cadenas.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAM_BLOQUE 65536       // Las cadenas más largas van en un bloque propio
+#define CAPACIDAD_INICIAL 64   // Potencia de dos
+#define FNV_BASE 0xcbf29ce484222325u
+#define FNV_PRIMO 0x100000001b3u
+
+// Cada bloque empieza con un puntero al bloque anterior, seguido de las
+// copias de las cadenas.
+typedef struct bloque {
+	struct bloque* anterior;
+	char cadenas[];
+} bloque_t;
+
+// Ranura del índice: NULL si está vacía. Se guarda parte del hash de la
+// cadena para no comparar cadenas cuyo hash es distinto.
+typedef struct ranura {
+	const char* cadena;
+	uint32_t hash;
+	uint32_t id;
+} ranura_t;
+
+/* El índice usa direccionamiento abierto con sondeo lineal, y se duplica
+ * al llegar a la mitad de su capacidad, que es siempre potencia de dos. */
+
+struct cadenas {
+	ranura_t* indice;
+	size_t capacidad;
+	size_t cantidad;
+	bloque_t* bloques;     // Último bloque reservado
+	char* proximo;         // Primer byte libre del último bloque
+	char* fin;             // Fin del último bloque
+	size_t memoria;
+	size_t redimensiones;  // Veces que se agrandó el índice
+};
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Función de hashing de las cadenas (FNV-1a).
+uint64_t cadenas_fhash(const char* cadena) {
+	uint64_t hash = FNV_BASE;
+	for (const unsigned char* c = (const unsigned char*) cadena; *c; c++)
+		hash = (hash ^ *c) * FNV_PRIMO;
+	return hash;
+}
+
+// Devuelve la ranura de la cadena si fue internada, o la ranura vacía
+// donde iría si no.
+size_t cadenas_ranura(const ranura_t* indice, size_t capacidad, const char* cadena, uint64_t hash) {
+	size_t mascara = capacidad - 1;
+	size_t i = (uint32_t) hash & mascara;
+	while (indice[i].cadena) {
+		if (indice[i].hash == (uint32_t) hash && strcmp(indice[i].cadena, cadena) == 0) break;
+		i = (i + 1) & mascara;
+	}
+	return i;
+}
+
+// Duplica la capacidad del índice. Devuelve false si no hubo memoria.
+bool cadenas_agrandar_indice(cadenas_t* cadenas) {
+	size_t capacidad = cadenas->capacidad * 2;
+	ranura_t* indice = calloc(capacidad, sizeof(ranura_t));
+	if (!indice) return false;
+	for (size_t i = 0; i < cadenas->capacidad; i++) {
+		const ranura_t* ranura = &cadenas->indice[i];
+		if (!ranura->cadena) continue;
+		size_t mascara = capacidad - 1;
+		size_t j = ranura->hash & mascara;
+		while (indice[j].cadena) j = (j + 1) & mascara;
+		indice[j] = *ranura;
+	}
+	free(cadenas->indice);
+	cadenas->memoria += (capacidad - cadenas->capacidad) * sizeof(ranura_t);
+	cadenas->indice = indice;
+	cadenas->capacidad = capacidad;
+	cadenas->redimensiones++;
+	return true;
+}
+
+// Devuelve lugar para 'tam' bytes en el último bloque, reservando uno nuevo
+// si no alcanza. Devuelve NULL si no hubo memoria.
+char* cadenas_lugar(cadenas_t* cadenas, size_t tam) {
+	if ((size_t) (cadenas->fin - cadenas->proximo) < tam) {
+		size_t tam_bloque = tam > TAM_BLOQUE ? tam : TAM_BLOQUE;
+		bloque_t* bloque = malloc(sizeof(bloque_t) + tam_bloque);
+		if (!bloque) return NULL;
+		bloque->anterior = cadenas->bloques;
+		cadenas->bloques = bloque;
+		cadenas->proximo = bloque->cadenas;
+		cadenas->fin = bloque->cadenas + tam_bloque;
+		cadenas->memoria += sizeof(bloque_t) + tam_bloque;
+	}
+	char* lugar = cadenas->proximo;
+	cadenas->proximo += tam;
+	return lugar;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA TABLA
+ * *****************************************************************/
+
+cadenas_t* cadenas_crear(void) {
+	cadenas_t* cadenas = malloc(sizeof(cadenas_t));
+	if (!cadenas) return NULL;
+	cadenas->indice = calloc(CAPACIDAD_INICIAL, sizeof(ranura_t));
+	if (!cadenas->indice) {
+		free(cadenas);
+		return NULL;
+	}
+	cadenas->capacidad = CAPACIDAD_INICIAL;
+	cadenas->cantidad = 0;
+	cadenas->bloques = NULL;
+	cadenas->proximo = NULL;
+	cadenas->fin = NULL;
+	cadenas->memoria = sizeof(cadenas_t) + CAPACIDAD_INICIAL * sizeof(ranura_t);
+	cadenas->redimensiones = 0;
+	return cadenas;
+}
+
+const char* cadenas_internar(cadenas_t* cadenas, const char* cadena, size_t* id) {
+	uint64_t hash = cadenas_fhash(cadena);
+	size_t i = cadenas_ranura(cadenas->indice, cadenas->capacidad, cadena, hash);
+	if (cadenas->indice[i].cadena) {
+		if (id) *id = cadenas->indice[i].id;
+		return cadenas->indice[i].cadena;
+	}
+	if (cadenas->cantidad == UINT32_MAX) return NULL;
+
+	if (2 * (cadenas->cantidad + 1) > cadenas->capacidad) {
+		if (!cadenas_agrandar_indice(cadenas)) return NULL;
+		i = cadenas_ranura(cadenas->indice, cadenas->capacidad, cadena, hash);
+	}
+	size_t largo = strlen(cadena) + 1;
+	char* copia = cadenas_lugar(cadenas, largo);
+	if (!copia) return NULL;
+	memcpy(copia, cadena, largo);
+	cadenas->indice[i].cadena = copia;
+	cadenas->indice[i].hash = (uint32_t) hash;
+	cadenas->indice[i].id = (uint32_t) cadenas->cantidad;
+	if (id) *id = cadenas->cantidad;
+	cadenas->cantidad++;
+	return copia;
+}
+
+const char* cadenas_buscar(const cadenas_t* cadenas, const char* cadena, size_t* id) {
+	size_t i = cadenas_ranura(cadenas->indice, cadenas->capacidad, cadena, cadenas_fhash(cadena));
+	if (id && cadenas->indice[i].cadena) *id = cadenas->indice[i].id;
+	return cadenas->indice[i].cadena;
+}
+
+size_t cadenas_cantidad(const cadenas_t* cadenas) {
+	return cadenas->cantidad;
+}
+
+size_t cadenas_memoria(const cadenas_t* cadenas) {
+	return cadenas->memoria;
+}
+
+size_t cadenas_redimensiones(const cadenas_t* cadenas) {
+	return cadenas->redimensiones;
+}
+
+void cadenas_destruir(cadenas_t* cadenas) {
+	if (!cadenas) return;
+	while (cadenas->bloques) {
+		bloque_t* anterior = cadenas->bloques->anterior;
+		free(cadenas->bloques);
+		cadenas->bloques = anterior;
+	}
+	free(cadenas->indice);
+	free(cadenas);
+}
@@ -0,0 +1,60 @@
+#ifndef CADENAS_H
+#define CADENAS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Tabla de cadenas internadas: guarda una sola copia de cada cadena
+ * distinta, y devuelve siempre el mismo puntero para cadenas iguales. Dos
+ * cadenas internadas en la misma tabla son iguales si y sólo si sus
+ * punteros lo son, por lo que se comparan sin strcmp.
+ *
+ * Las copias se guardan una a continuación de otra en bloques grandes que
+ * nunca se mueven ni se liberan por separado: los punteros devueltos son
+ * válidos hasta destruir la tabla. Cada cadena recibe además un número,
+ * en el orden en que se internó (0, 1, 2, ...), para poder asociarle
+ * datos en un arreglo. */
+
+typedef struct cadenas cadenas_t;
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LA TABLA
+ * *****************************************************************/
+
+// Crea una tabla de cadenas vacía.
+// Post: Devuelve la tabla, NULL si no hubo memoria.
+cadenas_t* cadenas_crear(void);
+
+// Interna una cadena, copiándola si es la primera vez que aparece.
+// Pre: La tabla fue creada.
+// Post: Devuelve la copia interna de la cadena, NULL si no hubo memoria.
+// Si 'id' no es NULL, guarda en él el número de la cadena.
+const char* cadenas_internar(cadenas_t* cadenas, const char* cadena, size_t* id);
+
+// Busca una cadena sin internarla.
+// Pre: La tabla fue creada.
+// Post: Devuelve la copia interna de la cadena, NULL si no fue internada.
+// Si fue internada y 'id' no es NULL, guarda en él el número de la cadena.
+const char* cadenas_buscar(const cadenas_t* cadenas, const char* cadena, size_t* id);
+
+// Devuelve la cantidad de cadenas distintas internadas.
+// Pre: La tabla fue creada.
+size_t cadenas_cantidad(const cadenas_t* cadenas);
+
+// Devuelve los bytes reservados por la tabla (copias e índice).
+// Pre: La tabla fue creada.
+size_t cadenas_memoria(const cadenas_t* cadenas);
+
+// Devuelve la cantidad de veces que se agrandó el índice de la tabla.
+// Pre: La tabla fue creada.
+size_t cadenas_redimensiones(const cadenas_t* cadenas);
+
+// Destruye la tabla. Las cadenas internadas dejan de ser válidas.
+// Pre: La tabla fue creada.
+void cadenas_destruir(cadenas_t* cadenas);
+
+#endif // CADENAS_H
@@ -0,0 +1,295 @@
+#define _POSIX_C_SOURCE 200809L  // Para getline() y clock_gettime().
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Generador de carga para "tp --servir RUTA". Abre CLIENTES conexiones al
+ * socket RUTA, cada una desde su propio hilo, y por cada una manda PEDIDOS
+ * comandos tomados en orden del archivo COMANDOS (volviendo al principio
+ * al terminarlo, y empezando cada cliente en una línea distinta). Cada
+ * cliente manda un comando y espera su respuesta antes de mandar el
+ * siguiente, de modo que hay a lo sumo CLIENTES pedidos en curso.
+ *
+ * Al terminar informa cuántos pedidos por segundo se respondieron, y los
+ * percentiles de la latencia (desde que se manda un comando hasta que
+ * llega su respuesta).
+ *
+ * El servidor termina cada respuesta con una línea vacía. Las líneas vacías
+ * del archivo se saltean.
+ *
+ * Con --enviar, en cambio, manda al socket RUTA la entrada estándar tal
+ * cual, cierra su lado de la conexión al terminarla, y escribe las
+ * respuestas sin sus líneas vacías (igual que "tp" leyendo de la entrada
+ * estándar) hasta que el servidor cierra la conexión.
+ *
+ * Uso: ./carga RUTA CLIENTES PEDIDOS COMANDOS
+ *      ./carga --enviar RUTA < COMANDOS
+ */
+
+#define MAX_CLIENTES 1024
+#define TAM_RESPUESTA 65536   // Lo que no entra de una respuesta se descarta
+
+typedef struct comandos {
+	char** lineas;            // Con su '\n'
+	size_t cantidad;
+} comandos_t;
+
+typedef struct cliente {
+	const char* ruta;
+	const comandos_t* comandos;
+	size_t primero;           // Primer comando que manda
+	size_t pedidos;
+	double* latencias;        // En segundos, una por pedido respondido
+	size_t respondidos;
+	pthread_t hilo;
+} cliente_t;
+
+double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double) t.tv_sec + (double) t.tv_nsec / 1e9;
+}
+
+int cmp_double(const void* a, const void* b) {
+	double x = *(const double*) a, y = *(const double*) b;
+	return (x > y) - (x < y);
+}
+
+// Lee las líneas no vacías del archivo.
+// Post: Devuelve false si no se pudo leer, o si no tiene ninguna.
+bool comandos_leer(comandos_t* comandos, const char* archivo) {
+	FILE* fp = fopen(archivo, "r");
+	if (!fp) return false;
+	comandos->lineas = NULL;
+	comandos->cantidad = 0;
+	size_t capacidad = 0;
+	char* linea = NULL;
+	size_t tam = 0;
+	ssize_t largo;
+	bool ok = true;
+	while ((largo = getline(&linea, &tam, fp)) != -1) {
+		if (largo == 1 && linea[0] == '\n') continue;
+		if (comandos->cantidad == capacidad) {
+			capacidad = capacidad ? 2 * capacidad : 1024;
+			char** lineas = realloc(comandos->lineas, capacidad * sizeof(char*));
+			if (!lineas) {
+				ok = false;
+				break;
+			}
+			comandos->lineas = lineas;
+		}
+		char* copia = malloc((size_t) largo + 2);
+		if (!copia) {
+			ok = false;
+			break;
+		}
+		memcpy(copia, linea, (size_t) largo + 1);
+		// La última línea puede no tener su '\n'
+		if (copia[largo - 1] != '\n') strcpy(copia + largo, "\n");
+		comandos->lineas[comandos->cantidad++] = copia;
+	}
+	free(linea);
+	fclose(fp);
+	return ok && comandos->cantidad > 0;
+}
+
+void comandos_destruir(comandos_t* comandos) {
+	for (size_t i = 0; i < comandos->cantidad; i++) free(comandos->lineas[i]);
+	free(comandos->lineas);
+}
+
+// Devuelve un socket conectado a 'ruta', -1 si no se pudo conectar.
+int conectar(const char* ruta) {
+	struct sockaddr_un direccion = {.sun_family = AF_UNIX};
+	if (strlen(ruta) >= sizeof(direccion.sun_path)) return -1;
+	strcpy(direccion.sun_path, ruta);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) return -1;
+	if (connect(fd, (struct sockaddr*) &direccion, sizeof(direccion)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+bool escribir_todo(int fd, const char* datos, size_t largo) {
+	while (largo > 0) {
+		ssize_t n = send(fd, datos, largo, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		datos += n;
+		largo -= (size_t) n;
+	}
+	return true;
+}
+
+// Devuelve el '\n' de la línea vacía que termina la primera respuesta de
+// las 'leidos' bytes, NULL si no llegó entera. 'inicio_linea' indica si
+// el primer byte empieza una línea: al principio de la respuesta, o si lo
+// último que se descartó de ella fue un '\n'.
+char* fin_respuesta(char* respuesta, size_t leidos, bool inicio_linea) {
+	for (size_t i = 0; i < leidos; i++) {
+		if (respuesta[i] == '\n' && (i == 0 ? inicio_linea : respuesta[i - 1] == '\n')) return respuesta + i;
+	}
+	return NULL;
+}
+
+// Hilo de un cliente: manda sus pedidos de a uno, y anota la latencia de
+// cada respuesta.
+void* ejecutar_cliente(void* dato) {
+	cliente_t* cliente = dato;
+	int fd = conectar(cliente->ruta);
+	if (fd < 0) return NULL;
+	char respuesta[TAM_RESPUESTA];
+	size_t leidos = 0;
+	for (size_t i = 0; i < cliente->pedidos; i++) {
+		const char* comando = cliente->comandos->lineas[(cliente->primero + i) % cliente->comandos->cantidad];
+		double inicio = ahora();
+		if (!escribir_todo(fd, comando, strlen(comando))) break;
+		char* fin;
+		bool cerrado = false;
+		bool inicio_linea = true;
+		while (!(fin = fin_respuesta(respuesta, leidos, inicio_linea))) {
+			// Se descarta lo leído, recordando si terminaba una línea
+			if (leidos == sizeof(respuesta)) {
+				inicio_linea = respuesta[leidos - 1] == '\n';
+				leidos = 0;
+			}
+			ssize_t n = read(fd, respuesta + leidos, sizeof(respuesta) - leidos);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) {
+				cerrado = true;
+				break;
+			}
+			leidos += (size_t) n;
+		}
+		if (cerrado) break;
+		cliente->latencias[cliente->respondidos++] = ahora() - inicio;
+		size_t largo = (size_t) (fin - respuesta) + 1;
+		memmove(respuesta, respuesta + largo, leidos - largo);
+		leidos -= largo;
+	}
+	close(fd);
+	return NULL;
+}
+
+// Hilo que manda la entrada estándar al socket, y después cierra su
+// escritura.
+void* enviar_entrada(void* dato) {
+	int fd = *(int*) dato;
+	char bloque[4096];
+	ssize_t n;
+	while ((n = read(STDIN_FILENO, bloque, sizeof(bloque))) != 0) {
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0 || !escribir_todo(fd, bloque, (size_t) n)) break;
+	}
+	shutdown(fd, SHUT_WR);
+	return NULL;
+}
+
+// Manda la entrada estándar al socket 'ruta' y escribe las respuestas, sin
+// las líneas vacías que las terminan. Se lee mientras se manda, para que
+// el servidor nunca espere a que se lean sus respuestas.
+// Post: Devuelve false si no se pudo conectar.
+bool enviar(const char* ruta) {
+	int fd = conectar(ruta);
+	if (fd < 0) return false;
+	pthread_t hilo;
+	if (pthread_create(&hilo, NULL, enviar_entrada, &fd) != 0) {
+		close(fd);
+		return false;
+	}
+	char respuesta[4096];
+	bool inicio_linea = true;
+	ssize_t n;
+	while ((n = read(fd, respuesta, sizeof(respuesta))) != 0) {
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0) break;
+		for (ssize_t i = 0; i < n; i++) {
+			if (respuesta[i] != '\n' || !inicio_linea) putchar(respuesta[i]);
+			inicio_linea = respuesta[i] == '\n';
+		}
+	}
+	pthread_join(hilo, NULL);
+	close(fd);
+	return fflush(stdout) == 0;
+}
+
+// Devuelve el percentil 'p' (de 0 a 100) de las latencias ordenadas.
+double percentil(const double latencias[], size_t cantidad, double p) {
+	size_t i = (size_t) (p / 100 * (double) cantidad);
+	return latencias[i < cantidad ? i : cantidad - 1];
+}
+
+int main(int argc, char* argv[]) {
+	if (argc == 3 && strcmp(argv[1], "--enviar") == 0) {
+		if (enviar(argv[2])) return 0;
+		fprintf(stderr, "No se pudo conectar a '%s'\n", argv[2]);
+		return 1;
+	}
+	if (argc != 5) {
+		fprintf(stderr, "Uso: %s RUTA CLIENTES PEDIDOS COMANDOS\n     %s --enviar RUTA < COMANDOS\n", argv[0], argv[0]);
+		return 1;
+	}
+	char* fin_clientes;
+	char* fin_pedidos;
+	unsigned long cant_clientes = strtoul(argv[2], &fin_clientes, 10);
+	unsigned long pedidos = strtoul(argv[3], &fin_pedidos, 10);
+	if (*fin_clientes != '\0' || *fin_pedidos != '\0' || cant_clientes < 1 || cant_clientes > MAX_CLIENTES || pedidos < 1) {
+		fprintf(stderr, "Uso: %s RUTA CLIENTES PEDIDOS COMANDOS\n     %s --enviar RUTA < COMANDOS\n", argv[0], argv[0]);
+		return 1;
+	}
+	comandos_t comandos;
+	if (!comandos_leer(&comandos, argv[4])) {
+		fprintf(stderr, "No se pudieron leer los comandos de '%s'\n", argv[4]);
+		return 1;
+	}
+
+	cliente_t* clientes = calloc(cant_clientes, sizeof(cliente_t));
+	double* latencias = malloc(cant_clientes * pedidos * sizeof(double));
+	if (!clientes || !latencias) {
+		fprintf(stderr, "No hay memoria para %lu clientes de %lu pedidos\n", cant_clientes, pedidos);
+		return 1;
+	}
+	double inicio = ahora();
+	size_t lanzados = 0;
+	for (size_t i = 0; i < cant_clientes; i++) {
+		cliente_t* cliente = &clientes[i];
+		cliente->ruta = argv[1];
+		cliente->comandos = &comandos;
+		cliente->primero = i * comandos.cantidad / cant_clientes;
+		cliente->pedidos = pedidos;
+		cliente->latencias = latencias + i * pedidos;
+		if (pthread_create(&cliente->hilo, NULL, ejecutar_cliente, cliente) != 0) break;
+		lanzados++;
+	}
+	// Las latencias de cada cliente se juntan al principio del arreglo
+	size_t respondidos = 0;
+	for (size_t i = 0; i < lanzados; i++) {
+		pthread_join(clientes[i].hilo, NULL);
+		memmove(latencias + respondidos, clientes[i].latencias, clientes[i].respondidos * sizeof(double));
+		respondidos += clientes[i].respondidos;
+	}
+	double total = ahora() - inicio;
+
+	printf("%zu cliente(s), %zu pedido(s) respondido(s) de %lu en %.3f s\n", lanzados, respondidos, cant_clientes * pedidos, total);
+	if (respondidos > 0) {
+		qsort(latencias, respondidos, sizeof(double), cmp_double);
+		printf("%.0f pedidos/s\n", (double) respondidos / total);
+		printf("latencia (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+		       percentil(latencias, respondidos, 50) * 1e6, percentil(latencias, respondidos, 90) * 1e6,
+		       percentil(latencias, respondidos, 99) * 1e6, percentil(latencias, respondidos, 99.9) * 1e6,
+		       latencias[respondidos - 1] * 1e6);
+	}
+	free(latencias);
+	free(clientes);
+	comandos_destruir(&comandos);
+	return respondidos == cant_clientes * pedidos ? 0 : 1;
+}
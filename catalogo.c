@@ -0,0 +1,447 @@
+#define _POSIX_C_SOURCE 200809L  // Para fstat() y mmap().
+
+#include "catalogo.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CATALOGO_MAGIA "CLINCAT"     // Con su '\0', ocupa los 8 bytes de la cabecera
+#define CATALOGO_VERSION 1
+#define CATALOGO_ORDEN_BYTES 0x01020304u
+#define CATALOGO_ALINEACION 8        // Todas las secciones empiezan alineadas a 8 bytes
+#define CAPACIDAD_MINIMA 8           // Capacidad mínima de un índice (potencia de dos)
+#define CAPACIDAD_INICIAL 16         // Capacidad inicial de los arreglos del armado
+
+// Constantes de FNV-1a (64 bits), usadas para el índice y la suma de verificación
+#define FNV_BASE 0xcbf29ce484222325u
+#define FNV_PRIMO 0x100000001b3u
+
+/* *****************************************************************
+ *                   DEFINICION TIPOS DE DATOS
+ * *****************************************************************/
+
+/* La cabecera está al principio del archivo; las posiciones de las
+ * secciones son relativas al principio del archivo, y la suma de
+ * verificación abarca todo lo que sigue a la cabecera. Todos los campos son
+ * de 64 bits para que su disposición no dependa del compilador. */
+
+typedef struct catalogo_cabecera {
+	char magia[8];
+	uint32_t version;
+	uint32_t orden_bytes;                // CATALOGO_ORDEN_BYTES en el orden de la máquina
+	uint64_t tam;                        // Tamaño total del archivo
+	uint64_t suma;
+	uint64_t nombres;                    // Posición y tamaño del pool de nombres
+	uint64_t tam_nombres;
+	uint64_t cantidad[CATALOGO_TABLAS];
+	uint64_t registros[CATALOGO_TABLAS]; // Posición de cada tabla
+	uint64_t capacidad[CATALOGO_TABLAS]; // Ranuras de cada índice (potencia de dos)
+	uint64_t indices[CATALOGO_TABLAS];   // Posición de cada índice
+	uint64_t orden_doctores;
+} catalogo_cabecera_t;
+
+// Tamaño de los registros de cada tabla, en el orden de catalogo_tabla_t
+static const size_t TAM_REGISTRO[CATALOGO_TABLAS] = {
+	sizeof(catalogo_doctor_t),
+	sizeof(catalogo_especialidad_t),
+	sizeof(catalogo_paciente_t)
+};
+
+/* Cada ranura de un índice guarda el número de registro más uno, o 0 si
+ * está vacía. La capacidad es siempre mayor a la cantidad de registros, así
+ * que toda búsqueda termina en una ranura vacía si el nombre no está. */
+
+struct catalogo_armado {
+	char* nombres;
+	size_t tam_nombres;
+	size_t cap_nombres;
+	void* registros[CATALOGO_TABLAS];
+	size_t cantidad[CATALOGO_TABLAS];
+	size_t capacidad[CATALOGO_TABLAS];
+	uint32_t* indice_especialidades;     // Para no repetir especialidades
+	size_t cap_indice_especialidades;
+};
+
+// Doctor a ordenar alfabéticamente al guardar
+typedef struct catalogo_orden {
+	const char* nombre;
+	uint32_t id;
+} catalogo_orden_t;
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Función de hashing de los nombres (FNV-1a).
+uint64_t catalogo_fhash(const char* nombre) {
+	uint64_t hash = FNV_BASE;
+	for (const unsigned char* c = (const unsigned char*) nombre; *c; c++)
+		hash = (hash ^ *c) * FNV_PRIMO;
+	return hash;
+}
+
+// Suma de verificación de 'tam' bytes: FNV-1a aplicado de a palabras de
+// ocho bytes en lugar de byte a byte, para recorrer la imagen rápido.
+// Pre: tam es múltiplo de 8.
+uint64_t catalogo_suma(const char* datos, size_t tam) {
+	uint64_t suma = FNV_BASE;
+	for (size_t i = 0; i < tam; i += sizeof(uint64_t)) {
+		uint64_t palabra;
+		memcpy(&palabra, datos + i, sizeof(palabra));
+		suma = (suma ^ palabra) * FNV_PRIMO;
+	}
+	return suma;
+}
+
+// Redondea tam al múltiplo de CATALOGO_ALINEACION inmediato superior.
+size_t catalogo_alinear(size_t tam) {
+	return (tam + CATALOGO_ALINEACION - 1) / CATALOGO_ALINEACION * CATALOGO_ALINEACION;
+}
+
+// Devuelve la capacidad del índice de una tabla de 'cantidad' registros: la
+// menor potencia de dos que lo deja ocupado a lo sumo hasta la mitad.
+size_t catalogo_capacidad(size_t cantidad) {
+	size_t capacidad = CAPACIDAD_MINIMA;
+	while (capacidad < 2 * cantidad) capacidad *= 2;
+	return capacidad;
+}
+
+// Devuelve la ranura del índice que corresponde a 'nombre': la que tiene su
+// registro si está, o la ranura vacía donde iría si no está. Los registros
+// son de 'tam_registro' bytes y empiezan con la posición de su nombre.
+size_t catalogo_ranura(const uint32_t* indice, size_t capacidad, const char* nombres, const void* registros, size_t tam_registro, const char* nombre) {
+	size_t mascara = capacidad - 1;
+	size_t i = (size_t) catalogo_fhash(nombre) & mascara;
+	while (indice[i]) {
+		uint32_t pos_nombre;
+		memcpy(&pos_nombre, (const char*) registros + (indice[i] - 1) * tam_registro, sizeof(pos_nombre));
+		if (strcmp(nombres + pos_nombre, nombre) == 0) break;
+		i = (i + 1) & mascara;
+	}
+	return i;
+}
+
+// Llena un índice vacío de 'capacidad' ranuras con 'cantidad' registros de
+// nombres distintos.
+void catalogo_indexar(uint32_t* indice, size_t capacidad, const char* nombres, const void* registros, size_t tam_registro, size_t cantidad) {
+	for (size_t id = 0; id < cantidad; id++) {
+		uint32_t pos_nombre;
+		memcpy(&pos_nombre, (const char*) registros + id * tam_registro, sizeof(pos_nombre));
+		size_t i = catalogo_ranura(indice, capacidad, nombres, registros, tam_registro, nombres + pos_nombre);
+		indice[i] = (uint32_t) id + 1;
+	}
+}
+
+// Devuelve los registros de una tabla del catálogo abierto.
+const void* catalogo_registros(const catalogo_t* catalogo, catalogo_tabla_t tabla) {
+	switch (tabla) {
+		case CATALOGO_DOCTORES: return catalogo->doctores;
+		case CATALOGO_ESPECIALIDADES: return catalogo->especialidades;
+		default: return catalogo->pacientes;
+	}
+}
+
+// Devuelve true si la sección [inicio, inicio + tam) está alineada y
+// dentro de un archivo de tam_archivo bytes.
+bool catalogo_seccion_valida(uint64_t tam_archivo, uint64_t inicio, uint64_t tam) {
+	return inicio % CATALOGO_ALINEACION == 0 && inicio <= tam_archivo && tam <= tam_archivo - inicio;
+}
+
+// Verifica la cabecera de una imagen de tam_archivo bytes: su versión, que
+// las secciones estén dentro del archivo y la suma de verificación.
+bool catalogo_cabecera_valida(const catalogo_cabecera_t* cabecera, const char* datos, size_t tam_archivo) {
+	if (memcmp(cabecera->magia, CATALOGO_MAGIA, sizeof(cabecera->magia)) != 0) return false;
+	if (cabecera->version != CATALOGO_VERSION || cabecera->orden_bytes != CATALOGO_ORDEN_BYTES) return false;
+	if (cabecera->tam != tam_archivo || tam_archivo % CATALOGO_ALINEACION != 0) return false;
+	if (cabecera->tam_nombres == 0 || !catalogo_seccion_valida(tam_archivo, cabecera->nombres, cabecera->tam_nombres)) return false;
+	if (cabecera->tam_nombres > UINT32_MAX) return false;
+	for (int t = 0; t < CATALOGO_TABLAS; t++) {
+		uint64_t cantidad = cabecera->cantidad[t];
+		uint64_t capacidad = cabecera->capacidad[t];
+		// La capacidad debe ser potencia de dos y dejar alguna ranura vacía
+		if (cantidad >= UINT32_MAX || capacidad <= cantidad || (capacidad & (capacidad - 1)) != 0) return false;
+		if (capacidad > tam_archivo / sizeof(uint32_t)) return false;
+		if (!catalogo_seccion_valida(tam_archivo, cabecera->registros[t], cantidad * TAM_REGISTRO[t])) return false;
+		if (!catalogo_seccion_valida(tam_archivo, cabecera->indices[t], capacidad * sizeof(uint32_t))) return false;
+	}
+	uint64_t tam_orden = cabecera->cantidad[CATALOGO_DOCTORES] * sizeof(uint32_t);
+	if (!catalogo_seccion_valida(tam_archivo, cabecera->orden_doctores, tam_orden)) return false;
+	return catalogo_suma(datos + sizeof(catalogo_cabecera_t), tam_archivo - sizeof(catalogo_cabecera_t)) == cabecera->suma;
+}
+
+// Verifica que las posiciones y números guardados en los registros e índices
+// del catálogo estén dentro de sus secciones, para que una imagen con la
+// suma correcta pero mal armada no lleve a leer fuera de ella.
+bool catalogo_contenido_valido(const catalogo_t* catalogo, size_t tam_nombres) {
+	if (catalogo->_nombres[tam_nombres - 1] != '\0') return false;
+	for (size_t i = 0; i < catalogo->cantidad[CATALOGO_DOCTORES]; i++) {
+		const catalogo_doctor_t* doctor = &catalogo->doctores[i];
+		if (doctor->nombre >= tam_nombres || doctor->especialidad >= catalogo->cantidad[CATALOGO_ESPECIALIDADES]) return false;
+		if (catalogo->orden_doctores[i] >= catalogo->cantidad[CATALOGO_DOCTORES]) return false;
+	}
+	for (size_t i = 0; i < catalogo->cantidad[CATALOGO_ESPECIALIDADES]; i++) {
+		if (catalogo->especialidades[i].nombre >= tam_nombres) return false;
+	}
+	for (size_t i = 0; i < catalogo->cantidad[CATALOGO_PACIENTES]; i++) {
+		if (catalogo->pacientes[i].nombre >= tam_nombres) return false;
+	}
+	for (int t = 0; t < CATALOGO_TABLAS; t++) {
+		for (size_t i = 0; i < catalogo->_capacidad[t]; i++) {
+			if (catalogo->_indices[t][i] > catalogo->cantidad[t]) return false;
+		}
+	}
+	return true;
+}
+
+// Agranda, duplicándolo, un arreglo del armado si no tiene lugar para un
+// elemento más. Devuelve false si no hubo memoria.
+bool catalogo_armado_agrandar(void** arreglo, size_t* capacidad, size_t cantidad, size_t tam_elemento) {
+	if (cantidad < *capacidad) return true;
+	size_t nueva_capacidad = *capacidad ? *capacidad * 2 : CAPACIDAD_INICIAL;
+	void* nuevo = realloc(*arreglo, nueva_capacidad * tam_elemento);
+	if (!nuevo) return false;
+	*arreglo = nuevo;
+	*capacidad = nueva_capacidad;
+	return true;
+}
+
+// Copia un nombre al pool del armado y guarda su posición en 'pos'.
+// Post: Devuelve false si no hubo memoria o el pool excedería los 4 GB.
+bool catalogo_armado_nombre(catalogo_armado_t* armado, const char* nombre, uint32_t* pos) {
+	size_t largo = strlen(nombre) + 1;
+	if (largo > UINT32_MAX - armado->tam_nombres) return false;
+	if (armado->tam_nombres + largo > armado->cap_nombres) {
+		size_t capacidad = armado->cap_nombres ? armado->cap_nombres : CAPACIDAD_INICIAL;
+		while (capacidad < armado->tam_nombres + largo) capacidad *= 2;
+		char* nombres = realloc(armado->nombres, capacidad);
+		if (!nombres) return false;
+		armado->nombres = nombres;
+		armado->cap_nombres = capacidad;
+	}
+	memcpy(armado->nombres + armado->tam_nombres, nombre, largo);
+	*pos = (uint32_t) armado->tam_nombres;
+	armado->tam_nombres += largo;
+	return true;
+}
+
+// Reserva el lugar para un registro más en una tabla del armado, y lo
+// devuelve con su nombre ya copiado y el resto en cero.
+// Post: Devuelve NULL si no hubo memoria o la imagen excedería los 4 GB.
+void* catalogo_armado_registro(catalogo_armado_t* armado, catalogo_tabla_t tabla, const char* nombre) {
+	if (armado->cantidad[tabla] >= UINT32_MAX - 1) return NULL;
+	if (!catalogo_armado_agrandar(&armado->registros[tabla], &armado->capacidad[tabla], armado->cantidad[tabla], TAM_REGISTRO[tabla])) return NULL;
+	uint32_t pos;
+	if (!catalogo_armado_nombre(armado, nombre, &pos)) return NULL;
+	char* registro = (char*) armado->registros[tabla] + armado->cantidad[tabla] * TAM_REGISTRO[tabla];
+	memset(registro, 0, TAM_REGISTRO[tabla]);
+	memcpy(registro, &pos, sizeof(pos));
+	armado->cantidad[tabla]++;
+	return registro;
+}
+
+// Devuelve el número de la especialidad 'nombre', agregándola si todavía no
+// estaba. Devuelve false si no hubo memoria.
+bool catalogo_armado_especialidad(catalogo_armado_t* armado, const char* nombre, uint32_t* id) {
+	size_t cantidad = armado->cantidad[CATALOGO_ESPECIALIDADES];
+	// El índice se rehace con el doble de capacidad al llegar a la mitad
+	if (2 * (cantidad + 1) > armado->cap_indice_especialidades) {
+		size_t capacidad = catalogo_capacidad(cantidad + 1) * 2;
+		uint32_t* indice = calloc(capacidad, sizeof(uint32_t));
+		if (!indice) return false;
+		catalogo_indexar(indice, capacidad, armado->nombres, armado->registros[CATALOGO_ESPECIALIDADES], sizeof(catalogo_especialidad_t), cantidad);
+		free(armado->indice_especialidades);
+		armado->indice_especialidades = indice;
+		armado->cap_indice_especialidades = capacidad;
+	}
+	size_t i = catalogo_ranura(armado->indice_especialidades, armado->cap_indice_especialidades, armado->nombres, armado->registros[CATALOGO_ESPECIALIDADES], sizeof(catalogo_especialidad_t), nombre);
+	if (!armado->indice_especialidades[i]) {
+		if (!catalogo_armado_registro(armado, CATALOGO_ESPECIALIDADES, nombre)) return false;
+		armado->indice_especialidades[i] = (uint32_t) armado->cantidad[CATALOGO_ESPECIALIDADES];
+	}
+	*id = armado->indice_especialidades[i] - 1;
+	return true;
+}
+
+// Función que compara dos doctores por su nombre, para ordenarlos con qsort.
+int catalogo_comparar_orden(const void* a, const void* b) {
+	return strcmp(((const catalogo_orden_t*) a)->nombre, ((const catalogo_orden_t*) b)->nombre);
+}
+
+// Guarda en 'orden' los números de los doctores del armado en orden
+// alfabético. Devuelve false si no hubo memoria.
+bool catalogo_armado_ordenar(const catalogo_armado_t* armado, uint32_t* orden) {
+	size_t cantidad = armado->cantidad[CATALOGO_DOCTORES];
+	const catalogo_doctor_t* doctores = armado->registros[CATALOGO_DOCTORES];
+	catalogo_orden_t* aux = malloc(cantidad * sizeof(catalogo_orden_t) + 1);
+	if (!aux) return false;
+	for (size_t i = 0; i < cantidad; i++) {
+		aux[i].nombre = armado->nombres + doctores[i].nombre;
+		aux[i].id = (uint32_t) i;
+	}
+	qsort(aux, cantidad, sizeof(catalogo_orden_t), catalogo_comparar_orden);
+	for (size_t i = 0; i < cantidad; i++) orden[i] = aux[i].id;
+	free(aux);
+	return true;
+}
+
+// Escribe los 'tam' bytes de la imagen en el archivo 'ruta'.
+bool catalogo_escribir(const char* ruta, const char* datos, size_t tam) {
+	FILE* archivo = fopen(ruta, "wb");
+	if (!archivo) return false;
+	bool ok = fwrite(datos, 1, tam, archivo) == tam;
+	if (fclose(archivo) != 0) ok = false;
+	if (!ok) remove(ruta);
+	return ok;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LECTURA
+ * *****************************************************************/
+
+bool catalogo_abrir(catalogo_t* catalogo, const char* ruta) {
+	int fd = open(ruta, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat info;
+	if (fstat(fd, &info) < 0 || info.st_size < (off_t) sizeof(catalogo_cabecera_t)) {
+		close(fd);
+		return false;
+	}
+	size_t tam = (size_t) info.st_size;
+	void* mapa = mmap(NULL, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapa == MAP_FAILED) return false;
+
+	const char* datos = mapa;
+	const catalogo_cabecera_t* cabecera = mapa;
+	if (!catalogo_cabecera_valida(cabecera, datos, tam)) {
+		munmap(mapa, tam);
+		return false;
+	}
+	catalogo->doctores = (const void*) (datos + cabecera->registros[CATALOGO_DOCTORES]);
+	catalogo->especialidades = (const void*) (datos + cabecera->registros[CATALOGO_ESPECIALIDADES]);
+	catalogo->pacientes = (const void*) (datos + cabecera->registros[CATALOGO_PACIENTES]);
+	catalogo->orden_doctores = (const void*) (datos + cabecera->orden_doctores);
+	catalogo->_nombres = datos + cabecera->nombres;
+	for (int t = 0; t < CATALOGO_TABLAS; t++) {
+		catalogo->cantidad[t] = (size_t) cabecera->cantidad[t];
+		catalogo->_indices[t] = (const void*) (datos + cabecera->indices[t]);
+		catalogo->_capacidad[t] = (size_t) cabecera->capacidad[t];
+	}
+	catalogo->_mapa = mapa;
+	catalogo->_tam = tam;
+	if (!catalogo_contenido_valido(catalogo, (size_t) cabecera->tam_nombres)) {
+		munmap(mapa, tam);
+		return false;
+	}
+	return true;
+}
+
+bool catalogo_buscar(const catalogo_t* catalogo, catalogo_tabla_t tabla, const char* nombre, size_t* id) {
+	const uint32_t* indice = catalogo->_indices[tabla];
+	size_t i = catalogo_ranura(indice, catalogo->_capacidad[tabla], catalogo->_nombres, catalogo_registros(catalogo, tabla), TAM_REGISTRO[tabla], nombre);
+	if (!indice[i]) return false;
+	*id = indice[i] - 1;
+	return true;
+}
+
+void catalogo_cerrar(catalogo_t* catalogo) {
+	munmap(catalogo->_mapa, catalogo->_tam);
+	catalogo->_mapa = NULL;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE ARMADO
+ * *****************************************************************/
+
+catalogo_armado_t* catalogo_armado_crear(void) {
+	return calloc(1, sizeof(catalogo_armado_t));
+}
+
+bool catalogo_agregar_doctor(catalogo_armado_t* armado, const char* nombre, const char* especialidad) {
+	uint32_t id_especialidad;
+	if (!catalogo_armado_especialidad(armado, especialidad, &id_especialidad)) return false;
+	catalogo_doctor_t* doctor = catalogo_armado_registro(armado, CATALOGO_DOCTORES, nombre);
+	if (!doctor) return false;
+	doctor->especialidad = id_especialidad;
+	return true;
+}
+
+bool catalogo_agregar_paciente(catalogo_armado_t* armado, const char* nombre, uint64_t total_contribuciones) {
+	catalogo_paciente_t* paciente = catalogo_armado_registro(armado, CATALOGO_PACIENTES, nombre);
+	if (!paciente) return false;
+	paciente->total_contribuciones = total_contribuciones;
+	return true;
+}
+
+bool catalogo_armado_guardar(const catalogo_armado_t* armado, const char* ruta) {
+	// Calculo dónde va cada sección
+	catalogo_cabecera_t cabecera;
+	memset(&cabecera, 0, sizeof(cabecera));
+	memcpy(cabecera.magia, CATALOGO_MAGIA, sizeof(cabecera.magia));
+	cabecera.version = CATALOGO_VERSION;
+	cabecera.orden_bytes = CATALOGO_ORDEN_BYTES;
+	size_t pos = catalogo_alinear(sizeof(catalogo_cabecera_t));
+	// El pool nunca está vacío, para que toda imagen termine en '\0'
+	size_t tam_nombres = armado->tam_nombres ? armado->tam_nombres : 1;
+	cabecera.nombres = pos;
+	cabecera.tam_nombres = tam_nombres;
+	pos = catalogo_alinear(pos + tam_nombres);
+	for (int t = 0; t < CATALOGO_TABLAS; t++) {
+		cabecera.cantidad[t] = armado->cantidad[t];
+		cabecera.registros[t] = pos;
+		pos = catalogo_alinear(pos + armado->cantidad[t] * TAM_REGISTRO[t]);
+	}
+	for (int t = 0; t < CATALOGO_TABLAS; t++) {
+		cabecera.capacidad[t] = catalogo_capacidad(armado->cantidad[t]);
+		cabecera.indices[t] = pos;
+		pos = catalogo_alinear(pos + cabecera.capacidad[t] * sizeof(uint32_t));
+	}
+	cabecera.orden_doctores = pos;
+	pos = catalogo_alinear(pos + armado->cantidad[CATALOGO_DOCTORES] * sizeof(uint32_t));
+	cabecera.tam = pos;
+
+	// Armo la imagen completa en memoria
+	char* datos = calloc(1, pos);
+	if (!datos) return false;
+	if (armado->tam_nombres) memcpy(datos + cabecera.nombres, armado->nombres, armado->tam_nombres);
+	for (int t = 0; t < CATALOGO_TABLAS; t++) {
+		if (armado->cantidad[t]) memcpy(datos + cabecera.registros[t], armado->registros[t], armado->cantidad[t] * TAM_REGISTRO[t]);
+		uint32_t* indice = (void*) (datos + cabecera.indices[t]);
+		catalogo_indexar(indice, (size_t) cabecera.capacidad[t], armado->nombres, armado->registros[t], TAM_REGISTRO[t], armado->cantidad[t]);
+	}
+	if (!catalogo_armado_ordenar(armado, (void*) (datos + cabecera.orden_doctores))) {
+		free(datos);
+		return false;
+	}
+	cabecera.suma = catalogo_suma(datos + sizeof(catalogo_cabecera_t), pos - sizeof(catalogo_cabecera_t));
+	memcpy(datos, &cabecera, sizeof(cabecera));
+
+	// Escribo en un archivo temporal y lo renombro
+	char* temporal = malloc(strlen(ruta) + sizeof(".tmp"));
+	if (!temporal) {
+		free(datos);
+		return false;
+	}
+	strcpy(temporal, ruta);
+	strcat(temporal, ".tmp");
+	bool ok = catalogo_escribir(temporal, datos, pos);
+	if (ok && rename(temporal, ruta) != 0) {
+		remove(temporal);
+		ok = false;
+	}
+	free(temporal);
+	free(datos);
+	return ok;
+}
+
+void catalogo_armado_destruir(catalogo_armado_t* armado) {
+	if (!armado) return;
+	free(armado->nombres);
+	for (int t = 0; t < CATALOGO_TABLAS; t++) free(armado->registros[t]);
+	free(armado->indice_especialidades);
+	free(armado);
+}
@@ -0,0 +1,143 @@
+#ifndef CATALOGO_H
+#define CATALOGO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Imagen binaria, ya compilada, del catálogo de doctores, especialidades y
+ * pacientes, para arrancar sin leer los CSV. El archivo se proyecta en
+ * memoria con mmap() y se usa tal cual: no contiene punteros sino
+ * posiciones (offsets) relativas a la propia imagen, y trae armados los
+ * índices que el programa necesita.
+ *
+ * Contenido
+ * =========
+ *
+ *   - Una cabecera con un número mágico, la versión del formato, el tamaño
+ *     total y una suma de verificación de todo lo que le sigue.
+ *   - El pool de nombres: todas las cadenas, terminadas en '\0'.
+ *   - Una tabla de registros de tamaño fijo por cada tipo (doctores,
+ *     especialidades y pacientes). Cada registro empieza con la posición de
+ *     su nombre dentro del pool; el de un doctor indica además el número
+ *     de su especialidad, y el de un paciente su total de contribuciones.
+ *   - Un índice hash por tabla (direccionamiento abierto, sondeo lineal)
+ *     que lleva de un nombre al número de su registro.
+ *   - Los números de los doctores en orden alfabético, para el informe.
+ *
+ * La imagen usa el orden de bytes de la máquina que la generó; una imagen
+ * de otra arquitectura, de otra versión o dañada se rechaza al abrirla.
+ *
+ * Uso
+ * ===
+ *
+ *     catalogo_armado_t* armado = catalogo_armado_crear();
+ *     catalogo_agregar_doctor(armado, "Dr. House", "Diagnóstico");
+ *     catalogo_agregar_paciente(armado, "Juan", 1500);
+ *     catalogo_armado_guardar(armado, "catalogo.bin");
+ *     catalogo_armado_destruir(armado);
+ *
+ *     catalogo_t catalogo;
+ *     if (!catalogo_abrir(&catalogo, "catalogo.bin")) ...
+ *     size_t id;
+ *     if (catalogo_buscar(&catalogo, CATALOGO_DOCTORES, "Dr. House", &id))
+ *       printf("%s\n", catalogo_nombre(&catalogo, catalogo.doctores[id].nombre));
+ *     catalogo_cerrar(&catalogo);
+ */
+
+typedef enum catalogo_tabla {
+	CATALOGO_DOCTORES,
+	CATALOGO_ESPECIALIDADES,
+	CATALOGO_PACIENTES,
+	CATALOGO_TABLAS
+} catalogo_tabla_t;
+
+// Registros de la imagen. Los nombres son posiciones dentro del pool.
+
+typedef struct catalogo_doctor {
+	uint32_t nombre;
+	uint32_t especialidad;   // Número de registro de su especialidad
+} catalogo_doctor_t;
+
+typedef struct catalogo_especialidad {
+	uint32_t nombre;
+	uint32_t relleno;
+} catalogo_especialidad_t;
+
+typedef struct catalogo_paciente {
+	uint32_t nombre;
+	uint32_t relleno;
+	uint64_t total_contribuciones;
+} catalogo_paciente_t;
+
+typedef struct catalogo {
+	const catalogo_doctor_t* doctores;
+	const catalogo_especialidad_t* especialidades;
+	const catalogo_paciente_t* pacientes;
+	const uint32_t* orden_doctores;    // Números de los doctores en orden alfabético
+	size_t cantidad[CATALOGO_TABLAS];  // Cantidad de registros de cada tabla
+	const char* _nombres;
+	const uint32_t* _indices[CATALOGO_TABLAS];
+	size_t _capacidad[CATALOGO_TABLAS];
+	void* _mapa;
+	size_t _tam;
+} catalogo_t;
+
+// Proceso de armado de una imagen, antes de guardarla.
+typedef struct catalogo_armado catalogo_armado_t;
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LECTURA
+ * *****************************************************************/
+
+// Proyecta en memoria la imagen guardada en 'ruta' y verifica su cabecera,
+// su suma de verificación y que todas sus posiciones estén dentro de ella.
+// Post: Devuelve false si el archivo no existe o no es una imagen válida
+// de esta versión; en ese caso no hay que cerrar el catálogo.
+bool catalogo_abrir(catalogo_t* catalogo, const char* ruta);
+
+// Devuelve el nombre que está en la posición 'nombre' del pool.
+// Pre: El catálogo está abierto y 'nombre' salió de uno de sus registros.
+static inline const char* catalogo_nombre(const catalogo_t* catalogo, uint32_t nombre) {
+	return catalogo->_nombres + nombre;
+}
+
+// Busca un nombre en el índice de una tabla.
+// Pre: El catálogo está abierto.
+// Post: Devuelve true y guarda en 'id' el número de su registro si el
+// nombre está en la tabla, false si no.
+bool catalogo_buscar(const catalogo_t* catalogo, catalogo_tabla_t tabla, const char* nombre, size_t* id);
+
+// Deja de proyectar la imagen. Los registros y nombres dejan de ser válidos.
+// Pre: El catálogo está abierto.
+void catalogo_cerrar(catalogo_t* catalogo);
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE ARMADO
+ * *****************************************************************/
+
+// Crea un armado de imagen vacío.
+// Post: Devuelve el armado, NULL si no hubo memoria.
+catalogo_armado_t* catalogo_armado_crear(void);
+
+// Agrega un doctor, y su especialidad si es la primera vez que aparece.
+// Los nombres se copian.
+// Pre: No se agregó antes otro doctor con el mismo nombre.
+// Post: Devuelve false si no hubo memoria o la imagen excedería los 4 GB.
+bool catalogo_agregar_doctor(catalogo_armado_t* armado, const char* nombre, const char* especialidad);
+
+// Agrega un paciente. El nombre se copia.
+// Pre: No se agregó antes otro paciente con el mismo nombre.
+// Post: Devuelve false si no hubo memoria o la imagen excedería los 4 GB.
+bool catalogo_agregar_paciente(catalogo_armado_t* armado, const char* nombre, uint64_t total_contribuciones);
+
+// Arma los índices y guarda la imagen en 'ruta'. Se escribe primero en un
+// archivo temporal que luego se renombra, de modo que una imagen anterior
+// en la misma ruta sólo se reemplaza si la nueva se escribió completa.
+// Post: Devuelve false si no hubo memoria o no se pudo escribir.
+bool catalogo_armado_guardar(const catalogo_armado_t* armado, const char* ruta);
+
+// Destruye el armado.
+void catalogo_armado_destruir(catalogo_armado_t* armado);
+
+#endif // CATALOGO_H
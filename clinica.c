@@ -4,39 +4,137 @@
  *       ESTRUCTURAS DE DATOS      *
  ***********************************/
 
-struct doctor {
-	char* nombre;
-	char* especialidad;
-	int cant_atendidos;
-};
+/* Los doctores, pacientes y especialidades no son structs sueltos, sino filas
+ * de tablas guardadas por columnas: un arreglo por campo, indexado por el
+ * número de fila (id) de cada uno, de modo que los campos que usan los
+ * comandos (totales de contribuciones, pacientes atendidos) quedan juntos
+ * en memoria. Los hashes sólo llevan de un nombre a su id, y las listas de
+ * espera guardan ids de pacientes.
+ *
+ * Los nombres de doctores y pacientes no son copias: apuntan al contenido
+ * de los archivos CSV, que sigue cargado en memoria mientras se ejecuta el
+ * programa, o a la imagen compilada. Los que se agregan al recargar un
+ * archivo se guardan en la tabla de cadenas 'nombres'. Los nombres de las
+ * especialidades están internados en 'nombres_especialidades', y el id de
+ * cada especialidad es el número de su nombre en esa tabla. Los hashes usan
+ * estos mismos nombres como claves, sin copiarlos.
+ *
+ * Las filas no se borran ni se reutilizan: un doctor o paciente borrado al
+ * recargar sólo sale de su hash (ver RECARGA).
+ *
+ * Con un índice de pacientes (ver indice_csv.h), el archivo de pacientes no
+ * se carga: cada paciente se lee del archivo la primera vez que pide un
+ * turno, y a partir de ahí queda en su tabla y su hash como los demás.
+ */
 
-struct paciente {
-	char* nombre;
-	unsigned long long total_contribuciones;
-};
+#define SIN_ID UINT32_MAX
+#define FILAS_INICIAL 1024
+
+// Cada doctor está además en la lista de los doctores de su especialidad,
+// enlazada por sus ids.
+typedef struct doctores {
+	const char** nombre;
+	uint32_t* especialidad;       // SIN_ID mientras no tiene
+	int* cant_atendidos;
+	uint32_t* anterior;           // Doctores de la misma especialidad, SIN_ID en los extremos
+	uint32_t* siguiente;
+	size_t cantidad;
+	size_t capacidad;
+} doctores_t;
+
+typedef struct pacientes {
+	const char** nombre;
+	uint64_t* total_contribuciones;
+	uint32_t* en_espera;          // Veces que está encolado en alguna lista de espera
+	size_t cantidad;
+	size_t capacidad;
+} pacientes_t;
+
+typedef struct especialidades {
+	const char** nombre;
+	heap_ids_t** lista_de_espera; // NULL hasta que se pide el primer turno
+	uint32_t* primer_doctor;      // SIN_ID si no tiene doctores
+	uint32_t* cant_doctores;
+	uint32_t* max_en_espera;      // Mayor cantidad de pacientes que tuvo en espera
+	size_t cantidad;
+	size_t capacidad;
+} especialidades_t;
+
+// Recarga en segundo plano de uno de los archivos CSV (ver RECARGA)
+typedef struct recarga recarga_t;
 
-struct especialidad {
-	char* nombre;
-	heap_t* lista_de_espera;
+typedef enum tipo_recarga {
+	RECARGA_DOCTORES,
+	RECARGA_PACIENTES,
+	TIPOS_RECARGA
+} tipo_recarga_t;
+
+#define NOMBRE_PEDIR_TURNO "PEDIR_TURNO"
+#define NOMBRE_ATENDER_SIGUIENTE "ATENDER_SIGUIENTE"
+#define NOMBRE_INFORME "INFORME"
+#define NOMBRE_RECARGAR "RECARGAR"
+
+// Comandos que se pueden ejecutar (ver DESPACHO DE COMANDOS)
+typedef enum id_comando {
+	CMD_PEDIR_TURNO,
+	CMD_ATENDER_SIGUIENTE,
+	CMD_INFORME,
+	CMD_RECARGAR,
+	CANT_COMANDOS
+} id_comando_t;
+
+// Errores que se cuentan en las métricas
+typedef enum tipo_error {
+	ERROR_DOCTOR,           // ENOENT_DOCTOR
+	ERROR_PACIENTE,         // ENOENT_PACIENTE
+	ERROR_ESPECIALIDAD,     // ENOENT_ESPECIALIDAD
+	ERROR_COMANDO,          // ENOENT_CMD
+	ERROR_LINEA,            // EINVAL_CMD
+	CANT_ERRORES
+} tipo_error_t;
+
+// Métricas de los comandos ejecutados (ver MÉTRICAS)
+typedef struct metricas {
+	histograma_t latencias[CANT_COMANDOS];  // En ns, de cada comando que se ejecutó
+	size_t errores[CANT_ERRORES];
+} metricas_t;
+
+/* Catálogo con el que trabaja el programa. Si se cargó de los archivos CSV,
+ * los nombres se buscan en los hashes y en la tabla de especialidades. Si se
+ * cargó de una imagen compilada (ver catalogo.h), las filas tienen el mismo
+ * orden que los registros de la imagen, y se buscan con sus índices; los
+ * nombres apuntan entonces a la imagen proyectada.
+ */
+struct clinica {
+	doctores_t doctores;
+	pacientes_t pacientes;
+	especialidades_t especialidades;
+	hash_t* hash_doctores;                  // Nombre -> id, NULL si se cargó de una imagen
+	hash_t* hash_pacientes;
+	cadenas_t* nombres_especialidades;      // Nombre -> id de especialidad
+	cadenas_t* nombres;                     // Nombres agregados al recargar
+	catalogo_t* imagen;                     // NULL si se cargó de los CSV
+	indice_csv_t* indice_pacientes;         // Pacientes que se leen al pedirlos, NULL si se cargaron todos
+	const char* archivos[TIPOS_RECARGA];    // CSV de los que se cargó, para recargarlos
+	recarga_t* recargas[TIPOS_RECARGA];     // Recargas en curso, NULL si no hay
+	salida_t salida;                        // Salida por pantalla de los comandos
+	bitacora_t* bitacora;                   // Registro de los cambios, NULL si no se registran (ver BITÁCORA)
+#ifndef SIN_METRICAS
+	metricas_t metricas;
+#endif
 };
 
+// Comando leído, con sus parámetros ya interpretados según su definición
+// (ver DESPACHO DE COMANDOS)
 struct parametros {
 	char* comando;
 	char* param1;
 	char* param2;
+	tipo_recarga_t archivo;   // Valor del parámetro DOCTORES|PACIENTES, si el comando tiene uno
+	bool metricas;            // El parámetro de INFORME es METRICAS, y no DOCTORES
+	bool invalido;            // La línea no tenía comando, y no estaba vacía
 };
 
-// Funcion que compara el total de contribuciones entre dos pacientes.
-int comp(const void* clave_a, const void* clave_b) {	
-	unsigned long long a = ((paciente_t*) clave_a)->total_contribuciones;
-	unsigned long long b = ((paciente_t*) clave_b)->total_contribuciones;
-	if (a == b) return 0;
-	else if (a < b) return (-1);
-	return 1;
-}
-
-cmp_func_t cmp = &comp;
-
 // Función que compara dos strings para determinar su orden alfabético.
 int comparar_string(const void* clave_a, const void* clave_b) {
 	return strcmp((char*) clave_b, (char*) clave_a);
@@ -48,124 +146,191 @@ cmp_func_t cmp_string = &comparar_string;
  *        FUNCIONES AUXILIARES     *
  ***********************************/
 
-/* Funcion de destruccion para la estructura 'parametros'.
- * Libera la memoria pedida para el parametro, y en caso
- * de ser valido, sus miembros.
- */
-void parametros_destruir(parametros_t* parametros){
-	if (parametros){
-		free(parametros->comando);
-		free(parametros->param1);
-	}
-	free(parametros);
+// Los hashes guardan el id más uno, para no confundir el id 0 con NULL.
+bool indice_guardar(hash_t* hash, const char* nombre, uint32_t id) {
+	return hash_guardar(hash, nombre, (void*) ((uintptr_t) id + 1));
 }
 
-/* Funcion de destruccion para la estructura 'doctor'.
- * Libera la memoria pedida para el mismo, y en caso
- * de ser valido, sus miembros. Toma un puntero generico
- * para ser usada como funcion de destruccion en el 'hash_doctores'.
- */
-void doctor_destruir(void* dato){
-	doctor_t* doctor = (doctor_t*) dato;
-	if (doctor){
-		free(doctor->nombre);
-		free(doctor->especialidad);
+// Devuelve el id guardado para un nombre, SIN_ID si no está.
+uint32_t indice_obtener(const hash_t* hash, const char* nombre) {
+	uintptr_t dato = (uintptr_t) hash_obtener(hash, nombre);
+	return dato ? (uint32_t) (dato - 1) : SIN_ID;
+}
+
+// Agranda una columna a 'capacidad' elementos de 'tam' bytes. Si no hay
+// memoria devuelve la columna sin cambios, y pone 'ok' en false.
+void* agrandar_columna(void* columna, size_t capacidad, size_t tam, bool* ok) {
+	void* nueva = realloc(columna, capacidad * tam);
+	if (!nueva) {
+		*ok = false;
+		return columna;
 	}
-	free(doctor);
+	return nueva;
 }
 
-/* Funcion de destruccion para la estructura 'paciente'.
- * Libera la memoria pedida para el mismo, y en caso
- * de ser valido, sus miembros. Toma un puntero generico
- * para ser usada como funcion de destruccion en el 'hash_pacientes'.
- */
-void paciente_destruir(void* dato){
-	paciente_t* paciente = (paciente_t*) dato;
-	if (paciente)
-		free(paciente->nombre);
-	free(paciente);
+// Devuelve la capacidad a la que hay que agrandar una tabla para agregarle
+// 'cantidad' filas, 0 si no hace falta o si excedería los ids posibles.
+size_t capacidad_para(size_t capacidad, size_t cantidad) {
+	if (cantidad >= SIN_ID || cantidad <= capacidad) return 0;
+	size_t nueva = capacidad ? capacidad : FILAS_INICIAL;
+	while (nueva < cantidad) nueva *= 2;
+	return nueva;
 }
 
-/* Funcion de destruccion para la estructura 'especialidad'.
- * Libera la memoria pedida para el mismo, y en caso
- * de ser valido, sus miembros. Toma un puntero generico
- * para ser usada como funcion de destruccion en el 'hash_especialidades'.
- */
-void especialidad_destruir(void* dato){
-	especialidad_t* especialidad = (especialidad_t*) dato;
-	if (especialidad){
-		free(especialidad->nombre);
-		heap_destruir(especialidad->lista_de_espera, NULL);
-	}
-	free(especialidad);
-}
-
-// Función auxiliar para crear un doctor según un nombre y una especialidad, pasados como parámetro.
-// Pre: Ninguna.
-// Post: Se devuelve el doctor creado, NULL si no se pudo crear.
-doctor_t* doctor_crear(char* nombre, char* especialidad) {
-	doctor_t* doctor = malloc(sizeof(doctor_t));
-	if (!doctor) return NULL;
-	doctor->nombre = strcpy(malloc(strlen(nombre) + 1), nombre);
-	doctor->especialidad = strcpy(malloc(strlen(especialidad) + 1), especialidad);
-	doctor->cant_atendidos = 0;
-	return doctor;
-}
-
-// Función auxiliar para crear un paciente según un nombre y total contribuído, pasados como parámetro.
-// Pre: Ninguna.
-// Post: Se devuelve el paciente creado, NULL si no se pudo crear o si el total contribuído no es un número.
-paciente_t* paciente_crear(char* nombre, char* total_contribuciones) {
-	paciente_t* paciente = malloc(sizeof(paciente_t));
-	if (!paciente) return NULL;
-	paciente->nombre = strcpy(malloc(strlen(nombre) + 1), nombre);
-	char* ptrEnd;
-	paciente->total_contribuciones = strtoull(total_contribuciones, &ptrEnd, 10);
-	if (paciente->total_contribuciones == 0) return NULL;
-	return paciente;
+// Se asegura de que la tabla de doctores tenga lugar para 'cantidad' filas.
+// Post: Devuelve false si no hubo memoria.
+bool doctores_reservar(doctores_t* doctores, size_t cantidad) {
+	if (cantidad >= SIN_ID) return false;
+	size_t capacidad = capacidad_para(doctores->capacidad, cantidad);
+	if (!capacidad) return true;
+	bool ok = true;
+	doctores->nombre = agrandar_columna(doctores->nombre, capacidad, sizeof(*doctores->nombre), &ok);
+	doctores->especialidad = agrandar_columna(doctores->especialidad, capacidad, sizeof(*doctores->especialidad), &ok);
+	doctores->cant_atendidos = agrandar_columna(doctores->cant_atendidos, capacidad, sizeof(*doctores->cant_atendidos), &ok);
+	doctores->anterior = agrandar_columna(doctores->anterior, capacidad, sizeof(*doctores->anterior), &ok);
+	doctores->siguiente = agrandar_columna(doctores->siguiente, capacidad, sizeof(*doctores->siguiente), &ok);
+	if (ok) doctores->capacidad = capacidad;
+	return ok;
 }
 
-// Función auxiliar para crear un doctor según un nombre y una especialidad, pasados como parámetro.
-// Pre: Ninguna.
-// Post: Se devuelve la especialidad creada, NULL si no se pudo crear.
-especialidad_t* especialidad_crear(char* nombre) {
-	especialidad_t* especialidad = malloc(sizeof(especialidad_t));
-	if (!especialidad) return NULL;
-	especialidad->nombre = strcpy(malloc(strlen(nombre) + 1), nombre);
-	especialidad->nombre[strlen(especialidad->nombre)] = '\0'; // Dado a que no hay fin de linea en los archivos csv
-	heap_t* lista_de_espera = heap_crear(cmp);
-	especialidad->lista_de_espera = lista_de_espera;
-	return especialidad;
+// Se asegura de que la tabla de pacientes tenga lugar para 'cantidad' filas.
+// Post: Devuelve false si no hubo memoria.
+bool pacientes_reservar(pacientes_t* pacientes, size_t cantidad) {
+	if (cantidad >= SIN_ID) return false;
+	size_t capacidad = capacidad_para(pacientes->capacidad, cantidad);
+	if (!capacidad) return true;
+	bool ok = true;
+	pacientes->nombre = agrandar_columna(pacientes->nombre, capacidad, sizeof(*pacientes->nombre), &ok);
+	pacientes->total_contribuciones = agrandar_columna(pacientes->total_contribuciones, capacidad, sizeof(*pacientes->total_contribuciones), &ok);
+	pacientes->en_espera = agrandar_columna(pacientes->en_espera, capacidad, sizeof(*pacientes->en_espera), &ok);
+	if (ok) pacientes->capacidad = capacidad;
+	return ok;
 }
 
+// Se asegura de que la tabla de especialidades tenga lugar para 'cantidad' filas.
+// Post: Devuelve false si no hubo memoria.
+bool especialidades_reservar(especialidades_t* especialidades, size_t cantidad) {
+	if (cantidad >= SIN_ID) return false;
+	size_t capacidad = capacidad_para(especialidades->capacidad, cantidad);
+	if (!capacidad) return true;
+	bool ok = true;
+	especialidades->nombre = agrandar_columna(especialidades->nombre, capacidad, sizeof(*especialidades->nombre), &ok);
+	especialidades->lista_de_espera = agrandar_columna(especialidades->lista_de_espera, capacidad, sizeof(*especialidades->lista_de_espera), &ok);
+	especialidades->primer_doctor = agrandar_columna(especialidades->primer_doctor, capacidad, sizeof(*especialidades->primer_doctor), &ok);
+	especialidades->cant_doctores = agrandar_columna(especialidades->cant_doctores, capacidad, sizeof(*especialidades->cant_doctores), &ok);
+	especialidades->max_en_espera = agrandar_columna(especialidades->max_en_espera, capacidad, sizeof(*especialidades->max_en_espera), &ok);
+	if (ok) especialidades->capacidad = capacidad;
+	return ok;
+}
 
-// Función auxiliar para parsear un texto ingresado por teclado.
-// Pre: Ninguna.
-// Post: Se devuelve el comando, y el/los parámetro(s) en una estructura, NULL si no se pudo crear la misma, o si no se ingresó un comando.
-parametros_t* obtener_parametros() {
-	parametros_t* parametros = malloc(sizeof(parametros_t));
-	if (!parametros) return NULL;
+// Agrega un doctor, todavía sin especialidad.
+// Pre: El nombre sigue siendo válido mientras exista el catálogo (no se copia).
+// Post: Devuelve el id del doctor, SIN_ID si no hubo memoria.
+uint32_t doctores_agregar(doctores_t* doctores, const char* nombre) {
+	if (!doctores_reservar(doctores, doctores->cantidad + 1)) return SIN_ID;
+	uint32_t id = (uint32_t) doctores->cantidad++;
+	doctores->nombre[id] = nombre;
+	doctores->especialidad[id] = SIN_ID;
+	doctores->cant_atendidos[id] = 0;
+	doctores->anterior[id] = SIN_ID;
+	doctores->siguiente[id] = SIN_ID;
+	return id;
+}
+
+// Agrega un paciente.
+// Pre: El nombre sigue siendo válido mientras exista el catálogo (no se copia).
+// Post: Devuelve el id del paciente, SIN_ID si no hubo memoria.
+uint32_t pacientes_agregar(pacientes_t* pacientes, const char* nombre, uint64_t total_contribuciones) {
+	if (!pacientes_reservar(pacientes, pacientes->cantidad + 1)) return SIN_ID;
+	uint32_t id = (uint32_t) pacientes->cantidad++;
+	pacientes->nombre[id] = nombre;
+	pacientes->total_contribuciones[id] = total_contribuciones;
+	pacientes->en_espera[id] = 0;
+	return id;
+}
+
+// Agrega una especialidad, sin doctores ni pacientes en espera.
+// Pre: El nombre sigue siendo válido mientras exista el catálogo (no se copia).
+// Post: Devuelve el id de la especialidad, SIN_ID si no hubo memoria.
+uint32_t especialidades_agregar(especialidades_t* especialidades, const char* nombre) {
+	if (!especialidades_reservar(especialidades, especialidades->cantidad + 1)) return SIN_ID;
+	uint32_t id = (uint32_t) especialidades->cantidad++;
+	especialidades->nombre[id] = nombre;
+	especialidades->lista_de_espera[id] = NULL;
+	especialidades->primer_doctor[id] = SIN_ID;
+	especialidades->cant_doctores[id] = 0;
+	especialidades->max_en_espera[id] = 0;
+	return id;
+}
+
+// Asigna una especialidad a un doctor que no tiene, agregándolo a la lista
+// de doctores de la especialidad.
+void especialidad_agregar_doctor(clinica_t* clinica, uint32_t especialidad, uint32_t doctor) {
+	doctores_t* doctores = &clinica->doctores;
+	uint32_t primero = clinica->especialidades.primer_doctor[especialidad];
+	doctores->especialidad[doctor] = especialidad;
+	doctores->anterior[doctor] = SIN_ID;
+	doctores->siguiente[doctor] = primero;
+	if (primero != SIN_ID) doctores->anterior[primero] = doctor;
+	clinica->especialidades.primer_doctor[especialidad] = doctor;
+	clinica->especialidades.cant_doctores[especialidad]++;
+}
+
+// Saca a un doctor de la lista de doctores de su especialidad, y lo deja
+// sin especialidad.
+void especialidad_quitar_doctor(clinica_t* clinica, uint32_t doctor) {
+	doctores_t* doctores = &clinica->doctores;
+	uint32_t especialidad = doctores->especialidad[doctor];
+	if (especialidad == SIN_ID) return;
+	uint32_t anterior = doctores->anterior[doctor];
+	uint32_t siguiente = doctores->siguiente[doctor];
+	if (anterior != SIN_ID) doctores->siguiente[anterior] = siguiente;
+	else clinica->especialidades.primer_doctor[especialidad] = siguiente;
+	if (siguiente != SIN_ID) doctores->anterior[siguiente] = anterior;
+	clinica->especialidades.cant_doctores[especialidad]--;
+	doctores->especialidad[doctor] = SIN_ID;
+	doctores->anterior[doctor] = SIN_ID;
+	doctores->siguiente[doctor] = SIN_ID;
+}
+
+// Devuelve el id de la especialidad de nombre 'nombre', creándola (e
+// internando su nombre) si no existe. Devuelve SIN_ID si no hubo memoria.
+uint32_t obtener_o_crear_especialidad(clinica_t* clinica, const char* nombre) {
+	size_t id;
+	const char* interno = cadenas_internar(clinica->nombres_especialidades, nombre, &id);
+	if (!interno) return SIN_ID;
+	if (id < clinica->especialidades.cantidad) return (uint32_t) id;
+	// Los ids de las especialidades siguen a los de sus nombres
+	if (id != clinica->especialidades.cantidad) return SIN_ID;
+	return especialidades_agregar(&clinica->especialidades, interno);
+}
+
+// Guarda en 'parametros' el comando y el/los parámetro(s) de una línea ya
+// dividida en 'primero' y 'segundo' (ver csv_dividir), sin copiarlos.
+void guardar_parametros(char* primero, char* segundo, parametros_t* parametros) {
 	parametros->comando = NULL;
 	parametros->param1 = NULL;
 	parametros->param2 = NULL;
-	
-	csv_t cmd = {.delim = ':'};
-	csv_siguiente(&cmd, stdin);
-	if (cmd.primero) {
-		if (strcmp(cmd.segundo, "") == 0) {
-			if (strcmp(cmd.primero, "") != 0) printf(EINVAL_CMD);
-		}
-		else {
-			parametros->comando = strcpy(malloc(strlen(cmd.primero) + 1), cmd.primero);
-			parametros->param1 = strcpy(malloc(strlen(cmd.segundo) + 1), cmd.segundo);
-			split(',', parametros->param1, &parametros->param2);
-		}
-		csv_terminar(&cmd);
-		return parametros;
+	parametros->invalido = false;
+	if (strcmp(segundo, "") == 0) {
+		parametros->invalido = strcmp(primero, "") != 0;
+	}
+	else {
+		parametros->comando = primero;
+		parametros->param1 = segundo;
+		split(',', parametros->param1, &parametros->param2);
 	}
-	csv_terminar(&cmd);
-	parametros_destruir(parametros);
-	return NULL;
+}
+
+// Función auxiliar para parsear un texto ingresado por teclado.
+// Pre: La entrada se creó con .delim = ':'.
+// Post: Se guardan el comando y el/los parámetro(s) en 'parametros', sin copiarlos: apuntan
+// al buffer de la entrada, y son válidos hasta leer el siguiente comando. El comando es NULL
+// si la línea no tenía uno. Devuelve false si no hay más líneas.
+bool obtener_parametros(csv_flujo_t* entrada, parametros_t* parametros) {
+	if (!csv_flujo_siguiente(entrada)) return false;
+	guardar_parametros(entrada->primero, entrada->segundo, parametros);
+	return true;
 }
 
 /* Crea un heap de los doctores dentro del hash pasado
@@ -180,9 +345,7 @@ heap_t* crear_heap_doctores(hash_t* hash_doctores){
 	hash_iter_t* iter = hash_iter_crear(hash_doctores);
 	if (!iter) return NULL;
 	while (!hash_iter_al_final(iter)) {
-		const char *clave = hash_iter_ver_actual(iter);
-		doctor_t* doctor = hash_obtener(hash_doctores, clave);
-		heap_encolar(doctores_orden, doctor->nombre);
+		heap_encolar(doctores_orden, (char*) hash_iter_ver_actual(iter));
 		hash_iter_avanzar(iter);
 	}
 	hash_iter_destruir(iter);
@@ -190,136 +353,1128 @@ heap_t* crear_heap_doctores(hash_t* hash_doctores){
 }
  
 /***********************************
- *       FUNCIONES PRINCIPALES     *
+ *        CARGA EN PARALELO        *
  ***********************************/
 
-// Función que genera un hash de doctores a partir de un archivo CSV (cuya ruta es el parámetro de la función).
-// Pre: Ninguna.
-// Post: Devuelve el hash de doctores si se pudo procesar el archivo, NULL si no pudo realizarse por algún motivo.
-hash_t* generar_hash_doctores(char* archivo_doctores) {
-	// Confirmo el archivo existe
-	FILE *csv_doctores = fopen(archivo_doctores, "r");
-	if (!csv_doctores) return NULL;
+/* Los archivos de doctores y pacientes se dividen en trozos que terminan en
+ * un fin de línea, y cada trozo lo lee un hilo distinto, creando los
+ * registros de sus líneas. Después se guardan los registros de todos los
+ * trozos en el catálogo, en el orden del archivo, de modo que el resultado es el
+ * mismo que el de una lectura secuencial: ante nombres repetidos queda el
+ * último, y la carga termina en la primera línea sin segundo campo.
+ */
+
+#define MAX_HILOS 64
+// Los trozos tienen al menos este tamaño, para no repartir archivos chicos
+#define TAM_MIN_TROZO (1 << 20)
+#define REGISTROS_INICIAL 1024
+
+// Campos de una línea del archivo
+typedef struct registro {
+	const char* clave;
+	const char* texto;     // Especialidad (doctores)
+	uint64_t numero;       // Total de contribuciones (pacientes)
+} registro_t;
+
+// Lee los campos de una línea. Devuelve false si algún campo no es válido.
+typedef bool (*leer_registro_t)(csv_campo_t primero, csv_campo_t segundo, registro_t* registro);
+
+// Guarda un registro leído en su destino (el catálogo, o los arreglos de
+// una recarga). Devuelve false si no hubo memoria.
+typedef bool (*guardar_registro_t)(void* destino, const registro_t* registro);
+
+// Línea que se salteó por no ser válida, para informarla al terminar la carga
+typedef struct linea_invalida {
+	size_t linea;       // Número de línea dentro del trozo
+	const char* valor;
+} linea_invalida_t;
+
+// Lo que lee un hilo de su trozo del archivo
+typedef struct trozo_carga {
+	csv_mapa_t csv;
+	leer_registro_t leer;
+	registro_t* registros;
+	size_t cantidad;
+	size_t capacidad;
+	linea_invalida_t* invalidas;
+	size_t cant_invalidas;
+	bool cortado;   // Se encontró una línea sin segundo campo
+	bool error;     // No hubo memoria para algún registro
+	perfil_fase_t* fase;   // En la que cuenta lo que pide el hilo (ver perfil.h)
+} trozo_carga_t;
+
+// Lo que necesita el hilo que carga los pacientes
+typedef struct carga_pacientes {
+	clinica_t* clinica;
+	char* archivo;
+	csv_mapa_t* csv;
+	const char* archivo_indice;   // NULL si se cargan todos los pacientes
+	size_t hilos;
+	perfil_fase_t* fase;          // Del perfil del arranque, NULL si no se mide
+	bool ok;
+} carga_pacientes_t;
+
+bool leer_registro_doctor(csv_campo_t nombre, csv_campo_t especialidad, registro_t* registro) {
+	registro->clave = nombre.inicio;
+	registro->texto = especialidad.inicio;
+	registro->numero = 0;
+	return true;
+}
+
+bool leer_registro_paciente(csv_campo_t nombre, csv_campo_t total_contribuciones, registro_t* registro) {
+	unsigned long long total;
+	if (!csv_campo_numero(total_contribuciones, &total)) return false;
+	registro->clave = nombre.inicio;
+	registro->texto = NULL;
+	registro->numero = total;
+	return true;
+}
+
+// Lee las líneas de un trozo y guarda sus registros. Es la función de cada hilo.
+// Post: Los registros quedan en el trozo, en el orden en que aparecen.
+void* cargar_trozo(void* dato) {
+	trozo_carga_t* trozo = dato;
+	perfil_contar_en(trozo->fase);
+	while (csv_mapa_siguiente(&trozo->csv)) {
+		if (trozo->csv.segundo.largo == 0) {
+			trozo->cortado = true;
+			break;
+		}
+		if (trozo->cantidad == trozo->capacidad) {
+			size_t capacidad = trozo->capacidad ? trozo->capacidad * 2 : REGISTROS_INICIAL;
+			registro_t* registros = realloc(trozo->registros, capacidad * sizeof(registro_t));
+			if (!registros) {
+				trozo->error = true;
+				break;
+			}
+			trozo->registros = registros;
+			trozo->capacidad = capacidad;
+		}
+		if (!trozo->leer(trozo->csv.primero, trozo->csv.segundo, &trozo->registros[trozo->cantidad])) {
+			// La línea se saltea, y se recuerda para informarla
+			linea_invalida_t* invalidas = realloc(trozo->invalidas, (trozo->cant_invalidas + 1) * sizeof(linea_invalida_t));
+			if (!invalidas) {
+				trozo->error = true;
+				break;
+			}
+			invalidas[trozo->cant_invalidas].linea = trozo->csv.linea;
+			invalidas[trozo->cant_invalidas].valor = trozo->csv.segundo.inicio;
+			trozo->invalidas = invalidas;
+			trozo->cant_invalidas++;
+			continue;
+		}
+		trozo->cantidad++;
+	}
+	return NULL;
+}
+
+// Carga en 'destino' los registros de un archivo ya cargado, repartiendo
+// sus trozos entre hasta 'hilos' hilos (el que llama incluido). Las líneas
+// con valores inválidos se saltean, informando por stderr su número de línea.
+// Pre: El destino existe.
+// Post: Devuelve false si no hubo memoria para algún registro.
+bool cargar_csv(const char* archivo, csv_mapa_t* csv, size_t hilos, leer_registro_t leer, guardar_registro_t guardar, void* destino) {
+	csv_mapa_t partes[MAX_HILOS];
+	trozo_carga_t trozos[MAX_HILOS];
+	pthread_t ids[MAX_HILOS];
+	bool lanzado[MAX_HILOS];
 	
-	// Proceso archivo de doctores
-	csv_t linea = {.delim = ','};
-	hash_t* hash_doctores = hash_crear(&doctor_destruir);
-	while (csv_siguiente(&linea, csv_doctores)) {
-		if (strcmp(linea.segundo, "") != 0) {
-			doctor_t* doctor = doctor_crear(linea.primero, linea.segundo);
-			hash_guardar(hash_doctores, doctor->nombre, doctor);
+	size_t cant = csv_mapa_partir(csv, partes, hilos < MAX_HILOS ? hilos : MAX_HILOS, TAM_MIN_TROZO);
+	for (size_t i = 0; i < cant; i++) {
+		trozos[i] = (trozo_carga_t) {.csv = partes[i], .leer = leer, .fase = perfil_fase_del_hilo()};
+		// El primer trozo lo lee este mismo hilo; si no se puede lanzar un
+		// hilo para algún otro, también lo lee éste más adelante
+		lanzado[i] = i > 0 && pthread_create(&ids[i], NULL, cargar_trozo, &trozos[i]) == 0;
+	}
+	
+	bool ok = true;
+	bool cortado = false;
+	size_t lineas_previas = 0;
+	for (size_t i = 0; i < cant; i++) {
+		trozo_carga_t* trozo = &trozos[i];
+		if (lanzado[i]) pthread_join(ids[i], NULL);
+		else if (ok && !cortado) cargar_trozo(trozo);
+		
+		for (size_t j = 0; j < trozo->cant_invalidas && ok && !cortado; j++) {
+			linea_invalida_t* invalida = &trozo->invalidas[j];
+			fprintf(stderr, EINVAL_LINEA, archivo, lineas_previas + invalida->linea, invalida->valor);
 		}
-		else break;
+		lineas_previas += trozo->csv.linea;
+		for (size_t j = 0; j < trozo->cantidad && ok && !cortado; j++) {
+			if (!guardar(destino, &trozo->registros[j])) ok = false;
+		}
+		if (!cortado && trozo->error) ok = false;
+		cortado = cortado || trozo->cortado;
+		free(trozo->registros);
+		free(trozo->invalidas);
+		csv_mapa_cerrar(&trozo->csv);
+	}
+	return ok;
+}
+
+// Guarda un doctor leído en el catálogo. Ante nombres repetidos queda la
+// especialidad del último.
+bool guardar_doctor(void* destino, const registro_t* registro) {
+	clinica_t* clinica = destino;
+	uint32_t especialidad = obtener_o_crear_especialidad(clinica, registro->texto);
+	if (especialidad == SIN_ID) return false;
+	uint32_t doctor = indice_obtener(clinica->hash_doctores, registro->clave);
+	if (doctor == SIN_ID) {
+		doctor = doctores_agregar(&clinica->doctores, registro->clave);
+		if (doctor == SIN_ID || !indice_guardar(clinica->hash_doctores, registro->clave, doctor)) return false;
+	}
+	else especialidad_quitar_doctor(clinica, doctor);
+	especialidad_agregar_doctor(clinica, especialidad, doctor);
+	return true;
+}
+
+// Guarda un paciente leído en el catálogo. Ante nombres repetidos queda el
+// último (la fila del anterior deja de usarse).
+bool guardar_paciente(void* destino, const registro_t* registro) {
+	clinica_t* clinica = destino;
+	uint32_t paciente = pacientes_agregar(&clinica->pacientes, registro->clave, registro->numero);
+	return paciente != SIN_ID && indice_guardar(clinica->hash_pacientes, registro->clave, paciente);
+}
+
+// Carga los pacientes, o los indexa si la carga tiene un índice.
+void cargar_pacientes(carga_pacientes_t* carga) {
+	if (carga->archivo_indice) carga->ok = clinica_indexar_pacientes(carga->clinica, carga->archivo, carga->archivo_indice);
+	else carga->ok = clinica_cargar_pacientes(carga->clinica, carga->archivo, carga->csv, carga->hilos);
+}
+// Devuelve la cantidad de hilos a usar por omisión: uno por procesador.
+size_t hilos_por_omision(void) {
+	long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (procesadores < 1) return 1;
+	if (procesadores > MAX_HILOS) return MAX_HILOS;
+	return (size_t) procesadores;
+}
+
+/***********************************
+ *             RECARGA             *
+ ***********************************/
+
+/* RECARGAR:DOCTORES y RECARGAR:PACIENTES vuelven a leer el archivo CSV en
+ * un hilo aparte, mientras se siguen atendiendo comandos. Ese hilo compara
+ * el archivo con el catálogo en uso, que sólo consulta (los comandos no
+ * modifican los hashes ni las columnas que compara), y arma la lista de
+ * filas agregadas, modificadas y borradas. Entre un comando y el siguiente,
+ * el hilo principal aplica de una vez los cambios de las recargas que
+ * terminaron, con un costo proporcional a la cantidad de cambios.
+ *
+ * Las especialidades nunca se borran, para no perder sus listas de espera,
+ * y un doctor modificado conserva sus pacientes atendidos. Un paciente
+ * modificado o borrado que sigue en alguna lista de espera mantiene allí su
+ * total de contribuciones anterior: su fila no cambia, y el paciente
+ * modificado pasa a otra fila.
+ */
+
+typedef enum tipo_cambio {
+	AGREGADO,
+	MODIFICADO,
+	BORRADO
+} tipo_cambio_t;
+
+typedef struct cambio {
+	tipo_cambio_t tipo;
+	char* nombre;                 // Copia del nombre
+	char* especialidad;           // Copia de la especialidad (doctores)
+	unsigned long long total_contribuciones;   // (pacientes)
+} cambio_t;
+
+struct recarga {
+	tipo_recarga_t tipo;
+	const clinica_t* clinica;
+	pthread_t hilo;
+	bool lanzada;                 // Se lee en otro hilo (si no, ya se leyó)
+	pthread_mutex_t mutex;
+	bool terminada;               // Protegido por el mutex
+	bool error;                   // No se pudo leer el archivo o no hubo memoria
+	cambio_t* cambios;
+	size_t cantidad;
+	size_t capacidad;
+	size_t encontrados;           // Filas del archivo que ya estaban en el hash
+};
+
+// Registros leídos del archivo, antes de ordenarlos para compararlos
+typedef struct lectura {
+	registro_t* registros;
+	size_t cantidad;
+	size_t capacidad;
+} lectura_t;
+
+bool guardar_en_lectura(void* destino, const registro_t* registro) {
+	lectura_t* lectura = destino;
+	if (lectura->cantidad == lectura->capacidad) {
+		size_t capacidad = lectura->capacidad ? lectura->capacidad * 2 : REGISTROS_INICIAL;
+		registro_t* registros = realloc(lectura->registros, capacidad * sizeof(registro_t));
+		if (!registros) return false;
+		lectura->registros = registros;
+		lectura->capacidad = capacidad;
+	}
+	lectura->registros[lectura->cantidad++] = *registro;
+	return true;
+}
+
+// Devuelve una copia de la cadena, NULL si no hubo memoria.
+char* copiar_cadena(const char* cadena) {
+	size_t largo = strlen(cadena) + 1;
+	char* copia = malloc(largo);
+	if (copia) memcpy(copia, cadena, largo);
+	return copia;
+}
+
+// Agrega un cambio a la recarga, copiando los nombres.
+// Post: Devuelve false si no hubo memoria.
+bool recarga_agregar_cambio(recarga_t* recarga, tipo_cambio_t tipo, const char* nombre, const char* especialidad, unsigned long long total_contribuciones) {
+	if (recarga->cantidad == recarga->capacidad) {
+		size_t capacidad = recarga->capacidad ? recarga->capacidad * 2 : REGISTROS_INICIAL;
+		cambio_t* cambios = realloc(recarga->cambios, capacidad * sizeof(cambio_t));
+		if (!cambios) return false;
+		recarga->cambios = cambios;
+		recarga->capacidad = capacidad;
+	}
+	cambio_t* cambio = &recarga->cambios[recarga->cantidad];
+	cambio->tipo = tipo;
+	cambio->nombre = copiar_cadena(nombre);
+	cambio->especialidad = especialidad ? copiar_cadena(especialidad) : NULL;
+	cambio->total_contribuciones = total_contribuciones;
+	if (!cambio->nombre || (especialidad && !cambio->especialidad)) {
+		free(cambio->nombre);
+		free(cambio->especialidad);
+		return false;
+	}
+	recarga->cantidad++;
+	return true;
+}
+
+// Compara una fila del archivo nuevo con el catálogo en uso, y anota el
+// cambio si es nueva o cambió. Se usa para recorrer el árbol de filas leídas.
+bool comparar_fila(const char* clave, void* dato, void* extra) {
+	recarga_t* recarga = extra;
+	const clinica_t* clinica = recarga->clinica;
+	const registro_t* nuevo = dato;
+	bool ok = true;
+	if (recarga->tipo == RECARGA_DOCTORES) {
+		uint32_t actual = indice_obtener(clinica->hash_doctores, clave);
+		if (actual == SIN_ID) ok = recarga_agregar_cambio(recarga, AGREGADO, clave, nuevo->texto, 0);
+		else if (strcmp(clinica->especialidades.nombre[clinica->doctores.especialidad[actual]], nuevo->texto) != 0) ok = recarga_agregar_cambio(recarga, MODIFICADO, clave, nuevo->texto, 0);
+		if (actual != SIN_ID) recarga->encontrados++;
+	}
+	else {
+		uint32_t actual = indice_obtener(clinica->hash_pacientes, clave);
+		if (actual == SIN_ID) ok = recarga_agregar_cambio(recarga, AGREGADO, clave, NULL, nuevo->numero);
+		else if (clinica->pacientes.total_contribuciones[actual] != nuevo->numero) ok = recarga_agregar_cambio(recarga, MODIFICADO, clave, NULL, nuevo->numero);
+		if (actual != SIN_ID) recarga->encontrados++;
+	}
+	if (!ok) recarga->error = true;
+	return ok;
+}
+
+// Anota como borradas las filas del hash en uso que no están en el archivo.
+// Sólo recorre el hash si hay alguna, es decir, si no se encontraron todas.
+void buscar_borrados(recarga_t* recarga, const hash_t* hash, const abb_plano_t* nuevos) {
+	if (recarga->encontrados == hash_cantidad(hash)) return;
+	hash_iter_t* iter = hash_iter_crear(hash);
+	if (!iter) {
+		recarga->error = true;
+		return;
+	}
+	while (!recarga->error && !hash_iter_al_final(iter)) {
+		const char* clave = hash_iter_ver_actual(iter);
+		if (!abb_plano_pertenece(nuevos, clave) && !recarga_agregar_cambio(recarga, BORRADO, clave, NULL, 0))
+			recarga->error = true;
+		hash_iter_avanzar(iter);
+	}
+	hash_iter_destruir(iter);
+}
+
+// Lee el archivo de la recarga y lo compara con el catálogo en uso.
+void recarga_leer(recarga_t* recarga) {
+	bool doctores = recarga->tipo == RECARGA_DOCTORES;
+	const char* archivo = recarga->clinica->archivos[recarga->tipo];
+	csv_mapa_t csv = {.delim = ','};
+	if (!csv_mapa_abrir(&csv, archivo)) {
+		recarga->error = true;
+		return;
 	}
-	fclose(csv_doctores);
-	csv_terminar(&linea);
 	
-	return hash_doctores;
+	// Las filas se ordenan en un árbol estático, que deja la última de cada
+	// nombre repetido, igual que la carga inicial
+	lectura_t lectura = {0};
+	const char** claves = NULL;
+	void** datos = NULL;
+	abb_plano_t* nuevos = NULL;
+	if (cargar_csv(archivo, &csv, 1, doctores ? leer_registro_doctor : leer_registro_paciente, guardar_en_lectura, &lectura)) {
+		claves = malloc((lectura.cantidad + 1) * sizeof(char*));
+		datos = malloc((lectura.cantidad + 1) * sizeof(void*));
+		for (size_t i = 0; claves && datos && i < lectura.cantidad; i++) {
+			claves[i] = lectura.registros[i].clave;
+			datos[i] = &lectura.registros[i];
+		}
+		if (claves && datos) nuevos = abb_plano_crear(claves, datos, lectura.cantidad, strcmp, NULL);
+	}
+	if (!nuevos) recarga->error = true;
+	else {
+		abb_plano_in_order(nuevos, comparar_fila, recarga);
+		if (!recarga->error)
+			buscar_borrados(recarga, doctores ? recarga->clinica->hash_doctores : recarga->clinica->hash_pacientes, nuevos);
+		abb_plano_destruir(nuevos);
+	}
+	free(claves);
+	free(datos);
+	free(lectura.registros);
+	csv_mapa_cerrar(&csv);
+}
+
+// Función del hilo que lee una recarga.
+void* recargar_en_segundo_plano(void* dato) {
+	recarga_t* recarga = dato;
+	recarga_leer(recarga);
+	pthread_mutex_lock(&recarga->mutex);
+	recarga->terminada = true;
+	pthread_mutex_unlock(&recarga->mutex);
+	return NULL;
+}
+
+// Aplica un cambio del archivo de doctores. Un doctor modificado cambia de
+// especialidad, conservando sus pacientes atendidos.
+void aplicar_cambio_doctor(clinica_t* clinica, const cambio_t* cambio) {
+	uint32_t doctor = indice_obtener(clinica->hash_doctores, cambio->nombre);
+	if (cambio->tipo == BORRADO) {
+		if (doctor == SIN_ID) return;
+		especialidad_quitar_doctor(clinica, doctor);
+		hash_borrar(clinica->hash_doctores, cambio->nombre);
+		return;
+	}
+	uint32_t especialidad = obtener_o_crear_especialidad(clinica, cambio->especialidad);
+	if (especialidad == SIN_ID) return;
+	if (cambio->tipo == AGREGADO) {
+		const char* nombre = cadenas_internar(clinica->nombres, cambio->nombre, NULL);
+		doctor = nombre ? doctores_agregar(&clinica->doctores, nombre) : SIN_ID;
+		if (doctor == SIN_ID || !indice_guardar(clinica->hash_doctores, nombre, doctor)) return;
+	}
+	else especialidad_quitar_doctor(clinica, doctor);
+	especialidad_agregar_doctor(clinica, especialidad, doctor);
+}
+
+// Aplica un cambio del archivo de pacientes. Si un paciente modificado está
+// en alguna lista de espera, su nuevo total va en una fila nueva, y la
+// anterior queda sólo en las listas de espera.
+void aplicar_cambio_paciente(clinica_t* clinica, const cambio_t* cambio) {
+	if (cambio->tipo == BORRADO) {
+		hash_borrar(clinica->hash_pacientes, cambio->nombre);
+		return;
+	}
+	pacientes_t* pacientes = &clinica->pacientes;
+	uint32_t paciente = indice_obtener(clinica->hash_pacientes, cambio->nombre);
+	if (paciente != SIN_ID && !pacientes->en_espera[paciente]) {
+		pacientes->total_contribuciones[paciente] = cambio->total_contribuciones;
+		return;
+	}
+	const char* nombre = paciente != SIN_ID ? pacientes->nombre[paciente] : cadenas_internar(clinica->nombres, cambio->nombre, NULL);
+	paciente = nombre ? pacientes_agregar(pacientes, nombre, cambio->total_contribuciones) : SIN_ID;
+	if (paciente != SIN_ID) indice_guardar(clinica->hash_pacientes, nombre, paciente);
 }
 
-// Función que genera un hash de pacientes a partir de un archivo CSV (cuya ruta es el parámetro de la función).
-// Pre: Ninguna.
-// Post: Devuelve el hash de pacientes si se pudo procesar el archivo, NULL si no pudo realizarse por algún motivo.
-hash_t* generar_hash_pacientes(char* archivo_pacientes) {
-	// Confirmo que el archivo existe
-	FILE *csv_pacientes = fopen(archivo_pacientes, "r");
-	if (!csv_pacientes) return NULL;
+// Espera a que termine la recarga en curso del tipo indicado (si hay una),
+// aplica sus cambios si 'aplicar' es true, y la destruye.
+void recarga_terminar(clinica_t* clinica, tipo_recarga_t tipo, bool aplicar) {
+	recarga_t* recarga = clinica->recargas[tipo];
+	if (!recarga) return;
+	if (recarga->lanzada) pthread_join(recarga->hilo, NULL);
+	pthread_mutex_destroy(&recarga->mutex);
+	clinica->recargas[tipo] = NULL;
 	
-	// Proceso archivo de pacientes
-	csv_t linea = {.delim = ','};
-	hash_t* hash_pacientes = hash_crear(&paciente_destruir);
-	while (csv_siguiente(&linea, csv_pacientes)) {
-		if (strcmp(linea.segundo, "") != 0) {
-			paciente_t* paciente = paciente_crear(linea.primero, linea.segundo);
-			if (!paciente) return NULL;
-			hash_guardar(hash_pacientes, paciente->nombre, paciente);
+	if (aplicar && recarga->error) salida_formato(&clinica->salida, ERECARGA, clinica->archivos[tipo]);
+	else if (aplicar) {
+		size_t cantidades[BORRADO + 1] = {0};
+		for (size_t i = 0; i < recarga->cantidad; i++) {
+			cambio_t* cambio = &recarga->cambios[i];
+			if (tipo == RECARGA_DOCTORES) aplicar_cambio_doctor(clinica, cambio);
+			else aplicar_cambio_paciente(clinica, cambio);
+			cantidades[cambio->tipo]++;
 		}
-		else break;
+		salida_formato(&clinica->salida, RECARGA_APLICADA, tipo == RECARGA_DOCTORES ? "DOCTORES" : "PACIENTES", cantidades[AGREGADO], cantidades[MODIFICADO], cantidades[BORRADO]);
 	}
-	fclose(csv_pacientes);
-	csv_terminar(&linea);
+	for (size_t i = 0; i < recarga->cantidad; i++) {
+		free(recarga->cambios[i].nombre);
+		free(recarga->cambios[i].especialidad);
+	}
+	free(recarga->cambios);
+	free(recarga);
+}
+
+// Aplica los cambios de las recargas que ya terminaron de leerse, o de
+// todas las que estén en curso si 'esperar' es true.
+void aplicar_recargas(clinica_t* clinica, bool esperar) {
+	for (int tipo = 0; tipo < TIPOS_RECARGA; tipo++) {
+		recarga_t* recarga = clinica->recargas[tipo];
+		if (!recarga) continue;
+		pthread_mutex_lock(&recarga->mutex);
+		bool terminada = recarga->terminada;
+		pthread_mutex_unlock(&recarga->mutex);
+		if (terminada || esperar) recarga_terminar(clinica, (tipo_recarga_t) tipo, true);
+	}
+}
+
+/***********************************
+ *             CATÁLOGO            *
+ ***********************************/
+
+// Busca un doctor por su nombre, en el hash o en el índice de la imagen.
+// Post: Devuelve el id del doctor, SIN_ID si no existe.
+uint32_t clinica_buscar_doctor(const clinica_t* clinica, const char* nombre) {
+	if (!clinica->imagen) return indice_obtener(clinica->hash_doctores, nombre);
+	size_t id;
+	if (!catalogo_buscar(clinica->imagen, CATALOGO_DOCTORES, nombre, &id)) return SIN_ID;
+	return (uint32_t) id;
+}
+
+// Busca un paciente por su nombre, en el hash o en el índice de la imagen.
+// Post: Devuelve el id del paciente, SIN_ID si no existe.
+uint32_t clinica_buscar_paciente(const clinica_t* clinica, const char* nombre) {
+	if (!clinica->imagen) return indice_obtener(clinica->hash_pacientes, nombre);
+	size_t id;
+	if (!catalogo_buscar(clinica->imagen, CATALOGO_PACIENTES, nombre, &id)) return SIN_ID;
+	return (uint32_t) id;
+}
+
+// Busca un paciente por su nombre. Si los pacientes se leen del archivo al
+// pedirlos y éste todavía no se leyó, lo lee y lo agrega al catálogo.
+// Post: Devuelve el id del paciente, SIN_ID si no existe o no hubo memoria.
+uint32_t clinica_obtener_paciente(clinica_t* clinica, const char* nombre) {
+	uint32_t paciente = clinica_buscar_paciente(clinica, nombre);
+	if (paciente != SIN_ID || !clinica->indice_pacientes) return paciente;
+	csv_campo_t campo;
+	unsigned long long total;
+	// El total se validó al armar el índice, pero no si el índice ya estaba guardado
+	if (!indice_csv_buscar(clinica->indice_pacientes, nombre, &campo) || !csv_campo_numero(campo, &total)) return SIN_ID;
+	const char* interno = cadenas_internar(clinica->nombres, nombre, NULL);
+	paciente = interno ? pacientes_agregar(&clinica->pacientes, interno, total) : SIN_ID;
+	if (paciente == SIN_ID || !indice_guardar(clinica->hash_pacientes, interno, paciente)) return SIN_ID;
+	return paciente;
+}
+
+// Busca una especialidad por su nombre, en la tabla de nombres internados
+// o en el índice de la imagen.
+// Post: Devuelve el id de la especialidad, SIN_ID si no existe.
+uint32_t clinica_buscar_especialidad(const clinica_t* clinica, const char* nombre) {
+	size_t id;
+	if (!clinica->imagen) {
+		if (!cadenas_buscar(clinica->nombres_especialidades, nombre, &id)) return SIN_ID;
+		return (uint32_t) id;
+	}
+	if (!catalogo_buscar(clinica->imagen, CATALOGO_ESPECIALIDADES, nombre, &id)) return SIN_ID;
+	return (uint32_t) id;
+}
+
+clinica_t* clinica_crear(const char* archivo_doctores, const char* archivo_pacientes) {
+	clinica_t* clinica = calloc(1, sizeof(clinica_t));
+	if (!clinica) return NULL;
+	clinica->hash_doctores = hash_crear_con_claves_prestadas(NULL);
+	clinica->hash_pacientes = hash_crear_con_claves_prestadas(NULL);
+	clinica->nombres_especialidades = cadenas_crear();
+	clinica->nombres = cadenas_crear();
+	if (!clinica->hash_doctores || !clinica->hash_pacientes || !clinica->nombres_especialidades || !clinica->nombres) {
+		clinica_destruir(clinica);
+		return NULL;
+	}
+	clinica->salida.fd = STDOUT_FILENO;
+	clinica->archivos[RECARGA_DOCTORES] = archivo_doctores;
+	clinica->archivos[RECARGA_PACIENTES] = archivo_pacientes;
+	return clinica;
+}
+
+clinica_t* clinica_cargar_imagen(const char* ruta) {
+	clinica_t* clinica = calloc(1, sizeof(clinica_t));
+	if (!clinica) return NULL;
+	catalogo_t* imagen = malloc(sizeof(catalogo_t));
+	if (!imagen || !catalogo_abrir(imagen, ruta)) {
+		free(imagen);
+		free(clinica);
+		return NULL;
+	}
+	clinica->salida.fd = STDOUT_FILENO;
+	clinica->imagen = imagen;
 	
-	return hash_pacientes;
+	// Sólo se llenan las columnas, en bloque: los nombres y los índices se
+	// usan directamente desde la imagen, y las filas tienen sus mismos números
+	size_t cant_doctores = imagen->cantidad[CATALOGO_DOCTORES];
+	size_t cant_especialidades = imagen->cantidad[CATALOGO_ESPECIALIDADES];
+	size_t cant_pacientes = imagen->cantidad[CATALOGO_PACIENTES];
+	if (!doctores_reservar(&clinica->doctores, cant_doctores) || !especialidades_reservar(&clinica->especialidades, cant_especialidades) || !pacientes_reservar(&clinica->pacientes, cant_pacientes)) {
+		clinica_destruir(clinica);
+		return NULL;
+	}
+	for (size_t i = 0; i < cant_especialidades; i++)
+		especialidades_agregar(&clinica->especialidades, catalogo_nombre(imagen, imagen->especialidades[i].nombre));
+	for (size_t i = 0; i < cant_doctores; i++) {
+		const catalogo_doctor_t* registro = &imagen->doctores[i];
+		uint32_t doctor = doctores_agregar(&clinica->doctores, catalogo_nombre(imagen, registro->nombre));
+		especialidad_agregar_doctor(clinica, registro->especialidad, doctor);
+	}
+	for (size_t i = 0; i < cant_pacientes; i++) {
+		const catalogo_paciente_t* registro = &imagen->pacientes[i];
+		pacientes_agregar(&clinica->pacientes, catalogo_nombre(imagen, registro->nombre), registro->total_contribuciones);
+	}
+	return clinica;
 }
 
-// Función que genera un hash de especialidades a partir del hash de doctores previamente creado.
-// Pre: El hash de doctores existe.
-// Post: Devuelve el hash de especialidades, NULL si hubo algún error.
-hash_t* generar_hash_especialidades(hash_t* hash_doctores) {
-	hash_iter_t* iter = hash_iter_crear(hash_doctores);
-	if (!iter) return NULL;
+bool clinica_compilar(const clinica_t* clinica, const char* ruta) {
+	catalogo_armado_t* armado = catalogo_armado_crear();
+	if (!armado) return false;
+	bool ok = true;
 	
-	hash_t* hash_especialidades = hash_crear(&especialidad_destruir);
-	if (!hash_especialidades) return NULL;
+	hash_iter_t* iter = hash_iter_crear(clinica->hash_doctores);
+	if (!iter) ok = false;
+	while (ok && !hash_iter_al_final(iter)) {
+		uint32_t doctor = indice_obtener(clinica->hash_doctores, hash_iter_ver_actual(iter));
+		const char* especialidad = clinica->especialidades.nombre[clinica->doctores.especialidad[doctor]];
+		ok = catalogo_agregar_doctor(armado, clinica->doctores.nombre[doctor], especialidad);
+		hash_iter_avanzar(iter);
+	}
+	hash_iter_destruir(iter);
 	
-	while (!hash_iter_al_final(iter)) {
-		const char *clave = hash_iter_ver_actual(iter);
-		doctor_t* doctor = hash_obtener(hash_doctores, clave);
-		if (!hash_pertenece(hash_especialidades, doctor->especialidad)){
-			especialidad_t* especialidad = especialidad_crear(doctor->especialidad);
-			hash_guardar(hash_especialidades, especialidad->nombre, especialidad);
-		}
+	iter = ok ? hash_iter_crear(clinica->hash_pacientes) : NULL;
+	if (!iter) ok = false;
+	while (ok && !hash_iter_al_final(iter)) {
+		uint32_t paciente = indice_obtener(clinica->hash_pacientes, hash_iter_ver_actual(iter));
+		ok = catalogo_agregar_paciente(armado, clinica->pacientes.nombre[paciente], clinica->pacientes.total_contribuciones[paciente]);
 		hash_iter_avanzar(iter);
 	}
 	hash_iter_destruir(iter);
 	
-	return hash_especialidades;
+	ok = ok && catalogo_armado_guardar(armado, ruta);
+	catalogo_armado_destruir(armado);
+	return ok;
+}
+
+void clinica_terminar(clinica_t* clinica) {
+	salida_terminar(&clinica->salida);
+	if (clinica->bitacora) bitacora_cerrar(clinica->bitacora);
+	clinica->bitacora = NULL;
+}
+
+void clinica_destruir(clinica_t* clinica) {
+	for (int tipo = 0; tipo < TIPOS_RECARGA; tipo++) recarga_terminar(clinica, (tipo_recarga_t) tipo, false);
+	clinica_terminar(clinica);
+	if (clinica->hash_doctores) hash_destruir(clinica->hash_doctores);
+	if (clinica->hash_pacientes) hash_destruir(clinica->hash_pacientes);
+	for (size_t i = 0; i < clinica->especialidades.cantidad; i++)
+		heap_ids_destruir(clinica->especialidades.lista_de_espera[i]);
+	cadenas_destruir(clinica->nombres_especialidades);
+	cadenas_destruir(clinica->nombres);
+	indice_csv_destruir(clinica->indice_pacientes);
+	if (clinica->imagen) {
+		catalogo_cerrar(clinica->imagen);
+		free(clinica->imagen);
+	}
+	doctores_t* doctores = &clinica->doctores;
+	free(doctores->nombre);
+	free(doctores->especialidad);
+	free(doctores->cant_atendidos);
+	free(doctores->anterior);
+	free(doctores->siguiente);
+	pacientes_t* pacientes = &clinica->pacientes;
+	free(pacientes->nombre);
+	free(pacientes->total_contribuciones);
+	free(pacientes->en_espera);
+	especialidades_t* especialidades = &clinica->especialidades;
+	free(especialidades->nombre);
+	free(especialidades->lista_de_espera);
+	free(especialidades->primer_doctor);
+	free(especialidades->cant_doctores);
+	free(especialidades->max_en_espera);
+	free(clinica);
+}
+
+/***********************************
+ *             MÉTRICAS            *
+ ***********************************/
+
+/* El catálogo lleva métricas de los comandos que ejecuta: cuántos se
+ * ejecutaron de cada tipo y cuánto tardó cada uno, en un histograma por
+ * tipo (ver metricas.h), cuántas veces se informó cada error, y la mayor
+ * cantidad de pacientes que llegó a tener en espera cada especialidad.
+ * INFORME:METRICAS las muestra, y con --metricas RUTA se guardan en RUTA,
+ * en JSON, al terminar.
+ *
+ * La latencia de un comando es lo que tarda en ejecutarse, sin contar la
+ * lectura de la entrada ni la escritura de la salida. Con --repartir, cada
+ * trabajador mide las tareas que ejecuta, y el hilo principal las cuenta al
+ * juntar sus salidas: las métricas sólo se modifican desde el hilo
+ * principal, salvo el máximo en espera de cada especialidad, que modifica
+ * sólo quien ejecuta sus comandos.
+ *
+ * Compilando con -DSIN_METRICAS (make DEFINES=-DSIN_METRICAS) no se mide
+ * nada: las funciones que actualizan las métricas son macros vacías, e
+ * INFORME:METRICAS y --metricas no existen.
+ */
+
+#define MILESIMAS_PERCENTILES {500, 900, 990, 999}
+#define CANT_PERCENTILES 4
+
+#ifndef SIN_METRICAS
+
+// Devuelve el instante en que empieza o termina una medición, en ns.
+uint64_t reloj_metricas(void) {
+	return metricas_reloj();
+}
+
+// Cuenta un error informado.
+void contar_error(clinica_t* clinica, tipo_error_t error) {
+	clinica->metricas.errores[error]++;
+}
+
+// Cuenta un comando que tardó 'duracion' ns en ejecutarse.
+void medir_comando(clinica_t* clinica, id_comando_t comando, uint64_t duracion) {
+	histograma_agregar(&clinica->metricas.latencias[comando], duracion);
+}
+
+// Actualiza el máximo de pacientes en espera de la especialidad, después
+// de encolar uno.
+void medir_espera(clinica_t* clinica, uint32_t especialidad) {
+	uint32_t* maximo = &clinica->especialidades.max_en_espera[especialidad];
+	size_t en_espera = heap_ids_cantidad(clinica->especialidades.lista_de_espera[especialidad]);
+	if (en_espera > *maximo) *maximo = (uint32_t) en_espera;
+}
+
+// Devuelve el nombre de un comando.
+const char* nombre_comando(id_comando_t comando) {
+	static const char* const NOMBRES[CANT_COMANDOS] = {
+		[CMD_PEDIR_TURNO] = NOMBRE_PEDIR_TURNO,
+		[CMD_ATENDER_SIGUIENTE] = NOMBRE_ATENDER_SIGUIENTE,
+		[CMD_INFORME] = NOMBRE_INFORME,
+		[CMD_RECARGAR] = NOMBRE_RECARGAR,
+	};
+	return NOMBRES[comando];
+}
+
+// Función que muestra las métricas de los comandos ejecutados hasta ahora.
+// Pre: El catálogo existe.
+// Post: Ninguna.
+//
+// Salida por pantalla:
+//
+// COMANDO: N comando(s), latencia p50 A ns, p90 B ns, p99 C ns, p99.9 D ns, máx E ns
+// (una línea por comando)
+// Errores: D doctor(es), P paciente(s) y E especialidad(es) inexistente(s), C comando(s) inexistente(s), L línea(s) inválida(s)
+// ESPECIALIDAD: hasta N paciente(s) en espera
+// (una línea por especialidad que tuvo pacientes en espera)
+void mostrar_metricas(clinica_t* clinica) {
+	const metricas_t* metricas = &clinica->metricas;
+	const unsigned int milesimas[CANT_PERCENTILES] = MILESIMAS_PERCENTILES;
+	for (int comando = 0; comando < CANT_COMANDOS; comando++) {
+		const histograma_t* latencias = &metricas->latencias[comando];
+		size_t percentiles[CANT_PERCENTILES];
+		for (size_t i = 0; i < CANT_PERCENTILES; i++) percentiles[i] = (size_t) histograma_percentil(latencias, milesimas[i]);
+		salida_formato(&clinica->salida, METRICAS_COMANDO, nombre_comando((id_comando_t) comando), (size_t) latencias->cantidad, percentiles[0], percentiles[1], percentiles[2], percentiles[3], (size_t) latencias->maximo);
+	}
+	const size_t* errores = metricas->errores;
+	salida_formato(&clinica->salida, METRICAS_ERRORES, errores[ERROR_DOCTOR], errores[ERROR_PACIENTE], errores[ERROR_ESPECIALIDAD], errores[ERROR_COMANDO], errores[ERROR_LINEA]);
+	const especialidades_t* especialidades = &clinica->especialidades;
+	for (size_t i = 0; i < especialidades->cantidad; i++) {
+		if (especialidades->max_en_espera[i] > 0)
+			salida_formato(&clinica->salida, METRICAS_ESPERA, especialidades->nombre[i], (size_t) especialidades->max_en_espera[i]);
+	}
+}
+
+// Escribe una cadena en JSON, entre comillas y con los caracteres que hace
+// falta escapados.
+void salida_json(salida_t* salida, const char* cadena) {
+	static const char HEXA[] = "0123456789abcdef";
+	salida_escribir(salida, "\"", 1);
+	const char* inicio = cadena;
+	for (; *cadena; cadena++) {
+		unsigned char c = (unsigned char) *cadena;
+		if (c >= 0x20 && c != '"' && c != '\\') continue;
+		salida_escribir(salida, inicio, (size_t) (cadena - inicio));
+		inicio = cadena + 1;
+		if (c == '"' || c == '\\') {
+			char escape[2] = {'\\', (char) c};
+			salida_escribir(salida, escape, sizeof(escape));
+		}
+		else {
+			char escape[6] = {'\\', 'u', '0', '0', HEXA[c >> 4], HEXA[c & 0xf]};
+			salida_escribir(salida, escape, sizeof(escape));
+		}
+	}
+	salida_escribir(salida, inicio, (size_t) (cadena - inicio));
+	salida_escribir(salida, "\"", 1);
+}
+
+// Guarda las métricas en el archivo 'ruta', en JSON:
+//
+// {"comandos": {"PEDIR_TURNO": {"cantidad": N, "latencia_ns": {"min": A, "p50": B,
+// "p90": C, "p99": D, "p99.9": E, "max": F, "suma": G}}, ...},
+// "errores": {"ENOENT_DOCTOR": N, "ENOENT_PACIENTE": N, "ENOENT_ESPECIALIDAD": N,
+// "ENOENT_CMD": N, "EINVAL_CMD": N}, "max_en_espera": {"ESPECIALIDAD": N, ...}}
+//
+// Post: Devuelve false si no se pudo escribir.
+bool guardar_metricas(const clinica_t* clinica, const char* ruta) {
+	int fd = open(ruta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+	salida_t salida = {.fd = fd};
+	const metricas_t* metricas = &clinica->metricas;
+	const unsigned int milesimas[CANT_PERCENTILES] = MILESIMAS_PERCENTILES;
+	const char* const nombres_percentiles[CANT_PERCENTILES] = {"p50", "p90", "p99", "p99.9"};
+	salida_cadena(&salida, "{\"comandos\": {");
+	for (int comando = 0; comando < CANT_COMANDOS; comando++) {
+		const histograma_t* latencias = &metricas->latencias[comando];
+		salida_formato(&salida, "%s\"%s\": {\"cantidad\": %zu, \"latencia_ns\": {\"min\": %zu", comando ? ", " : "", nombre_comando((id_comando_t) comando), (size_t) latencias->cantidad, (size_t) latencias->minimo);
+		for (size_t i = 0; i < CANT_PERCENTILES; i++)
+			salida_formato(&salida, ", \"%s\": %zu", nombres_percentiles[i], (size_t) histograma_percentil(latencias, milesimas[i]));
+		salida_formato(&salida, ", \"max\": %zu, \"suma\": %zu}}", (size_t) latencias->maximo, (size_t) latencias->suma);
+	}
+	const size_t* errores = metricas->errores;
+	salida_formato(&salida, "}, \"errores\": {\"ENOENT_DOCTOR\": %zu, \"ENOENT_PACIENTE\": %zu, \"ENOENT_ESPECIALIDAD\": %zu, \"ENOENT_CMD\": %zu, \"EINVAL_CMD\": %zu}, \"max_en_espera\": {", errores[ERROR_DOCTOR], errores[ERROR_PACIENTE], errores[ERROR_ESPECIALIDAD], errores[ERROR_COMANDO], errores[ERROR_LINEA]);
+	const especialidades_t* especialidades = &clinica->especialidades;
+	bool primera = true;
+	for (size_t i = 0; i < especialidades->cantidad; i++) {
+		if (!especialidades->max_en_espera[i]) continue;
+		if (!primera) salida_cadena(&salida, ", ");
+		primera = false;
+		salida_json(&salida, especialidades->nombre[i]);
+		salida_formato(&salida, ": %zu", (size_t) especialidades->max_en_espera[i]);
+	}
+	salida_cadena(&salida, "}}\n");
+	bool ok = salida_terminar(&salida);
+	return close(fd) == 0 && ok;
+}
+
+#else
+
+#define reloj_metricas() ((uint64_t) 0)
+#define contar_error(clinica, error) ((void) 0)
+#define medir_comando(clinica, comando, duracion) ((void) (duracion))
+#define medir_espera(clinica, especialidad) ((void) 0)
+#define mostrar_metricas(clinica) ((void) (clinica))
+
+#endif // SIN_METRICAS
+
+/***********************************
+ *             BITÁCORA            *
+ ***********************************/
+
+/* Con --bitacora RUTA, cada cambio de una lista de espera se registra en la
+ * bitácora RUTA (ver bitacora.h) antes de mostrar su resultado, y al
+ * arrancar se recuperan las listas de espera y los pacientes atendidos que
+ * había al terminar la ejecución anterior, de cualquier forma que haya
+ * terminado. Los registros son líneas de texto, con nombres y no ids, ya que
+ * los archivos pueden cambiar entre dos ejecuciones:
+ *
+ *     E:TOTAL,PACIENTE,ESPECIALIDAD    se encoló al paciente, con ese total
+ *     A:DOCTOR,ESPECIALIDAD            el doctor atendió al siguiente
+ *     C:CANTIDAD,DOCTOR                el doctor atendió a esa cantidad
+ *                                      (sólo en las instantáneas)
+ *
+ * Los nombres de pacientes y doctores no tienen comas (son un campo de su
+ * CSV), pero la especialidad sí puede tenerlas: es el resto de la línea.
+ *
+ * Los registros se sincronizan justo antes de vaciar la salida (o, en el
+ * servidor, de enviar las respuestas de la ronda): un único fdatasync() por
+ * cada bloque de comandos. Una respuesta de más de 64 KB empieza a
+ * escribirse antes, sin esperar a que sus cambios estén en el disco.
+ *
+ * Una instantánea tiene un registro E por cada paciente en espera, en el
+ * orden del arreglo de su heap, de modo que se vuelve a armar el mismo heap
+ * y los pacientes con igual total salen en el mismo orden. Al recuperar, un
+ * paciente cuyo total cambió (o que ya no existe) vuelve a la lista con el
+ * total con que se encoló, en una fila aparte que no está en su hash; los
+ * registros de especialidades que ya no existen se descartan.
+ */
+
+#define REGISTRO_ENCOLADO 'E'
+#define REGISTRO_ATENCION 'A'
+#define REGISTRO_CANTIDAD 'C'
+
+// Encola al paciente en la lista de espera de la especialidad, sin
+// informarlo.
+// Post: Devuelve false si no hubo memoria.
+bool encolar_en_lista(clinica_t* clinica, uint32_t paciente, uint32_t especialidad) {
+	// La lista de espera se crea con el primer turno; se ordena por la
+	// columna de totales de contribuciones
+	heap_ids_t** lista_de_espera = &clinica->especialidades.lista_de_espera[especialidad];
+	if (!*lista_de_espera) *lista_de_espera = heap_ids_crear((const uint64_t* const*) &clinica->pacientes.total_contribuciones);
+	if (!*lista_de_espera || !heap_ids_encolar(*lista_de_espera, paciente)) return false;
+	__atomic_add_fetch(&clinica->pacientes.en_espera[paciente], 1, __ATOMIC_RELAXED);
+	medir_espera(clinica, especialidad);
+	return true;
+}
+
+// Desencola al siguiente paciente de la lista de espera de la
+// especialidad, sin informarlo.
+// Post: Devuelve el id del paciente, SIN_ID si no había pacientes en espera.
+uint32_t desencolar_de_lista(clinica_t* clinica, uint32_t especialidad) {
+	heap_ids_t* lista_de_espera = clinica->especialidades.lista_de_espera[especialidad];
+	if (!heap_ids_cantidad(lista_de_espera)) return SIN_ID;
+	uint32_t paciente = heap_ids_desencolar(lista_de_espera);
+	__atomic_sub_fetch(&clinica->pacientes.en_espera[paciente], 1, __ATOMIC_RELAXED);
+	return paciente;
+}
+
+// Registra que se encoló al paciente en la especialidad, si hay bitácora.
+void registrar_encolado(clinica_t* clinica, uint32_t paciente, uint32_t especialidad) {
+	if (!clinica->bitacora) return;
+	salida_formato(bitacora_registros(clinica->bitacora), "E:%zu,%s,%s\n", (size_t) clinica->pacientes.total_contribuciones[paciente], clinica->pacientes.nombre[paciente], clinica->especialidades.nombre[especialidad]);
+}
+
+// Registra que el doctor atendió al siguiente de la especialidad, si hay bitácora.
+void registrar_atencion(clinica_t* clinica, uint32_t doctor, uint32_t especialidad) {
+	if (!clinica->bitacora) return;
+	salida_formato(bitacora_registros(clinica->bitacora), "A:%s,%s\n", clinica->doctores.nombre[doctor], clinica->especialidades.nombre[especialidad]);
+}
+
+// Busca al paciente de un registro E. Si no existe o su total cambió, lo
+// agrega en una fila aparte con el total del registro.
+// Post: Devuelve el id del paciente, SIN_ID si no hubo memoria.
+uint32_t paciente_recuperado(clinica_t* clinica, const char* nombre, uint64_t total_contribuciones) {
+	uint32_t paciente = clinica_obtener_paciente(clinica, nombre);
+	if (paciente != SIN_ID && clinica->pacientes.total_contribuciones[paciente] == total_contribuciones) return paciente;
+	// Una imagen no tiene tabla de nombres agregados hasta que hace falta
+	if (!clinica->nombres) clinica->nombres = cadenas_crear();
+	const char* interno = NULL;
+	if (paciente != SIN_ID) interno = clinica->pacientes.nombre[paciente];
+	else if (clinica->nombres) interno = cadenas_internar(clinica->nombres, nombre, NULL);
+	return interno ? pacientes_agregar(&clinica->pacientes, interno, total_contribuciones) : SIN_ID;
+}
+
+// Aplica un registro de la bitácora al recuperar. Los registros que no
+// se pueden aplicar se descartan. Se usa como bitacora_aplicar_t.
+void aplicar_registro(char* registro, void* dato) {
+	clinica_t* clinica = dato;
+	char tipo = registro[0];
+	if (tipo == '\0' || registro[1] != ':') return;
+	char* primero = registro + 2;
+	char* segundo = strchr(primero, ',');
+	if (!segundo) return;
+	*segundo++ = '\0';
+	char* fin;
+	if (tipo == REGISTRO_ENCOLADO) {
+		unsigned long long total = strtoull(primero, &fin, 10);
+		char* especialidad = strchr(segundo, ',');
+		if (*fin != '\0' || !especialidad) return;
+		*especialidad++ = '\0';
+		uint32_t id_especialidad = clinica_buscar_especialidad(clinica, especialidad);
+		uint32_t paciente = id_especialidad != SIN_ID ? paciente_recuperado(clinica, segundo, total) : SIN_ID;
+		if (paciente != SIN_ID) encolar_en_lista(clinica, paciente, id_especialidad);
+	}
+	else if (tipo == REGISTRO_ATENCION) {
+		uint32_t especialidad = clinica_buscar_especialidad(clinica, segundo);
+		uint32_t doctor = clinica_buscar_doctor(clinica, primero);
+		// Aunque el doctor ya no exista, el paciente salió de la lista
+		bool atendido = especialidad != SIN_ID && desencolar_de_lista(clinica, especialidad) != SIN_ID;
+		if (atendido && doctor != SIN_ID) clinica->doctores.cant_atendidos[doctor]++;
+	}
+	else if (tipo == REGISTRO_CANTIDAD) {
+		long cantidad = strtol(primero, &fin, 10);
+		uint32_t doctor = clinica_buscar_doctor(clinica, segundo);
+		if (*fin == '\0' && cantidad >= 0 && cantidad <= INT_MAX && doctor != SIN_ID) clinica->doctores.cant_atendidos[doctor] = (int) cantidad;
+	}
+}
+
+// Reemplaza la bitácora por una instantánea de las listas de espera y los
+// pacientes atendidos. Si no se puede, la bitácora sigue creciendo.
+void tomar_instantanea(clinica_t* clinica) {
+	salida_t* registros = bitacora_empezar_instantanea(clinica->bitacora);
+	if (!registros) return;
+	const pacientes_t* pacientes = &clinica->pacientes;
+	const especialidades_t* especialidades = &clinica->especialidades;
+	for (size_t i = 0; i < especialidades->cantidad; i++) {
+		if (!especialidades->lista_de_espera[i]) continue;
+		size_t cantidad;
+		const uint32_t* en_espera = heap_ids_elementos(especialidades->lista_de_espera[i], &cantidad);
+		for (size_t j = 0; j < cantidad; j++) {
+			uint32_t paciente = en_espera[j];
+			salida_formato(registros, "E:%zu,%s,%s\n", (size_t) pacientes->total_contribuciones[paciente], pacientes->nombre[paciente], especialidades->nombre[i]);
+		}
+	}
+	// Los doctores borrados al recargar quedan sin especialidad, y no se guardan
+	const doctores_t* doctores = &clinica->doctores;
+	for (uint32_t doctor = 0; doctor < doctores->cantidad; doctor++) {
+		if (doctores->cant_atendidos[doctor] > 0 && doctores->especialidad[doctor] != SIN_ID)
+			salida_formato(registros, "C:%d,%s\n", doctores->cant_atendidos[doctor], doctores->nombre[doctor]);
+	}
+	bitacora_terminar_instantanea(clinica->bitacora);
+}
+
+// Escribe en el disco los cambios registrados desde la última vez, y toma
+// una instantánea si conviene. Si falla, deja de registrar los cambios.
+void sincronizar_bitacora(clinica_t* clinica) {
+	if (!clinica->bitacora) return;
+	if (!bitacora_sincronizar(clinica->bitacora)) {
+		fprintf(stderr, EBITACORA_ESCRITURA);
+		bitacora_cerrar(clinica->bitacora);
+		clinica->bitacora = NULL;
+		return;
+	}
+	if (bitacora_conviene_instantanea(clinica->bitacora)) tomar_instantanea(clinica);
+}
+
+// Sincroniza la bitácora y vacía la salida del catálogo, para que no se
+// muestre ningún resultado antes de que su cambio esté en el disco. Se usa
+// como csv_flujo_t.antes_de_leer.
+void vaciar_salida(void* clinica) {
+	sincronizar_bitacora(clinica);
+	salida_vaciar(&((clinica_t*) clinica)->salida);
+}
+
+bool clinica_abrir_bitacora(clinica_t* clinica, const char* ruta) {
+	clinica->bitacora = bitacora_abrir(ruta, aplicar_registro, clinica);
+	return clinica->bitacora != NULL;
+}
+
+/***********************************
+ *       FUNCIONES PRINCIPALES     *
+ ***********************************/
+
+bool clinica_cargar_doctores(clinica_t* clinica, char* archivo_doctores, csv_mapa_t* csv_doctores, size_t hilos) {
+	// Cargo el archivo en memoria (falla si no existe)
+	csv_doctores->delim = ',';
+	if (!csv_mapa_abrir(csv_doctores, archivo_doctores)) return false;
+	return cargar_csv(archivo_doctores, csv_doctores, hilos, leer_registro_doctor, guardar_doctor, clinica);
+}
+
+bool clinica_cargar_pacientes(clinica_t* clinica, char* archivo_pacientes, csv_mapa_t* csv_pacientes, size_t hilos) {
+	// Cargo el archivo en memoria (falla si no existe)
+	csv_pacientes->delim = ',';
+	if (!csv_mapa_abrir(csv_pacientes, archivo_pacientes)) return false;
+	return cargar_csv(archivo_pacientes, csv_pacientes, hilos, leer_registro_paciente, guardar_paciente, clinica);
+}
+
+// Indexa sólo las líneas de pacientes con un total de contribuciones válido,
+// e informa las demás igual que la carga completa.
+bool indexar_linea_paciente(size_t linea, csv_campo_t nombre, csv_campo_t total_contribuciones, void* archivo) {
+	unsigned long long total;
+	if (csv_campo_numero(total_contribuciones, &total)) return true;
+	fprintf(stderr, EINVAL_LINEA, (const char*) archivo, linea, total_contribuciones.inicio);
+	return false;
+}
+
+bool clinica_indexar_pacientes(clinica_t* clinica, char* archivo_pacientes, const char* archivo_indice) {
+	clinica->indice_pacientes = indice_csv_abrir(archivo_indice, archivo_pacientes, ',');
+	if (clinica->indice_pacientes) return true;
+	clinica->indice_pacientes = indice_csv_crear(archivo_pacientes, ',', indexar_linea_paciente, archivo_pacientes);
+	if (!clinica->indice_pacientes) return false;
+	// Si no se puede guardar, se vuelve a armar la próxima vez
+	indice_csv_guardar(clinica->indice_pacientes, archivo_indice);
+	return true;
+}
+
+// Encola al paciente en la lista de espera de la especialidad, e informa
+// el resultado en 'salida'. Sólo modifica la lista de espera de la
+// especialidad, y (atómicamente) las veces que está encolado el paciente.
+// Post: Devuelve false si no hubo memoria (y no se informa nada).
+bool encolar_paciente(clinica_t* clinica, uint32_t paciente, uint32_t especialidad, salida_t* salida) {
+	if (!encolar_en_lista(clinica, paciente, especialidad)) return false;
+	salida_formato(salida, PACIENTE_ENCOLADO, clinica->pacientes.nombre[paciente]);
+	salida_formato(salida, NUM_PACIENTES_ESPERAN, heap_ids_cantidad(clinica->especialidades.lista_de_espera[especialidad]), clinica->especialidades.nombre[especialidad]);
+	return true;
+}
+
+// El doctor atiende al siguiente paciente de la lista de espera de su
+// especialidad, y se informa el resultado en 'salida'. Sólo modifica esa
+// lista de espera, los pacientes atendidos por el doctor, y (atómicamente)
+// las veces que está encolado el paciente.
+// Post: Devuelve false si no había pacientes en espera.
+bool atender_paciente(clinica_t* clinica, uint32_t doctor, salida_t* salida) {
+	uint32_t especialidad = clinica->doctores.especialidad[doctor];
+	uint32_t paciente = desencolar_de_lista(clinica, especialidad);
+	if (paciente == SIN_ID) {
+		salida_cadena(salida, CERO_PACIENTES_ESPERAN);
+		return false;
+	}
+	clinica->doctores.cant_atendidos[doctor]++;
+	salida_formato(salida, PACIENTE_ATENDIDO, clinica->pacientes.nombre[paciente]);
+	salida_formato(salida, NUM_PACIENTES_ESPERAN, heap_ids_cantidad(clinica->especialidades.lista_de_espera[especialidad]), clinica->especialidades.nombre[especialidad]);
+	return true;
 }
 
 // Función que permite solicitar un turno para un paciente para una determinada especialidad.
-// Pre: Los hashes de pacientes y especialidades existen.
+// Pre: El catálogo existe.
 // Post: Se encola un paciente en el heap de la especialidad ingresada por teclado, según su total contribuído.
 //
 // Salida por pantalla:
 //
 // Paciente NOMBRE_PACIENTE encolado
 // N paciente(s) en espera para NOMBRE_ESPECIALIDAD
-void pedir_turno(parametros_t* parametros, hash_t* hash_pacientes, hash_t* hash_especialidades) {
-	paciente_t* paciente = hash_obtener(hash_pacientes, parametros->param1);
-	if (!paciente) {
-		printf(ENOENT_PACIENTE, parametros->param1);
+void pedir_turno(parametros_t* parametros, clinica_t* clinica) {
+	uint32_t paciente = clinica_obtener_paciente(clinica, parametros->param1);
+	if (paciente == SIN_ID) {
+		salida_formato(&clinica->salida, ENOENT_PACIENTE, parametros->param1);
+		contar_error(clinica, ERROR_PACIENTE);
 		return;
 	}
-	especialidad_t* especialidad = hash_obtener(hash_especialidades, parametros->param2);
-	if (!especialidad) {
-		printf(ENOENT_ESPECIALIDAD, parametros->param2);
+	uint32_t especialidad = clinica_buscar_especialidad(clinica, parametros->param2);
+	if (especialidad == SIN_ID) {
+		salida_formato(&clinica->salida, ENOENT_ESPECIALIDAD, parametros->param2);
+		contar_error(clinica, ERROR_ESPECIALIDAD);
 		return;
 	}
-	if (heap_encolar(especialidad->lista_de_espera, paciente)) {
-		printf(PACIENTE_ENCOLADO, parametros->param1);
-		printf(NUM_PACIENTES_ESPERAN, heap_cantidad(especialidad->lista_de_espera), especialidad->nombre);
-	}
-	return;
+	if (encolar_paciente(clinica, paciente, especialidad, &clinica->salida)) registrar_encolado(clinica, paciente, especialidad);
 }
 
 // Función que permite atender a un médico atender al paciente que esté primero en la cola de prioridad de su especialidad.
-// Pre: Los hashes de doctores y especialidades existen.
+// Pre: El catálogo existe.
 // Post: El paciente es desencolado
 //
 // Salida por pantalla:
 //
 // Se atiende a NOMBRE_PACIENTE
 // N paciente(s) en espera para NOMBRE_ESPECIALIDAD
-void atender_siguiente(parametros_t* parametros, hash_t* hash_doctores, hash_t* hash_especialidades) {
-	doctor_t* doctor = hash_obtener(hash_doctores, parametros->param1);
-	if (!doctor) {
-		printf(ENOENT_DOCTOR, parametros->param1);
+void atender_siguiente(parametros_t* parametros, clinica_t* clinica) {
+	uint32_t doctor = clinica_buscar_doctor(clinica, parametros->param1);
+	if (doctor == SIN_ID) {
+		salida_formato(&clinica->salida, ENOENT_DOCTOR, parametros->param1);
+		contar_error(clinica, ERROR_DOCTOR);
+		return;
+	}
+	if (atender_paciente(clinica, doctor, &clinica->salida)) registrar_atencion(clinica, doctor, clinica->doctores.especialidad[doctor]);
+}
+
+// Función que vuelve a leer el archivo de doctores o de pacientes (según el parámetro) en segundo plano.
+// Pre: El catálogo existe, y el parámetro DOCTORES|PACIENTES ya se interpretó.
+// Post: Los cambios del archivo se aplican entre dos comandos posteriores, al terminar de leerlo,
+// conservando las listas de espera y los pacientes atendidos por cada doctor.
+//
+// Salida por pantalla:
+//
+// Recargando DOCTORES|PACIENTES
+//
+// y luego, al aplicar los cambios:
+//
+// DOCTORES|PACIENTES recargados: A agregado(s), M modificado(s), B borrado(s)
+void recargar(parametros_t* parametros, clinica_t* clinica) {
+	tipo_recarga_t tipo = parametros->archivo;
+	if (clinica->imagen) {
+		salida_cadena(&clinica->salida, ERECARGA_CATALOGO);
 		return;
 	}
-	especialidad_t* especialidad = hash_obtener(hash_especialidades, doctor->especialidad);
-	if (!heap_cantidad(especialidad->lista_de_espera)){
-		printf(CERO_PACIENTES_ESPERAN);
+	// Sin los pacientes cargados no hay con qué comparar el archivo
+	if (tipo == RECARGA_PACIENTES && clinica->indice_pacientes) {
+		salida_cadena(&clinica->salida, ERECARGA_INDICE);
 		return;
 	}
-	paciente_t* paciente = heap_desencolar(especialidad->lista_de_espera);
-	doctor->cant_atendidos++;
-	printf(PACIENTE_ATENDIDO, paciente->nombre);
-	printf(NUM_PACIENTES_ESPERAN, heap_cantidad(especialidad->lista_de_espera), especialidad->nombre);
-	return;
+	// Si ya se estaba recargando el mismo archivo, primero se aplica esa recarga
+	recarga_terminar(clinica, tipo, true);
+	
+	recarga_t* recarga = calloc(1, sizeof(recarga_t));
+	if (!recarga) {
+		salida_formato(&clinica->salida, ERECARGA, clinica->archivos[tipo]);
+		return;
+	}
+	recarga->tipo = tipo;
+	recarga->clinica = clinica;
+	pthread_mutex_init(&recarga->mutex, NULL);
+	clinica->recargas[tipo] = recarga;
+	salida_formato(&clinica->salida, RECARGA_EN_CURSO, parametros->param1);
+	// Si no se puede lanzar el hilo, se lee ahora y se aplica al terminar el comando
+	recarga->lanzada = pthread_create(&recarga->hilo, NULL, recargar_en_segundo_plano, recarga) == 0;
+	if (!recarga->lanzada) recargar_en_segundo_plano(recarga);
 }
 
 // Función que imprime la lista de doctores en orden alfabético, junto con su especialidad y el número de pacientes que atendieron desde que arrancó el sistema.
-// Pre: El hash de doctores existe.
+// Pre: El catálogo existe.
 // Post: Ninguna.
 //
 // Salida por pantalla:
@@ -329,65 +1484,899 @@ void atender_siguiente(parametros_t* parametros, hash_t* hash_doctores, hash_t*
 // 2: NOMBRE, especialidad ESPECIALIDAD, Y paciente(s) atendido(s)
 // ...
 // N: NOMBRE, especialidad ESPECIALIDAD, Z paciente(s) atendido(s)
-void mostrar_informe(hash_t* hash_doctores) {
-	printf(NUM_DOCTORES, hash_cantidad(hash_doctores));	
+void mostrar_informe(clinica_t* clinica) {
+	const doctores_t* doctores = &clinica->doctores;
+	const especialidades_t* especialidades = &clinica->especialidades;
+	// La imagen ya trae a los doctores en orden alfabético
+	if (clinica->imagen) {
+		const catalogo_t* imagen = clinica->imagen;
+		salida_formato(&clinica->salida, NUM_DOCTORES, imagen->cantidad[CATALOGO_DOCTORES]);
+		for (size_t i = 0; i < imagen->cantidad[CATALOGO_DOCTORES]; i++) {
+			uint32_t doctor = imagen->orden_doctores[i];
+			salida_formato(&clinica->salida, INFORME_DOCTOR, (unsigned int) i + 1, doctores->nombre[doctor], especialidades->nombre[doctores->especialidad[doctor]], doctores->cant_atendidos[doctor]);
+		}
+		return;
+	}
+	hash_t* hash_doctores = clinica->hash_doctores;
+	salida_formato(&clinica->salida, NUM_DOCTORES, hash_cantidad(hash_doctores));	
 	heap_t* doctores_orden = crear_heap_doctores(hash_doctores);
 	if (!doctores_orden) return;
 	unsigned int i = 1;
 	while (!heap_esta_vacio(doctores_orden)){
-		doctor_t* doctor = hash_obtener(hash_doctores, heap_desencolar(doctores_orden));
-		printf(INFORME_DOCTOR, i, doctor->nombre, doctor->especialidad, doctor->cant_atendidos);
+		uint32_t doctor = indice_obtener(hash_doctores, heap_desencolar(doctores_orden));
+		salida_formato(&clinica->salida, INFORME_DOCTOR, i, doctores->nombre[doctor], especialidades->nombre[doctores->especialidad[doctor]], doctores->cant_atendidos[doctor]);
 		i++;
 	}
 	heap_destruir(doctores_orden, NULL);
 	return;
 }
 
-/* Funcion en donde se ejecuta el programa en si. Recibe los hashes
- * generados en el main, y queda a la espera de comandos. En caso
- * de fallar o no recibir comando alguno (ENTER), finaliza la funcion
- * destruyendo los hashes pasados.
+/***********************************
+ *      DESPACHO DE COMANDOS       *
+ ***********************************/
+
+/* Cada comando está definido en la tabla COMANDOS, con la función que lo
+ * ejecuta y el tipo de cada uno de sus parámetros. El nombre del comando se
+ * busca con un switch sobre su largo, cuyos casos se calculan de los propios
+ * nombres: si se agrega un comando del mismo largo que otro, el switch no
+ * compila, y hay que distinguirlos además por su primer carácter.
+ *
+ * Antes de ejecutar el comando se interpretan sus parámetros, y si alguno no
+ * es válido se informa que el comando no existe. La cantidad de parámetros
+ * no se verifica: los que faltan quedan vacíos, y los que sobran se ignoran.
  */
-void ejecutar_programa(hash_t* hash_doctores, hash_t* hash_pacientes, hash_t* hash_especialidades){
+
+#define MAX_PARAMETROS 2
+
+typedef enum tipo_parametro {
+	PARAM_NINGUNO,
+	PARAM_NOMBRE,      // Nombre de un paciente, doctor o especialidad
+	PARAM_INFORME,     // DOCTORES o METRICAS
+	PARAM_ARCHIVO      // DOCTORES o PACIENTES
+} tipo_parametro_t;
+
+typedef struct definicion_comando {
+	const char* nombre;
+	tipo_parametro_t parametros[MAX_PARAMETROS];
+	void (*ejecutar)(parametros_t* parametros, clinica_t* clinica);
+} definicion_comando_t;
+
+// INFORME:DOCTORES o INFORME:METRICAS, con la firma de los demás comandos.
+void informe(parametros_t* parametros, clinica_t* clinica) {
+	if (parametros->metricas) mostrar_metricas(clinica);
+	else mostrar_informe(clinica);
+}
+
+static const definicion_comando_t COMANDOS[CANT_COMANDOS] = {
+	[CMD_PEDIR_TURNO] = {NOMBRE_PEDIR_TURNO, {PARAM_NOMBRE, PARAM_NOMBRE}, pedir_turno},
+	[CMD_ATENDER_SIGUIENTE] = {NOMBRE_ATENDER_SIGUIENTE, {PARAM_NOMBRE, PARAM_NINGUNO}, atender_siguiente},
+	[CMD_INFORME] = {NOMBRE_INFORME, {PARAM_INFORME, PARAM_NINGUNO}, informe},
+	[CMD_RECARGAR] = {NOMBRE_RECARGAR, {PARAM_ARCHIVO, PARAM_NINGUNO}, recargar},
+};
+
+// Busca la definición de un comando por su nombre.
+// Post: Devuelve la definición, NULL si el comando no existe.
+const definicion_comando_t* buscar_comando(const char* nombre) {
+	size_t largo = strlen(nombre);
+	id_comando_t id;
+	switch (largo) {
+		case sizeof(NOMBRE_PEDIR_TURNO) - 1: id = CMD_PEDIR_TURNO; break;
+		case sizeof(NOMBRE_ATENDER_SIGUIENTE) - 1: id = CMD_ATENDER_SIGUIENTE; break;
+		case sizeof(NOMBRE_INFORME) - 1: id = CMD_INFORME; break;
+		case sizeof(NOMBRE_RECARGAR) - 1: id = CMD_RECARGAR; break;
+		default: return NULL;
+	}
+	return memcmp(nombre, COMANDOS[id].nombre, largo) == 0 ? &COMANDOS[id] : NULL;
+}
+
+// Interpreta los parámetros de un comando según los tipos de su definición.
+// Post: Devuelve false si alguno no es válido.
+bool interpretar_parametros(const definicion_comando_t* definicion, parametros_t* parametros) {
+	const char* valores[MAX_PARAMETROS] = {parametros->param1, parametros->param2};
+	for (size_t i = 0; i < MAX_PARAMETROS; i++) {
+		tipo_parametro_t tipo = definicion->parametros[i];
+		if (tipo == PARAM_INFORME) {
+			parametros->metricas = strcmp(valores[i], "METRICAS") == 0;
+			if (!parametros->metricas && strcmp(valores[i], "DOCTORES") != 0) return false;
+#ifdef SIN_METRICAS
+			if (parametros->metricas) return false;
+#endif
+		}
+		else if (tipo == PARAM_ARCHIVO) {
+			if (strcmp(valores[i], "DOCTORES") == 0) parametros->archivo = RECARGA_DOCTORES;
+			else if (strcmp(valores[i], "PACIENTES") == 0) parametros->archivo = RECARGA_PACIENTES;
+			else return false;
+		}
+	}
+	return true;
+}
+
+// Ejecuta un comando leído, o informa que no existe.
+// Pre: El comando no es NULL.
+void ejecutar_comando(parametros_t* parametros, clinica_t* clinica) {
+	const definicion_comando_t* definicion = buscar_comando(parametros->comando);
+	if (!definicion || !interpretar_parametros(definicion, parametros)) {
+		salida_formato(&clinica->salida, ENOENT_CMD, parametros->comando, parametros->param1);
+		contar_error(clinica, ERROR_COMANDO);
+		return;
+	}
+	uint64_t inicio = reloj_metricas();
+	definicion->ejecutar(parametros, clinica);
+	medir_comando(clinica, (id_comando_t) (definicion - COMANDOS), reloj_metricas() - inicio);
+}
+
+// Ejecuta el comando de una línea leída con obtener_parametros, o informa
+// que la línea no tenía el formato de un comando.
+void ejecutar_linea(parametros_t* parametros, clinica_t* clinica) {
+	if (parametros->invalido) {
+		salida_cadena(&clinica->salida, EINVAL_CMD);
+		contar_error(clinica, ERROR_LINEA);
+	}
+	else if (parametros->comando) ejecutar_comando(parametros, clinica);
+}
+
+/***********************************
+ *       EJECUCIÓN EN ETAPAS       *
+ ***********************************/
+
+/* Con --etapas, los comandos pasan por tres hilos que trabajan a la vez:
+ * uno lee la entrada y divide cada línea en el comando y sus parámetros, el
+ * principal ejecuta los comandos en el orden en que llegaron (es el único
+ * que modifica el catálogo), y otro escribe la salida (ver salida_en_hilo).
+ *
+ * Las líneas leídas pasan al hilo principal en los bloques de un anillo
+ * (ver anillo.h): cada una se copia en el bloque como un encabezado
+ * linea_leida_t seguido del comando y sus dos parámetros, como cadenas
+ * terminadas en '\0'. Un bloque se publica al llegar a TAM_BLOQUE_COMANDOS
+ * bytes, o antes de volver a leer la entrada, que puede bloquearse: así los
+ * comandos que se escriben de a uno se ejecutan sin esperar a los
+ * siguientes. El hilo principal vacía la salida después de cada bloque.
+ */
+
+#define BLOQUES_COMANDOS 4
+#define TAM_BLOQUE_COMANDOS 65536
+
+typedef struct linea_leida {
+	size_t largo;        // Bytes que ocupa en el bloque, con sus cadenas
+	bool invalida;       // Como parametros_t.invalido
+	bool con_comando;    // Si es false, no le sigue ninguna cadena
+} linea_leida_t;
+
+// Etapa de lectura: el anillo en el que publica, y el bloque que está llenando.
+typedef struct etapa_lectura {
+	anillo_t* comandos;
+	anillo_bloque_t* bloque;     // NULL si no tiene uno reservado
+} etapa_lectura_t;
+
+// Publica el bloque que está llenando la etapa de lectura, si tiene uno.
+// Se usa además como csv_flujo_t.antes_de_leer.
+void publicar_comandos(void* dato) {
+	etapa_lectura_t* lectura = dato;
+	if (!lectura->bloque) return;
+	anillo_publicar(lectura->comandos);
+	lectura->bloque = NULL;
+}
+
+// Copia una línea leída con obtener_parametros en el bloque de la etapa de
+// lectura, y lo publica si se llenó.
+// Post: Devuelve false si no hubo memoria.
+bool guardar_linea(etapa_lectura_t* lectura, const parametros_t* parametros) {
+	const char* cadenas[] = {parametros->comando, parametros->param1, parametros->param2};
+	size_t largos[] = {0, 0, 0};
+	size_t largo = sizeof(linea_leida_t);
+	for (size_t i = 0; parametros->comando && i < 3; i++) {
+		largos[i] = strlen(cadenas[i]) + 1;
+		largo += largos[i];
+	}
+	// Para que el encabezado siguiente quede alineado
+	largo = (largo + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+	
+	if (!lectura->bloque) lectura->bloque = anillo_reservar(lectura->comandos);
+	anillo_bloque_t* bloque = lectura->bloque;
+	if (bloque->tam - bloque->largo < largo) {
+		size_t tam = bloque->largo + largo > TAM_BLOQUE_COMANDOS ? bloque->largo + largo : TAM_BLOQUE_COMANDOS;
+		char* datos = realloc(bloque->datos, tam);
+		if (!datos) return false;
+		bloque->datos = datos;
+		bloque->tam = tam;
+	}
+	char* destino = bloque->datos + bloque->largo;
+	*(linea_leida_t*) destino = (linea_leida_t) {.largo = largo, .invalida = parametros->invalido, .con_comando = parametros->comando != NULL};
+	destino += sizeof(linea_leida_t);
+	for (size_t i = 0; parametros->comando && i < 3; i++) {
+		memcpy(destino, cadenas[i], largos[i]);
+		destino += largos[i];
+	}
+	bloque->largo += largo;
+	if (bloque->largo >= TAM_BLOQUE_COMANDOS) publicar_comandos(lectura);
+	return true;
+}
+
+// Hilo de la etapa de lectura: lee la entrada hasta el final, y cierra el anillo.
+void* leer_comandos(void* dato) {
+	etapa_lectura_t* lectura = dato;
+	csv_flujo_t entrada = {.delim = ':', .fd = STDIN_FILENO, .antes_de_leer = publicar_comandos, .extra = lectura};
+	parametros_t parametros;
+	// Sin memoria la entrada termina ahí, como al ejecutar en un solo hilo
+	while (obtener_parametros(&entrada, &parametros) && guardar_linea(lectura, &parametros));
+	publicar_comandos(lectura);
+	anillo_cerrar(lectura->comandos);
+	csv_flujo_terminar(&entrada);
+	return NULL;
+}
+
+// Lee una línea guardada con guardar_linea. Los parámetros apuntan al bloque.
+// Post: Devuelve los bytes que ocupa la línea en el bloque.
+size_t leer_linea(char* datos, parametros_t* parametros) {
+	const linea_leida_t* linea = (const linea_leida_t*) datos;
+	parametros->comando = NULL;
+	parametros->param1 = NULL;
+	parametros->param2 = NULL;
+	parametros->invalido = linea->invalida;
+	if (linea->con_comando) {
+		parametros->comando = datos + sizeof(linea_leida_t);
+		parametros->param1 = parametros->comando + strlen(parametros->comando) + 1;
+		parametros->param2 = parametros->param1 + strlen(parametros->param1) + 1;
+	}
+	return linea->largo;
+}
+
+// Ejecuta los comandos de la entrada en tres etapas, cada una en su hilo.
+// Post: Devuelve false si no se pudo lanzar la etapa de lectura (y no se
+// leyó nada de la entrada).
+bool ejecutar_en_etapas(clinica_t* clinica) {
+	etapa_lectura_t lectura = {.comandos = anillo_crear(BLOQUES_COMANDOS)};
+	if (!lectura.comandos) return false;
+	pthread_t hilo_lectura;
+	if (pthread_create(&hilo_lectura, NULL, leer_comandos, &lectura) != 0) {
+		anillo_destruir(lectura.comandos);
+		return false;
+	}
+	// Si no se puede lanzar, la salida se escribe desde este hilo
+	salida_en_hilo(&clinica->salida);
+	
+	anillo_bloque_t* bloque;
+	while ((bloque = anillo_tomar(lectura.comandos))) {
+		for (size_t i = 0; i < bloque->largo; ) {
+			parametros_t parametros;
+			i += leer_linea(bloque->datos + i, &parametros);
+			// Los cambios de las recargas se aplican siempre entre dos comandos
+			aplicar_recargas(clinica, false);
+			ejecutar_linea(&parametros, clinica);
+		}
+		anillo_devolver(lectura.comandos);
+		sincronizar_bitacora(clinica);
+		salida_vaciar(&clinica->salida);
+	}
+	aplicar_recargas(clinica, true);
+	pthread_join(hilo_lectura, NULL);
+	anillo_destruir(lectura.comandos);
+	sincronizar_bitacora(clinica);
+	salida_terminar(&clinica->salida);
+	return true;
+}
+
+/***********************************
+ *       EJECUCIÓN REPARTIDA       *
+ ***********************************/
+
+/* Con --repartir N, las especialidades se reparten entre N hilos (hasta
+ * MAX_HILOS) trabajadores: la especialidad e es del trabajador e % N, que
+ * es el único que modifica su lista de espera y los pacientes atendidos por
+ * sus doctores, sin locks (ver encolar_paciente y atender_paciente). Lo
+ * único que escriben varios trabajadores es la cantidad de listas de espera
+ * en las que está cada paciente, que se actualiza atómicamente; el resto
+ * del catálogo sólo lo leen.
+ *
+ * El hilo principal lee los comandos, y agrega cada PEDIR_TURNO y cada
+ * ATENDER_SIGUIENTE a las tareas de la tanda en curso, en orden. Una tanda
+ * se ejecuta en dos fases, con todos los trabajadores a la vez:
+ *
+ * 1. Cada trabajador busca los ids de los nombres de un tramo de las
+ *    tareas, y anota qué trabajador ejecuta cada una: el de su
+ *    especialidad, o cualquiera si algún nombre no existe (sólo se informa
+ *    el error).
+ * 2. Cada trabajador ejecuta sus tareas en el orden de la tanda, y escribe
+ *    la salida en su propio buffer, anotando dónde termina la de cada una.
+ *
+ * Al terminar, el hilo principal copia la salida de cada tarea a la salida
+ * del catálogo, en el orden de la entrada.
+ *
+ * Una tanda se ejecuta antes de volver a leer la entrada, de modo que los
+ * nombres de sus tareas siguen apuntando al buffer de la entrada, y antes
+ * de cualquier otro comando, que se ejecuta en el hilo principal con los
+ * trabajadores detenidos. Las recargas se aplican también entre dos tandas.
+ */
+
+// Comando repartido a los trabajadores.
+typedef struct tarea {
+	id_comando_t comando;         // CMD_PEDIR_TURNO o CMD_ATENDER_SIGUIENTE
+	const char* nombre;           // Paciente o doctor
+	const char* especialidad;     // Sólo en un PEDIR_TURNO
+	uint32_t id;                  // Del paciente o doctor, SIN_ID si no existe
+	uint32_t id_especialidad;     // SIN_ID si no existe
+	size_t trabajador;            // Número del trabajador que la ejecuta
+	size_t fin;                   // Fin de su salida en la salida del trabajador
+	bool cambio;                  // Si modificó una lista de espera, para registrarlo
+	uint64_t duracion;            // Lo que tardó en ejecutarse, para las métricas
+} tarea_t;
+
+typedef enum fase {
+	FASE_BUSCAR,
+	FASE_EJECUTAR
+} fase_t;
+
+typedef struct trabajador {
+	struct reparto* reparto;
+	size_t numero;
+	pthread_t hilo;
+	salida_t salida;         // En memoria
+	size_t copiado;          // Parte de la salida que ya se copió
+} trabajador_t;
+
+typedef struct reparto {
+	clinica_t* clinica;
+	trabajador_t trabajadores[MAX_HILOS];
+	size_t cant_trabajadores;
+	tarea_t* tareas;         // Tareas de la tanda, en el orden de la entrada
+	size_t cantidad;
+	size_t capacidad;
+	pthread_mutex_t mutex;
+	pthread_cond_t lanzada;
+	pthread_cond_t terminada;
+	fase_t fase;
+	size_t lanzadas;         // Fases lanzadas
+	size_t pendientes;       // Trabajadores que no terminaron la última fase
+	bool fin;
+} reparto_t;
+
+// Busca los ids de los nombres del tramo de tareas de un trabajador, y
+// anota quién ejecuta cada una.
+void buscar_ids(trabajador_t* trabajador) {
+	reparto_t* reparto = trabajador->reparto;
+	const clinica_t* clinica = reparto->clinica;
+	size_t cant = reparto->cant_trabajadores;
+	size_t fin = reparto->cantidad * (trabajador->numero + 1) / cant;
+	for (size_t i = reparto->cantidad * trabajador->numero / cant; i < fin; i++) {
+		tarea_t* tarea = &reparto->tareas[i];
+		if (tarea->comando == CMD_PEDIR_TURNO) {
+			tarea->id = clinica_buscar_paciente(clinica, tarea->nombre);
+			tarea->id_especialidad = clinica_buscar_especialidad(clinica, tarea->especialidad);
+		}
+		else {
+			tarea->id = clinica_buscar_doctor(clinica, tarea->nombre);
+			tarea->id_especialidad = tarea->id != SIN_ID ? clinica->doctores.especialidad[tarea->id] : SIN_ID;
+		}
+		bool existen = tarea->id != SIN_ID && tarea->id_especialidad != SIN_ID;
+		tarea->trabajador = (existen ? tarea->id_especialidad : i) % cant;
+	}
+}
+
+// Ejecuta las tareas de la tanda que son del trabajador.
+void ejecutar_tareas(trabajador_t* trabajador) {
+	reparto_t* reparto = trabajador->reparto;
+	clinica_t* clinica = reparto->clinica;
+	salida_t* salida = &trabajador->salida;
+	salida_descartar(salida);
+	for (size_t i = 0; i < reparto->cantidad; i++) {
+		tarea_t* tarea = &reparto->tareas[i];
+		if (tarea->trabajador != trabajador->numero) continue;
+		uint64_t inicio = reloj_metricas();
+		// Los mismos mensajes, en el mismo orden, que pedir_turno y atender_siguiente
+		if (tarea->comando == CMD_PEDIR_TURNO) {
+			if (tarea->id == SIN_ID) salida_formato(salida, ENOENT_PACIENTE, tarea->nombre);
+			else if (tarea->id_especialidad == SIN_ID) salida_formato(salida, ENOENT_ESPECIALIDAD, tarea->especialidad);
+			else tarea->cambio = encolar_paciente(clinica, tarea->id, tarea->id_especialidad, salida);
+		}
+		else if (tarea->id == SIN_ID) salida_formato(salida, ENOENT_DOCTOR, tarea->nombre);
+		else tarea->cambio = atender_paciente(clinica, tarea->id, salida);
+		tarea->duracion = reloj_metricas() - inicio;
+		salida_datos(salida, &tarea->fin);
+	}
+}
+
+// Hilo de un trabajador: ejecuta cada fase que se lanza, hasta el fin.
+void* trabajar(void* dato) {
+	trabajador_t* trabajador = dato;
+	reparto_t* reparto = trabajador->reparto;
+	size_t lanzadas = 0;
+	while (true) {
+		pthread_mutex_lock(&reparto->mutex);
+		while (reparto->lanzadas == lanzadas && !reparto->fin) pthread_cond_wait(&reparto->lanzada, &reparto->mutex);
+		bool fin = reparto->lanzadas == lanzadas;
+		lanzadas = reparto->lanzadas;
+		fase_t fase = reparto->fase;
+		pthread_mutex_unlock(&reparto->mutex);
+		if (fin) return NULL;
+		
+		if (fase == FASE_BUSCAR) buscar_ids(trabajador);
+		else ejecutar_tareas(trabajador);
+		pthread_mutex_lock(&reparto->mutex);
+		if (--reparto->pendientes == 0) pthread_cond_signal(&reparto->terminada);
+		pthread_mutex_unlock(&reparto->mutex);
+	}
+}
+
+// Lanza una fase en todos los trabajadores, y espera a que la terminen.
+void ejecutar_fase(reparto_t* reparto, fase_t fase) {
+	pthread_mutex_lock(&reparto->mutex);
+	reparto->fase = fase;
+	reparto->lanzadas++;
+	reparto->pendientes = reparto->cant_trabajadores;
+	pthread_cond_broadcast(&reparto->lanzada);
+	while (reparto->pendientes > 0) pthread_cond_wait(&reparto->terminada, &reparto->mutex);
+	pthread_mutex_unlock(&reparto->mutex);
+}
+
+// Detiene a los trabajadores, y destruye el reparto.
+void reparto_destruir(reparto_t* reparto) {
+	pthread_mutex_lock(&reparto->mutex);
+	reparto->fin = true;
+	pthread_cond_broadcast(&reparto->lanzada);
+	pthread_mutex_unlock(&reparto->mutex);
+	for (size_t i = 0; i < reparto->cant_trabajadores; i++) {
+		pthread_join(reparto->trabajadores[i].hilo, NULL);
+		salida_terminar(&reparto->trabajadores[i].salida);
+	}
+	pthread_mutex_destroy(&reparto->mutex);
+	pthread_cond_destroy(&reparto->lanzada);
+	pthread_cond_destroy(&reparto->terminada);
+	free(reparto->tareas);
+	free(reparto);
+}
+
+// Crea el reparto, y lanza a sus trabajadores.
+// Post: Devuelve el reparto, NULL si no hubo memoria o no se pudo lanzar
+// ningún trabajador. Puede tener menos trabajadores que los pedidos.
+reparto_t* reparto_crear(clinica_t* clinica, size_t cant_trabajadores) {
+	reparto_t* reparto = calloc(1, sizeof(reparto_t));
+	if (!reparto) return NULL;
+	reparto->clinica = clinica;
+	pthread_mutex_init(&reparto->mutex, NULL);
+	pthread_cond_init(&reparto->lanzada, NULL);
+	pthread_cond_init(&reparto->terminada, NULL);
+	if (cant_trabajadores > MAX_HILOS) cant_trabajadores = MAX_HILOS;
+	for (size_t i = 0; i < cant_trabajadores; i++) {
+		trabajador_t* trabajador = &reparto->trabajadores[i];
+		trabajador->reparto = reparto;
+		trabajador->numero = i;
+		trabajador->salida.fd = SALIDA_MEMORIA;
+		if (pthread_create(&trabajador->hilo, NULL, trabajar, trabajador) != 0) break;
+		reparto->cant_trabajadores++;
+	}
+	if (!reparto->cant_trabajadores) {
+		reparto_destruir(reparto);
+		return NULL;
+	}
+	return reparto;
+}
+
+// Agrega la línea a las tareas de la tanda si es un PEDIR_TURNO o un
+// ATENDER_SIGUIENTE. Las líneas vacías se descartan.
+// Post: Devuelve false si hay que ejecutar la línea en el hilo principal.
+bool repartir_linea(reparto_t* reparto, parametros_t* parametros) {
+	if (!parametros->comando) return !parametros->invalido;
+	const definicion_comando_t* definicion = buscar_comando(parametros->comando);
+	if (definicion != &COMANDOS[CMD_PEDIR_TURNO] && definicion != &COMANDOS[CMD_ATENDER_SIGUIENTE]) return false;
+	id_comando_t comando = definicion == &COMANDOS[CMD_PEDIR_TURNO] ? CMD_PEDIR_TURNO : CMD_ATENDER_SIGUIENTE;
+	// Un paciente que se lee del índice se agrega al catálogo, y eso no
+	// puede hacerlo un trabajador
+	clinica_t* clinica = reparto->clinica;
+	if (comando == CMD_PEDIR_TURNO && clinica->indice_pacientes) clinica_obtener_paciente(clinica, parametros->param1);
+	
+	if (reparto->cantidad == reparto->capacidad) {
+		size_t capacidad = reparto->capacidad ? 2 * reparto->capacidad : 1024;
+		tarea_t* tareas = realloc(reparto->tareas, capacidad * sizeof(tarea_t));
+		if (!tareas) return false;
+		reparto->tareas = tareas;
+		reparto->capacidad = capacidad;
+	}
+	reparto->tareas[reparto->cantidad++] = (tarea_t) {.comando = comando, .nombre = parametros->param1, .especialidad = parametros->param2};
+	return true;
+}
+
+// Ejecuta la tanda de tareas, y copia sus salidas a la salida del catálogo
+// en el orden en que se leyeron. Los cambios se registran en la bitácora,
+// y las tareas en las métricas, desde el hilo principal y en ese mismo orden.
+void ejecutar_tanda(reparto_t* reparto) {
+	if (!reparto->cantidad) return;
+	ejecutar_fase(reparto, FASE_BUSCAR);
+	ejecutar_fase(reparto, FASE_EJECUTAR);
+	
+	clinica_t* clinica = reparto->clinica;
+	for (size_t i = 0; i < reparto->cantidad; i++) {
+		const tarea_t* tarea = &reparto->tareas[i];
+		if (tarea->cambio && tarea->comando == CMD_PEDIR_TURNO) registrar_encolado(clinica, tarea->id, tarea->id_especialidad);
+		else if (tarea->cambio) registrar_atencion(clinica, tarea->id, tarea->id_especialidad);
+		medir_comando(clinica, tarea->comando, tarea->duracion);
+		if (tarea->id == SIN_ID) contar_error(clinica, tarea->comando == CMD_PEDIR_TURNO ? ERROR_PACIENTE : ERROR_DOCTOR);
+		else if (tarea->id_especialidad == SIN_ID) contar_error(clinica, ERROR_ESPECIALIDAD);
+		trabajador_t* trabajador = &reparto->trabajadores[tarea->trabajador];
+		size_t largo;
+		const char* datos = salida_datos(&trabajador->salida, &largo);
+		salida_escribir(&clinica->salida, datos + trabajador->copiado, tarea->fin - trabajador->copiado);
+		trabajador->copiado = tarea->fin;
+	}
+	for (size_t i = 0; i < reparto->cant_trabajadores; i++) reparto->trabajadores[i].copiado = 0;
+	reparto->cantidad = 0;
+}
+
+// Ejecuta la tanda en curso antes de volver a leer la entrada, aplica las
+// recargas que terminaron, y vacía la salida. Se usa como csv_flujo_t.antes_de_leer.
+void terminar_tanda(void* reparto) {
+	ejecutar_tanda(reparto);
+	aplicar_recargas(((reparto_t*) reparto)->clinica, false);
+	vaciar_salida(((reparto_t*) reparto)->clinica);
+}
+
+// Ejecuta los comandos de la entrada repartiendo las especialidades entre
+// 'cant_trabajadores' hilos.
+// Post: Devuelve false si no se pudo lanzar ningún trabajador (y no se
+// leyó nada de la entrada).
+bool ejecutar_repartido(clinica_t* clinica, size_t cant_trabajadores) {
+	reparto_t* reparto = reparto_crear(clinica, cant_trabajadores);
+	if (!reparto) return false;
+	csv_flujo_t entrada = {.delim = ':', .fd = STDIN_FILENO, .antes_de_leer = terminar_tanda, .extra = reparto};
+	parametros_t parametros;
+	while (obtener_parametros(&entrada, &parametros)) {
+		if (repartir_linea(reparto, &parametros)) continue;
+		// Los demás comandos se ejecutan después de los ya repartidos
+		ejecutar_tanda(reparto);
+		aplicar_recargas(clinica, false);
+		ejecutar_linea(&parametros, clinica);
+	}
+	ejecutar_tanda(reparto);
+	aplicar_recargas(clinica, true);
+	csv_flujo_terminar(&entrada);
+	reparto_destruir(reparto);
+	vaciar_salida(clinica);
+	return true;
+}
+
+/***********************************
+ *            SERVIDOR             *
+ ***********************************/
+
+/* Con --servir RUTA, los comandos no se leen de la entrada estándar sino de
+ * los clientes que se conectan al socket RUTA (ver servidor.h), con el
+ * mismo formato de una línea por comando. La respuesta a cada comando se
+ * envía al cliente que lo mandó, terminada por una línea vacía; lo que no
+ * responde a ningún comando (los avisos de las recargas aplicadas) sale por
+ * la salida estándar.
+ * Los comandos de una ronda se ejecutan de a uno, en el hilo del servidor,
+ * y las recargas se aplican entre dos rondas.
+ */
+
+// Ejecuta una línea recibida por el servidor, y escribe la respuesta en la
+// de su conexión. Se usa como servidor_ejecutar_t.
+void atender_pedido(char* linea, size_t largo, salida_t* respuesta, void* dato) {
+	clinica_t* clinica = dato;
+	char *primero, *segundo;
+	csv_dividir(linea, largo, ':', &primero, &segundo);
+	parametros_t parametros;
+	guardar_parametros(primero, segundo, &parametros);
+	// Los comandos escriben en la salida del catálogo, que se cambia por la
+	// respuesta mientras se ejecuta
+	salida_t salida = clinica->salida;
+	clinica->salida = *respuesta;
+	ejecutar_linea(&parametros, clinica);
+	*respuesta = clinica->salida;
+	clinica->salida = salida;
+}
+
+// Aplica las recargas que terminaron, y vacía la salida. Se usa como
+// servidor_ronda_t.
+void empezar_ronda(void* clinica) {
+	aplicar_recargas(clinica, false);
+	vaciar_salida(clinica);
+}
+
+// Registra en el disco los cambios de la ronda antes de enviar las
+// respuestas. Se usa como servidor_ronda_t.
+void terminar_ronda(void* clinica) {
+	sincronizar_bitacora(clinica);
+}
+
+// Atiende a los clientes del socket 'ruta' hasta recibir SIGINT o SIGTERM.
+// Post: Devuelve false si no se pudo crear el socket, o si falló la espera.
+bool servir(clinica_t* clinica, const char* ruta) {
+	servidor_t* servidor = servidor_crear(ruta);
+	if (!servidor) {
+		fprintf(stderr, ESERVIDOR, ruta);
+		return false;
+	}
+	bool ok = servidor_atender(servidor, atender_pedido, empezar_ronda, terminar_ronda, clinica);
+	servidor_destruir(servidor);
+	aplicar_recargas(clinica, true);
+	vaciar_salida(clinica);
+	return ok;
+}
+
+/***********************************
+ *      EJECUCIÓN DEL PROGRAMA     *
+ ***********************************/
+
+
+/* Funcion en donde se ejecuta el programa en si. Recibe el catálogo
+ * generado en el main, y queda a la espera de comandos. En caso
+ * de fallar o no recibir comando alguno (ENTER), finaliza la funcion.
+ * Los comandos se leen en un único buffer y se procesan sin copiarlos,
+ * de modo que no se reserva memoria por cada comando.
+ * Las respuestas se acumulan en la salida del catálogo, que se vacía
+ * antes de leer cada bloque de la entrada: una vez por bloque si los
+ * comandos llegan juntos, y antes de esperar el siguiente si se escriben
+ * de a uno.
+ * Con 'en_etapas', la lectura y la escritura se hacen en otros hilos
+ * (ver EJECUCIÓN EN ETAPAS), y con 'trabajadores' > 0 las especialidades
+ * se reparten entre esa cantidad de hilos (ver EJECUCIÓN REPARTIDA), si se
+ * pueden lanzar. Con 'ruta_socket', los comandos llegan por ese socket en
+ * lugar de la entrada estándar (ver SERVIDOR).
+ * Devuelve false si no se pudo atender en el socket.
+ */
+bool ejecutar_programa(clinica_t* clinica, bool en_etapas, size_t trabajadores, const char* ruta_socket){
+	if (ruta_socket) return servir(clinica, ruta_socket);
+	if (trabajadores > 0 && ejecutar_repartido(clinica, trabajadores)) return true;
+	if (en_etapas && ejecutar_en_etapas(clinica)) return true;
+	csv_flujo_t entrada = {.delim = ':', .fd = STDIN_FILENO, .antes_de_leer = vaciar_salida, .extra = clinica};
+	parametros_t parametros;
 	bool fin = false;
 	do {
-		parametros_t* parametros = obtener_parametros();
-		if (!parametros) fin = true;
-		else if (parametros->comando) {
-			if (strcmp(parametros->comando, "PEDIR_TURNO") == 0) pedir_turno(parametros, hash_pacientes, hash_especialidades);
-			else if (strcmp(parametros->comando, "ATENDER_SIGUIENTE") == 0) atender_siguiente(parametros, hash_doctores, hash_especialidades);
-			else if (strcmp(parametros->comando, "INFORME") == 0) {
-				if (strcmp(parametros->param1, "DOCTORES") == 0) mostrar_informe(hash_doctores);
-				else printf(ENOENT_CMD, parametros->comando, parametros->param1);
-			}
-			else printf(ENOENT_CMD, parametros->comando, parametros->param1);
-		}
-		parametros_destruir(parametros);
+		bool hay_linea = obtener_parametros(&entrada, &parametros);
+		// Los cambios de las recargas se aplican siempre entre dos comandos
+		aplicar_recargas(clinica, !hay_linea);
+		if (!hay_linea) fin = true;
+		else ejecutar_linea(&parametros, clinica);
 	} while (!fin);
-	hash_destruir(hash_doctores);
-	hash_destruir(hash_especialidades);
-	hash_destruir(hash_pacientes);
+	csv_flujo_terminar(&entrada);
+	vaciar_salida(clinica);
+	return true;
+}
+
+/* Con --perfil-arranque RUTA, cada fase del arranque (la carga de cada
+ * CSV o de la imagen, la del índice de pacientes, y la recuperación de la
+ * bitácora) se mide por separado (ver perfil.h), y el perfil se guarda en
+ * RUTA antes de empezar a ejecutar comandos. El arranque es el mismo que
+ * sin medirlo: los pacientes se siguen cargando mientras se cargan los
+ * doctores, y cada hilo (incluidos los que leen los trozos de cada CSV)
+ * cuenta lo que pide en la fase de su archivo.
+ */
+
+// Devuelve las veces que se agrandaron las tablas que llena la carga de
+// los doctores: su hash y los nombres de las especialidades.
+size_t redimensiones_doctores(const clinica_t* clinica) {
+	size_t redimensiones = 0;
+	if (clinica->hash_doctores) redimensiones += hash_redimensiones(clinica->hash_doctores);
+	if (clinica->nombres_especialidades) redimensiones += cadenas_redimensiones(clinica->nombres_especialidades);
+	return redimensiones;
+}
+
+// Devuelve las veces que se agrandó el hash de pacientes.
+size_t redimensiones_pacientes(const clinica_t* clinica) {
+	return clinica->hash_pacientes ? hash_redimensiones(clinica->hash_pacientes) : 0;
+}
+
+// Devuelve las veces que se agrandaron las tablas de hash del catálogo
+// (NULL si todavía no existe).
+size_t redimensiones_clinica(const clinica_t* clinica) {
+	if (!clinica) return 0;
+	size_t redimensiones = redimensiones_doctores(clinica) + redimensiones_pacientes(clinica);
+	if (clinica->nombres) redimensiones += cadenas_redimensiones(clinica->nombres);
+	return redimensiones;
+}
+
+// Empieza una fase del arranque, si se está midiendo ('perfil' no es NULL).
+// Post: Devuelve la fase, NULL si no se mide.
+perfil_fase_t* empezar_fase(perfil_t* perfil, const char* nombre, size_t redimensiones) {
+	return perfil ? perfil_empezar(perfil, nombre, redimensiones) : NULL;
+}
+
+// Termina una fase del arranque, que cargó 'filas' filas, si se mide.
+void terminar_fase(perfil_fase_t* fase, size_t filas, size_t redimensiones) {
+	if (fase) perfil_terminar(fase, filas, redimensiones);
+}
+
+// Función del hilo que carga los pacientes mientras se cargan los
+// doctores, contando lo que pide en su fase del arranque.
+void* cargar_pacientes_en_fase(void* dato) {
+	carga_pacientes_t* carga = dato;
+	const clinica_t* clinica = carga->clinica;
+	perfil_contar_en(carga->fase);
+	cargar_pacientes(carga);
+	size_t indexados = clinica->indice_pacientes ? indice_csv_cantidad(clinica->indice_pacientes) : 0;
+	terminar_fase(carga->fase, carga->archivo_indice ? indexados : clinica->pacientes.cantidad, redimensiones_pacientes(clinica));
+	return NULL;
+}
+
+// Carga el catálogo a partir de los archivos CSV de doctores y pacientes,
+// que quedan cargados en 'csv_doctores' y 'csv_pacientes' (deben
+// cerrarse después de destruir el catálogo). Si 'archivo_indice' no es
+// NULL, los pacientes no se cargan sino que se indexan (y 'csv_pacientes'
+// queda vacío). Si 'perfil' no es NULL, mide cada fase.
+// Post: Devuelve el catálogo, NULL si no se pudo cargar.
+clinica_t* cargar_de_csv(char* archivo_doctores, char* archivo_pacientes, const char* archivo_indice, csv_mapa_t* csv_doctores, csv_mapa_t* csv_pacientes, size_t hilos, perfil_t* perfil) {
+	*csv_pacientes = (csv_mapa_t) {.delim = ','};
+	clinica_t* clinica = clinica_crear(archivo_doctores, archivo_pacientes);
+	if (!clinica) return NULL;
+	
+	// Los pacientes se cargan en otro hilo mientras se cargan los doctores
+	carga_pacientes_t carga = {.clinica = clinica, .archivo = archivo_pacientes, .csv = csv_pacientes, .archivo_indice = archivo_indice, .hilos = hilos};
+	carga.fase = empezar_fase(perfil, archivo_indice ? "indice_pacientes" : "pacientes", redimensiones_pacientes(clinica));
+	pthread_t hilo_pacientes;
+	bool en_paralelo = hilos > 1 && pthread_create(&hilo_pacientes, NULL, cargar_pacientes_en_fase, &carga) == 0;
+	if (!en_paralelo) cargar_pacientes_en_fase(&carga);
+	
+	perfil_fase_t* fase = empezar_fase(perfil, "doctores", redimensiones_doctores(clinica));
+	perfil_contar_en(fase);
+	bool ok = clinica_cargar_doctores(clinica, archivo_doctores, csv_doctores, hilos);
+	terminar_fase(fase, clinica->doctores.cantidad, redimensiones_doctores(clinica));
+	if (en_paralelo) pthread_join(hilo_pacientes, NULL);
+	if (!ok || !carga.ok) {
+		clinica_destruir(clinica);
+		return NULL;
+	}
+	return clinica;
+}
+
+// Guarda las métricas en 'ruta', si no es NULL.
+// Post: Devuelve false, informando el error, si no se pudieron guardar.
+bool guardar_metricas_en(const clinica_t* clinica, const char* ruta) {
+#ifndef SIN_METRICAS
+	if (ruta && !guardar_metricas(clinica, ruta)) {
+		fprintf(stderr, EMETRICAS, ruta);
+		return false;
+	}
+#else
+	(void) clinica;
+	(void) ruta;
+#endif
+	return true;
+}
+
+// Termina el arranque del catálogo ya cargado: recupera la bitácora
+// 'ruta_bitacora' si no es NULL, y guarda el perfil del arranque en
+// 'ruta_perfil' si no es NULL.
+// Post: Devuelve false, informando el error, si algo falló.
+bool terminar_arranque(clinica_t* clinica, const char* ruta_bitacora, perfil_t* perfil, const char* ruta_perfil) {
+	if (ruta_bitacora) {
+		perfil_fase_t* fase = empezar_fase(perfil, "bitacora", redimensiones_clinica(clinica));
+		perfil_contar_en(fase);
+		if (!clinica_abrir_bitacora(clinica, ruta_bitacora)) {
+			perfil_contar_en(NULL);
+			fprintf(stderr, EBITACORA, ruta_bitacora);
+			return false;
+		}
+		terminar_fase(fase, bitacora_recuperados(clinica->bitacora), redimensiones_clinica(clinica));
+	}
+	if (!ruta_perfil) return true;
+	int fd = open(ruta_perfil, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	bool ok = fd >= 0;
+	if (ok) {
+		salida_t salida = {.fd = fd};
+		perfil_escribir(perfil, &salida);
+		ok = salida_terminar(&salida);
+		ok = close(fd) == 0 && ok;
+	}
+	if (!ok) fprintf(stderr, EPERFIL, ruta_perfil);
+	return ok;
 }
 
 /* Función main del programa. Recibe por parametro los nombres de los
- * dos archivos CSV a usar. En caso de no pasar dos argumentos, o fallar
- * en alguna parte, devuelve 1 y finaliza la ejecucion.
+ * dos archivos CSV a usar, precedidos opcionalmente por "--hilos N" para
+ * indicar cuántos hilos usar en la carga (por omisión, uno por procesador),
+ * por "--indice-pacientes INDICE" para no cargar los pacientes sino
+ * leerlos del archivo al pedirlos, con el índice guardado en INDICE (que se
+ * arma si no existe o si el archivo cambió), por "--etapas" para leer,
+ * ejecutar y escribir los comandos en tres hilos, por "--repartir N" para
+ * repartir las especialidades entre N hilos que ejecutan los comandos, o
+ * por "--servir RUTA" para recibir los comandos de los clientes que se
+ * conecten al socket RUTA en lugar de la entrada estándar, hasta recibir
+ * SIGINT o SIGTERM. Con "--bitacora RUTA", las listas de espera y los
+ * pacientes atendidos se registran en RUTA, y se recuperan de ahí al
+ * arrancar. Con "--metricas RUTA", al terminar se guardan en RUTA las
+ * métricas de los comandos ejecutados, y con "--perfil-arranque RUTA" se
+ * guarda en RUTA lo que llevó cada fase del arranque. Con "--fin-rapido",
+ * al terminar no se libera la memoria del catálogo (la libera el sistema,
+ * de una vez), sino sólo se vacía la salida y se cierra la bitácora; sin
+ * esa opción se destruye todo, para que valgrind no informe pérdidas.
+ * En lugar de los CSV puede recibir una imagen del catálogo generada antes
+ * con "--compilar doctores.csv pacientes.csv imagen", que carga los CSV,
+ * guarda la imagen y termina.
+ * En caso de no pasar los archivos esperados, o fallar en alguna parte,
+ * devuelve 1 y finaliza la ejecucion.
  */
 int main(int argc, char *argv[]) {
-	// Si no se recibieron exactamente dos argumentos por la línea de comandos
-	if (argc != 3) {
-		return 1;
+	size_t hilos = hilos_por_omision();
+	const char* archivo_indice = NULL;
+	bool en_etapas = false;
+	bool fin_rapido = false;
+	size_t trabajadores = 0;
+	const char* ruta_socket = NULL;
+	const char* ruta_bitacora = NULL;
+	const char* ruta_metricas = NULL;
+	const char* ruta_perfil = NULL;
+	int arg = 1;
+	while (argc > arg + 1) {
+		// Opción sin valor, si es una
+		bool* activada = NULL;
+		if (strcmp(argv[arg], "--etapas") == 0) activada = &en_etapas;
+		else if (strcmp(argv[arg], "--fin-rapido") == 0) activada = &fin_rapido;
+		if (activada) {
+			*activada = true;
+			arg++;
+			continue;
+		}
+		// Cantidad de hilos que indica la opción, si es una
+		size_t* cant_hilos = NULL;
+		if (strcmp(argv[arg], "--hilos") == 0) cant_hilos = &hilos;
+		else if (strcmp(argv[arg], "--repartir") == 0) cant_hilos = &trabajadores;
+		if (cant_hilos) {
+			char* fin;
+			unsigned long cant = strtoul(argv[arg + 1], &fin, 10);
+			if (*fin != '\0' || cant < 1 || cant > MAX_HILOS) return 1;
+			*cant_hilos = (size_t) cant;
+		}
+		else if (strcmp(argv[arg], "--indice-pacientes") == 0) archivo_indice = argv[arg + 1];
+		else if (strcmp(argv[arg], "--servir") == 0) ruta_socket = argv[arg + 1];
+		else if (strcmp(argv[arg], "--bitacora") == 0) ruta_bitacora = argv[arg + 1];
+		else if (strcmp(argv[arg], "--perfil-arranque") == 0) ruta_perfil = argv[arg + 1];
+#ifndef SIN_METRICAS
+		else if (strcmp(argv[arg], "--metricas") == 0) ruta_metricas = argv[arg + 1];
+#endif
+		else break;
+		arg += 2;
 	}
+	bool compilar = argc > arg && strcmp(argv[arg], "--compilar") == 0;
+	if (compilar) arg++;
+	// El índice sólo sirve para ejecutar con los dos CSV
+	if (archivo_indice && (compilar || argc - arg != 2)) return 1;
+	// Los comandos se ejecutan de una sola forma, y no se ejecutan al compilar
+	if ((en_etapas && trabajadores > 0) || (ruta_socket && (en_etapas || trabajadores > 0 || compilar))) return 1;
+	if ((ruta_bitacora || ruta_metricas) && compilar) return 1;
 	
-	hash_t* hash_doctores = generar_hash_doctores(argv[1]);
-	if (!hash_doctores) return 1;
+	perfil_t datos_perfil;
+	perfil_t* perfil = ruta_perfil ? &datos_perfil : NULL;
+	if (perfil) perfil_activar(perfil);
 	
-	hash_t* hash_pacientes = generar_hash_pacientes(argv[2]);
-	if (!hash_pacientes) return 1;
+	// Con un único archivo, es una imagen del catálogo
+	if (!compilar && argc - arg == 1) {
+		perfil_fase_t* fase = empezar_fase(perfil, "imagen", 0);
+		perfil_contar_en(fase);
+		clinica_t* clinica = clinica_cargar_imagen(argv[arg]);
+		if (!clinica) {
+			fprintf(stderr, EINVAL_CATALOGO, argv[arg]);
+			return 1;
+		}
+		terminar_fase(fase, clinica->doctores.cantidad + clinica->pacientes.cantidad + clinica->especialidades.cantidad, redimensiones_clinica(clinica));
+		bool ok = terminar_arranque(clinica, ruta_bitacora, perfil, ruta_perfil)
+		          && ejecutar_programa(clinica, en_etapas, trabajadores, ruta_socket)
+		          && guardar_metricas_en(clinica, ruta_metricas);
+		if (fin_rapido) clinica_terminar(clinica);
+		else clinica_destruir(clinica);
+		return ok ? 0 : 1;
+	}
+	
+	// Si no se recibieron exactamente dos archivos por la línea de comandos
+	// (y la imagen a generar, al compilar)
+	if (argc - arg != (compilar ? 3 : 2)) {
+		return 1;
+	}
 	
-	hash_t* hash_especialidades = generar_hash_especialidades(hash_doctores);
-	if (!hash_especialidades) return 1;
+	// Los archivos quedan cargados hasta el final, porque los nombres
+	// de los doctores, pacientes y especialidades apuntan a ellos
+	csv_mapa_t csv_doctores, csv_pacientes;
+	clinica_t* clinica = cargar_de_csv(argv[arg], argv[arg + 1], archivo_indice, &csv_doctores, &csv_pacientes, hilos, perfil);
+	if (!clinica) return 1;
 	
-	ejecutar_programa(hash_doctores, hash_pacientes, hash_especialidades);
-	return 0;
+	bool ok = terminar_arranque(clinica, ruta_bitacora, perfil, ruta_perfil);
+	if (compilar) ok = ok && clinica_compilar(clinica, argv[arg + 2]);
+	else ok = ok && ejecutar_programa(clinica, en_etapas, trabajadores, ruta_socket)
+	          && guardar_metricas_en(clinica, ruta_metricas);
+	if (fin_rapido) {
+		clinica_terminar(clinica);
+		return ok ? 0 : 1;
+	}
+	clinica_destruir(clinica);
+	csv_mapa_cerrar(&csv_doctores);
+	csv_mapa_cerrar(&csv_pacientes);
+	return ok ? 0 : 1;
 }
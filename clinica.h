@@ -1,66 +1,139 @@
 #include "abb.h"
+#include "abb_plano.h"
+#include "anillo.h"
+#include "bitacora.h"
+#include "cadenas.h"
+#include "catalogo.h"
 #include "cola.h"
 #include "csv.h"
 #include "hash.h"
 #include "heap.h"
+#include "heap_ids.h"
+#include "indice_csv.h"
 #include "lista.h"
+#include "metricas.h"
+#include "perfil.h"
 #include "pila.h"
+#include "salida.h"
+#include "servidor.h"
 #include "mensajes.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 /***********************************
  *       ESTRUCTURAS DE DATOS      *
  ***********************************/
 
-typedef struct doctor doctor_t;
-typedef struct paciente paciente_t;
-typedef struct especialidad especialidad_t;
 typedef struct parametros parametros_t;
+typedef struct clinica clinica_t;
 
 /***********************************
  *      PRIMITIVAS PRINCIPALES     *
  ***********************************/
 
-// Función que genera un hash de doctores a partir de un archivo CSV (cuya ruta es el parámetro de la función).
-// Pre: Ninguna.
-// Post: Devuelve el hash de doctores si se pudo procesar el archivo, NULL si no pudo realizarse por algún motivo.
-hash_t* generar_hash_doctores(char* archivo_doctores);
+// Crea un catálogo vacío, al que se le cargan los CSV de doctores y pacientes,
+// cuyas rutas se recuerdan para poder recargarlos.
+// Post: Devuelve el catálogo, NULL si no hubo memoria.
+clinica_t* clinica_crear(const char* archivo_doctores, const char* archivo_pacientes);
+
+// Carga en el catálogo los doctores de un archivo CSV, y sus especialidades.
+// Pre: El catálogo se creó con clinica_crear.
+// Post: Devuelve false si no se pudo procesar el archivo por algún motivo.
+// El archivo queda cargado en 'csv_doctores', que debe cerrarse después de destruir el catálogo.
+// Se lee en trozos repartidos entre hasta 'hilos' hilos.
+bool clinica_cargar_doctores(clinica_t* clinica, char* archivo_doctores, csv_mapa_t* csv_doctores, size_t hilos);
+
+// Carga en el catálogo los pacientes de un archivo CSV. Puede ejecutarse en
+// otro hilo a la vez que clinica_cargar_doctores.
+// Pre: El catálogo se creó con clinica_crear.
+// Post: Devuelve false si no se pudo procesar el archivo por algún motivo.
+// El archivo queda cargado en 'csv_pacientes', que debe cerrarse después de destruir el catálogo.
+// Se lee en trozos repartidos entre hasta 'hilos' hilos.
+bool clinica_cargar_pacientes(clinica_t* clinica, char* archivo_pacientes, csv_mapa_t* csv_pacientes, size_t hilos);
+
+// Indexa en el catálogo el archivo CSV de pacientes en lugar de cargarlo:
+// cada paciente se lee del archivo la primera vez que pide un turno. Usa el
+// índice guardado en 'archivo_indice' si sigue correspondiendo al archivo, y
+// si no lo arma y lo guarda ahí. Puede ejecutarse en otro hilo a la vez que
+// clinica_cargar_doctores.
+// Pre: El catálogo se creó con clinica_crear.
+// Post: Devuelve false si no se pudo leer el archivo o no hubo memoria. Las
+// líneas inválidas se informan sólo al armar el índice. Los pacientes del
+// archivo no pueden recargarse.
+bool clinica_indexar_pacientes(clinica_t* clinica, char* archivo_pacientes, const char* archivo_indice);
 
-// Función que genera un hash de pacientes a partir de un archivo CSV (cuya ruta es el parámetro de la función).
+// Carga el catálogo del programa de una imagen compilada antes con clinica_compilar.
 // Pre: Ninguna.
-// Post: Devuelve el hash de pacientes si se pudo procesar el archivo, NULL si no pudo realizarse por algún motivo.
-hash_t* generar_hash_pacientes(char* archivo_pacientes);
+// Post: Devuelve el catálogo, NULL si la imagen no existe, no es válida o no hubo memoria.
+// La imagen queda proyectada en memoria hasta destruir el catálogo.
+clinica_t* clinica_cargar_imagen(const char* ruta);
+
+// Guarda en 'ruta' la imagen compilada de un catálogo cargado de los CSV.
+// Pre: El catálogo se creó con clinica_crear.
+// Post: Devuelve false si no se pudo generar o escribir la imagen.
+bool clinica_compilar(const clinica_t* clinica, const char* ruta);
+
+// Recupera en el catálogo las listas de espera y los pacientes atendidos
+// guardados en la bitácora 'ruta' (ver bitacora.h), y a partir de ahí
+// registra ahí cada cambio, antes de mostrar su resultado.
+// Pre: El catálogo está cargado, y no se ejecutó ningún comando.
+// Post: Devuelve false si no se pudo abrir la bitácora, o no es válida.
+bool clinica_abrir_bitacora(clinica_t* clinica, const char* ruta);
+
+// Termina lo del catálogo que se ve desde afuera: escribe lo que quede de
+// su salida, y sincroniza y cierra su bitácora. No libera su memoria, para
+// terminar el programa enseguida (el sistema la libera toda de una vez).
+// Pre: El catálogo existe.
+// Post: El catálogo sólo puede destruirse.
+void clinica_terminar(clinica_t* clinica);
 
-// Función que genera un hash de especialidades a partir del hash de doctores previamente creado.
-// Pre: El hash de doctores existe.
-// Post: Devuelve el hash de especialidades, NULL si hubo algún error.
-hash_t* generar_hash_especialidades(hash_t* hash_doctores);
+// Destruye el catálogo junto con sus tablas, y los hashes o la imagen de los que se cargó.
+// Pre: El catálogo existe.
+void clinica_destruir(clinica_t* clinica);
 
 // Función que permite solicitar un turno para un paciente para una determinada especialidad.
-// Pre: Los hashes de pacientes y especialidades existen.
+// Pre: El catálogo existe.
 // Post: Se encola un paciente en el heap de la especialidad ingresada por teclado, según su total contribuído.
 //
 // Salida por pantalla:
 //
 // Paciente NOMBRE_PACIENTE encolado
 // N paciente(s) en espera para NOMBRE_ESPECIALIDAD
-void pedir_turno(parametros_t* parametros, hash_t* hash_pacientes, hash_t* hash_especialidades);
+void pedir_turno(parametros_t* parametros, clinica_t* clinica);
 
 // Función que permite atender a un médico atender al paciente que esté primero en la cola de prioridad de su especialidad.
-// Pre: Los hashes de doctores y especialidades existen.
+// Pre: El catálogo existe.
 // Post: El paciente es desencolado
 //
 // Salida por pantalla:
 //
 // Se atiende a NOMBRE_PACIENTE
 // N paciente(s) en espera para NOMBRE_ESPECIALIDAD
-void atender_siguiente(parametros_t* parametros, hash_t* hash_doctores, hash_t* hash_especialidades);
+void atender_siguiente(parametros_t* parametros, clinica_t* clinica);
+
+// Función que vuelve a leer el archivo de doctores o de pacientes (según el parámetro) en segundo plano.
+// Pre: El catálogo existe, y el parámetro DOCTORES|PACIENTES ya se interpretó.
+// Post: Los cambios del archivo se aplican entre dos comandos posteriores, al terminar de leerlo,
+// conservando las listas de espera y los pacientes atendidos por cada doctor.
+//
+// Salida por pantalla:
+//
+// Recargando DOCTORES|PACIENTES
+//
+// y luego, al aplicar los cambios:
+//
+// DOCTORES|PACIENTES recargados: A agregado(s), M modificado(s), B borrado(s)
+void recargar(parametros_t* parametros, clinica_t* clinica);
 
 // Función que imprime la lista de doctores en orden alfabético, junto con su especialidad y el número de pacientes que atendieron desde que arrancó el sistema.
-// Pre: El hash de doctores existe.
+// Pre: El catálogo existe.
 // Post: Ninguna.
 //
 // Salida por pantalla:
@@ -70,5 +143,5 @@ void atender_siguiente(parametros_t* parametros, hash_t* hash_doctores, hash_t*
 // 2: NOMBRE, especialidad ESPECIALIDAD, Y paciente(s) atendido(s)
 // ...
 // N: NOMBRE, especialidad ESPECIALIDAD, Z paciente(s) atendido(s)
-void mostrar_informe(hash_t* hash_doctores);
+void mostrar_informe(clinica_t* clinica);
 
@@ -1,29 +1,75 @@
 #include "cola.h"
 #include <stdlib.h>
+#include <string.h>
 
-typedef struct nodo {
-	void* valor;
-	struct nodo* ref;
-} nodo_t;
+#define TAM_INICIAL 8       // Potencia de dos
+#define MULTIPLICADOR 2
+#define DIVISOR_ACHICAR 4   // Se achica al quedar ocupada menos de esta fracción
 
-/* Definición del struct cola proporcionado por la cátedra. */
+/* La cola se guarda en un buffer circular de capacidad potencia de dos: el
+ * primer elemento está en la posición 'inicio' y los siguientes continúan,
+ * dando la vuelta al llegar al final del arreglo. Como la capacidad es
+ * potencia de dos, la vuelta se resuelve con una máscara en lugar de un
+ * módulo. */
 
 struct cola {
-	nodo_t* primero;
-	nodo_t* ultimo;
-	int tamano;
+	void** datos;
+	size_t capacidad;
+	size_t inicio;
+	size_t cantidad;
 };
 
-/* Función auxiliar para crear un nuevo nodo */
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
 
-nodo_t* nodo_crear(void* valor){
-	nodo_t* nodo = malloc(sizeof(nodo_t));
-	if (!nodo)
-		return NULL;
-	nodo->valor = valor;
-	nodo_t* ref = NULL;
-	nodo->ref = ref;
-	return nodo;
+// Devuelve la posición del arreglo en la que está el i-ésimo elemento.
+size_t cola_posicion(const cola_t* cola, size_t i) {
+	return (cola->inicio + i) & (cola->capacidad - 1);
+}
+
+// Copia los elementos de la cola, en orden, al arreglo destino.
+void cola_copiar(const cola_t* cola, void** destino) {
+	size_t hasta_el_final = cola->capacidad - cola->inicio;
+	if (cola->cantidad <= hasta_el_final) {
+		memcpy(destino, cola->datos + cola->inicio, cola->cantidad * sizeof(void*));
+		return;
+	}
+	memcpy(destino, cola->datos + cola->inicio, hasta_el_final * sizeof(void*));
+	memcpy(destino + hasta_el_final, cola->datos, (cola->cantidad - hasta_el_final) * sizeof(void*));
+}
+
+// Cambia la capacidad de la cola, dejando el primer elemento en la posición 0.
+// Pre: nueva_capacidad es potencia de dos y mayor o igual a la cantidad.
+// Post: devuelve false si no hubo memoria, en cuyo caso la cola no cambia.
+bool cola_redimensionar(cola_t* cola, size_t nueva_capacidad) {
+	void** datos = malloc(nueva_capacidad * sizeof(void*));
+	if (!datos) return false;
+	cola_copiar(cola, datos);
+	free(cola->datos);
+	cola->datos = datos;
+	cola->capacidad = nueva_capacidad;
+	cola->inicio = 0;
+	return true;
+}
+
+// Agranda la cola hasta que entren cant elementos más.
+// Post: devuelve false si no hubo memoria.
+bool cola_asegurar_lugar(cola_t* cola, size_t cant) {
+	size_t capacidad = cola->capacidad;
+	while (capacidad - cola->cantidad < cant) capacidad *= MULTIPLICADOR;
+	if (capacidad == cola->capacidad) return true;
+	return cola_redimensionar(cola, capacidad);
+}
+
+// Achica la cola, a la mitad cada vez, mientras quede ocupada menos de
+// 1/DIVISOR_ACHICAR de su capacidad. Si no hay memoria la cola sigue igual,
+// lo cual es válido.
+void cola_achicar(cola_t* cola) {
+	size_t capacidad = cola->capacidad;
+	while (capacidad > TAM_INICIAL && cola->cantidad < capacidad / DIVISOR_ACHICAR)
+		capacidad /= MULTIPLICADOR;
+	if (capacidad != cola->capacidad) cola_redimensionar(cola, capacidad);
 }
 
 /* *****************************************************************
@@ -34,57 +80,77 @@ cola_t* cola_crear(void) {
 	cola_t* cola = malloc(sizeof(cola_t));
 	if (!cola)
 		return NULL;
-	nodo_t* nodo_1 = NULL;
-	nodo_t* nodo_2 = NULL;
-	cola->primero = nodo_1;
-	cola->ultimo = nodo_2;
-	cola->tamano = 0;
+	cola->datos = malloc(TAM_INICIAL * sizeof(void*));
+	if (!cola->datos) {
+		free(cola);
+		return NULL;
+	}
+	cola->capacidad = TAM_INICIAL;
+	cola->inicio = 0;
+	cola->cantidad = 0;
 	return cola;
 }
 
 void cola_destruir(cola_t *cola, void destruir_dato(void*)) {
-	void* elemento;
-	while (!cola_esta_vacia(cola)) {
-		elemento = cola_desencolar(cola);
-		if (destruir_dato)
-			destruir_dato(elemento);
+	if (destruir_dato) {
+		for (size_t i = 0; i < cola->cantidad; i++)
+			destruir_dato(cola->datos[cola_posicion(cola, i)]);
 	}
+	free(cola->datos);
 	free(cola);
 }
 
 bool cola_esta_vacia(const cola_t *cola) {
-	return (cola->tamano == 0);
+	return (cola->cantidad == 0);
 }
 
 bool cola_encolar(cola_t *cola, void* valor) {
 	if (!cola)
 		return false;
-	nodo_t* nuevo_nodo = nodo_crear(valor);
-	if (cola->tamano == 0){
-		cola->primero = nuevo_nodo;
-	} else {
-		(cola->ultimo)->ref = nuevo_nodo;
-	}
-	cola->ultimo = nuevo_nodo;
-	cola->tamano += 1;
+	if (cola->cantidad == cola->capacidad && !cola_asegurar_lugar(cola, 1))
+		return false;
+	cola->datos[cola_posicion(cola, cola->cantidad)] = valor;
+	cola->cantidad += 1;
+	return true;
+}
+
+bool cola_encolar_lote(cola_t *cola, void* valores[], size_t cant) {
+	if (!cola || !cola_asegurar_lugar(cola, cant))
+		return false;
+	// Los nuevos elementos ocupan a lo sumo dos tramos contiguos del arreglo
+	size_t fin = cola_posicion(cola, cola->cantidad);
+	size_t primer_tramo = cola->capacidad - fin;
+	if (primer_tramo > cant) primer_tramo = cant;
+	memcpy(cola->datos + fin, valores, primer_tramo * sizeof(void*));
+	memcpy(cola->datos, valores + primer_tramo, (cant - primer_tramo) * sizeof(void*));
+	cola->cantidad += cant;
 	return true;
 }
 
 void* cola_ver_primero(const cola_t *cola) {
 	if (cola_esta_vacia(cola))
 		return NULL;
-	void* primero = (cola->primero)->valor;
-	return primero;
+	return cola->datos[cola->inicio];
 }
 
 void* cola_desencolar(cola_t *cola) {
 	if (cola_esta_vacia(cola))
 		return NULL;
-	nodo_t* nodo_aux = cola->primero;
-	void* elemento = (cola->primero)->valor;
-	cola->primero = (cola->primero)->ref;
-	free(nodo_aux);
-	cola->tamano -= 1;
+	void* elemento = cola->datos[cola->inicio];
+	cola->inicio = cola_posicion(cola, 1);
+	cola->cantidad -= 1;
+	cola_achicar(cola);
 	return elemento;
 }
 
+size_t cola_desencolar_lote(cola_t *cola, void* destino[], size_t cant) {
+	if (cant > cola->cantidad) cant = cola->cantidad;
+	size_t primer_tramo = cola->capacidad - cola->inicio;
+	if (primer_tramo > cant) primer_tramo = cant;
+	memcpy(destino, cola->datos + cola->inicio, primer_tramo * sizeof(void*));
+	memcpy(destino + primer_tramo, cola->datos, (cant - primer_tramo) * sizeof(void*));
+	cola->inicio = cola_posicion(cola, cant);
+	cola->cantidad -= cant;
+	cola_achicar(cola);
+	return cant;
+}
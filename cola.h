@@ -2,13 +2,16 @@
 #define COLA_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 
 /* ******************************************************************
  *                DEFINICION DE LOS TIPOS DE DATOS
  * *****************************************************************/
 
-/* La cola está planteada como una cola de punteros genéricos. */
+/* La cola está planteada como una cola de punteros genéricos, guardados en
+ * un buffer circular que se agranda al doble cuando se llena y se achica
+ * cuando queda ocupado menos de un cuarto. */
 
 struct cola;
 typedef struct cola cola_t;
@@ -39,6 +42,12 @@ bool cola_esta_vacia(const cola_t *cola);
 // de la cola.
 bool cola_encolar(cola_t *cola, void* valor);
 
+// Agrega cant elementos a la cola, en el orden en que están en valores.
+// Devuelve falso en caso de error, sin haber encolado ninguno.
+// Pre: la cola fue creada.
+// Post: los elementos de valores se encuentran al final de la cola.
+bool cola_encolar_lote(cola_t *cola, void* valores[], size_t cant);
+
 // Obtiene el valor del primer elemento de la cola. Si la cola tiene
 // elementos, se devuelve el valor del primero, si está vacía devuelve NULL.
 // Pre: la cola fue creada.
@@ -52,6 +61,13 @@ void* cola_ver_primero(const cola_t *cola);
 // contiene un elemento menos, si la cola no estaba vacía.
 void* cola_desencolar(cola_t *cola);
 
+// Saca hasta cant elementos del principio de la cola y los guarda en orden
+// en destino. Devuelve la cantidad de elementos desencolados, que es menor
+// a cant si la cola tenía menos elementos.
+// Pre: la cola fue creada, destino tiene lugar para cant elementos.
+// Post: la cola contiene los elementos desencolados menos.
+size_t cola_desencolar_lote(cola_t *cola, void* destino[], size_t cant);
+
 
 /* *****************************************************************
  *                      PRUEBAS UNITARIAS
@@ -1,8 +1,192 @@
 #define _POSIX_C_SOURCE 200809L  // For getline().
 
 #include "csv.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define CSV_BLOQUE 64     // Bytes que revisa cada llamada a csv_separadores().
+#define CSV_VENTANA 4096  // Bytes que indexa de una vez csv_mapa_siguiente().
+#define CSV_FLUJO 65536   // Tamaño inicial del buffer de un csv_flujo_t.
+
+// Devuelve la posición del bit encendido menos significativo.
+// Pre: mascara != 0.
+int csv_primer_bit(uint64_t mascara) {
+#ifdef __GNUC__
+  return __builtin_ctzll(mascara);
+#else
+  int i = 0;
+  while (!(mascara & 1)) {
+    mascara >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+uint64_t csv_separadores(const char *inicio, size_t largo, char delim) {
+  // Nunca se lee fuera de [inicio, inicio + largo): un bloque incompleto se
+  // copia y se completa con ceros.
+  char copia[CSV_BLOQUE];
+  uint64_t validos = UINT64_MAX;
+  if (largo < CSV_BLOQUE) {
+    memset(copia, 0, sizeof(copia));
+    memcpy(copia, inicio, largo);
+    inicio = copia;
+    validos = ((uint64_t) 1 << largo) - 1;
+  }
+  uint64_t mascara = 0;
+
+#if defined(__AVX2__)
+  const __m256i con_delim = _mm256_set1_epi8(delim);
+  const __m256i con_fin = _mm256_set1_epi8('\n');
+  for (int i = 0; i < CSV_BLOQUE; i += 32) {
+    __m256i datos = _mm256_loadu_si256((const __m256i *) (inicio + i));
+    __m256i iguales = _mm256_or_si256(_mm256_cmpeq_epi8(datos, con_delim), _mm256_cmpeq_epi8(datos, con_fin));
+    mascara |= (uint64_t) (uint32_t) _mm256_movemask_epi8(iguales) << i;
+  }
+#elif defined(__SSE2__)
+  const __m128i con_delim = _mm_set1_epi8(delim);
+  const __m128i con_fin = _mm_set1_epi8('\n');
+  for (int i = 0; i < CSV_BLOQUE; i += 16) {
+    __m128i datos = _mm_loadu_si128((const __m128i *) (inicio + i));
+    __m128i iguales = _mm_or_si128(_mm_cmpeq_epi8(datos, con_delim), _mm_cmpeq_epi8(datos, con_fin));
+    mascara |= (uint64_t) (uint32_t) _mm_movemask_epi8(iguales) << i;
+  }
+#else
+  // Sin instrucciones vectoriales, se descartan de a ocho bytes los que no
+  // contienen ninguno de los dos caracteres (SWAR), y se revisa byte a byte
+  // sólo donde hay alguno.
+  const uint64_t unos = 0x0101010101010101u;
+  const uint64_t altos = 0x8080808080808080u;
+  const uint64_t con_delim = unos * (unsigned char) delim;
+  const uint64_t con_fin = unos * (unsigned char) '\n';
+  for (int i = 0; i < CSV_BLOQUE; i += 8) {
+    uint64_t palabra;
+    memcpy(&palabra, inicio + i, sizeof(palabra));
+    uint64_t a = palabra ^ con_delim;
+    uint64_t b = palabra ^ con_fin;
+    if (((a - unos) & ~a & altos) | ((b - unos) & ~b & altos)) {
+      for (int j = i; j < i + 8; j++) {
+        if (inicio[j] == delim || inicio[j] == '\n') {
+          mascara |= (uint64_t) 1 << j;
+        }
+      }
+    }
+  }
+#endif
+  return mascara & validos;
+}
+
+size_t csv_indexar(const char *inicio, size_t largo, char delim, size_t posiciones[]) {
+  size_t cant = 0;
+  for (size_t base = 0; base < largo; base += CSV_BLOQUE) {
+    uint64_t mascara = csv_separadores(inicio + base, largo - base, delim);
+    while (mascara) {
+      posiciones[cant++] = base + (size_t) csv_primer_bit(mascara);
+      mascara &= mascara - 1;
+    }
+  }
+  return cant;
+}
+
+// Si los ocho bytes de 'palabra' son dígitos, guarda en 'valor' el número que
+// forman (el primer byte es el dígito más significativo) y devuelve true.
+// Pre: 'palabra' se leyó de memoria en una arquitectura little-endian.
+bool csv_ocho_digitos(uint64_t palabra, uint64_t *valor) {
+  // Cada byte entre '0' (0x30) y '9' (0x39): su mitad alta es 3, y sigue
+  // siéndolo al sumarle 6.
+  const uint64_t altos = 0xF0F0F0F0F0F0F0F0u;
+  const uint64_t treses = 0x3030303030303030u;
+  if ((palabra & altos) != treses || ((palabra + 0x0606060606060606u) & altos) != treses) {
+    return false;
+  }
+  // Se combinan los dígitos de a pares, luego de a cuatro y luego los ocho.
+  palabra -= treses;
+  palabra = (palabra * 10 + (palabra >> 8)) & 0x00FF00FF00FF00FFu;
+  palabra = (palabra * 100 + (palabra >> 16)) & 0x0000FFFF0000FFFFu;
+  palabra = (palabra * 10000 + (palabra >> 32)) & 0x00000000FFFFFFFFu;
+  *valor = palabra;
+  return true;
+}
+
+bool csv_campo_numero(csv_campo_t campo, unsigned long long *numero) {
+  const char *c = campo.inicio;
+  size_t largo = campo.largo;
+  if (largo == 0) {
+    return false;
+  }
+  // Los ceros a la izquierda no cuentan para el límite de dígitos.
+  while (largo > 1 && *c == '0') {
+    c++;
+    largo--;
+  }
+  // ULLONG_MAX tiene 20 dígitos: hasta 19 no hay desborde posible.
+  if (largo > 20) {
+    return false;
+  }
+  size_t hasta = largo == 20 ? 19 : largo;
+
+  uint64_t valor = 0;
+  size_t i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  for (; i + 8 <= hasta; i += 8) {
+    uint64_t palabra, ocho;
+    memcpy(&palabra, c + i, sizeof(palabra));
+    if (!csv_ocho_digitos(palabra, &ocho)) {
+      return false;
+    }
+    valor = valor * 100000000u + ocho;
+  }
+#endif
+  for (; i < hasta; i++) {
+    if (c[i] < '0' || c[i] > '9') {
+      return false;
+    }
+    valor = valor * 10 + (uint64_t) (c[i] - '0');
+  }
+  if (largo == 20) {
+    if (c[19] < '0' || c[19] > '9') {
+      return false;
+    }
+    uint64_t digito = (uint64_t) (c[19] - '0');
+    if (valor > (ULLONG_MAX - digito) / 10) {
+      return false;
+    }
+    valor = valor * 10 + digito;
+  }
+  *numero = valor;
+  return true;
+}
+
+// Divide en su lugar una línea de 'largo' bytes en dos cadenas: hasta el
+// primer 'delim' y el resto (vacía si no lo tiene). Escribe un '\0' en
+// linea[largo], que es el '\n' en las líneas que lo tienen.
+void csv_dividir(char *linea, size_t largo, char delim, char **primero, char **segundo) {
+  linea[largo] = '\0';
+  *primero = linea;
+  *segundo = linea + largo;
+  for (size_t base = 0; base < largo; base += CSV_BLOQUE) {
+    uint64_t mascara = csv_separadores(linea + base, largo - base, delim);
+    if (mascara) {
+      char *sep = linea + base + csv_primer_bit(mascara);
+      *sep = '\0';
+      *segundo = sep + 1;
+      break;
+    }
+  }
+}
 
 void csv_terminar(csv_t *linea) {
   if (linea)
@@ -16,14 +200,82 @@ bool csv_siguiente(csv_t *l, FILE *fp) {
     return false;
   }
 
-  l->_buffer[n-1] = '\0'; // Eliminar el '\n' del final.
-  l->primero = l->_buffer;
+  // Eliminar el '\n' del final, si lo tiene, y dividir en dos cadenas.
+  if (l->_buffer[n - 1] == '\n') {
+    n--;
+  }
+  csv_dividir(l->_buffer, (size_t) n, l->delim, &l->primero, &l->segundo);
+  return true;
+}
 
-  split(l->delim, l->primero, &l->segundo);
+bool csv_flujo_siguiente(csv_flujo_t *f) {
+  if (!f->_buffer) {
+    f->_buffer = malloc(CSV_FLUJO);
+    if (!f->_buffer) {
+      return false;
+    }
+    f->_tam = CSV_FLUJO;
+  }
 
+  // Se busca el fin de la línea en lo ya leído; si no está, se mueve la
+  // línea incompleta al principio del buffer y se lee otro bloque a
+  // continuación.
+  size_t revisado = f->_inicio;
+  char *fin;
+  while (!(fin = memchr(f->_buffer + revisado, '\n', f->_fin - revisado))) {
+    revisado = f->_fin;
+    if (f->_fin_archivo) {
+      break;
+    }
+    // Antes de mover nada: las líneas ya devueltas siguen siendo válidas
+    if (f->antes_de_leer) {
+      f->antes_de_leer(f->extra);
+    }
+    if (f->_inicio > 0) {
+      memmove(f->_buffer, f->_buffer + f->_inicio, f->_fin - f->_inicio);
+      revisado -= f->_inicio;
+      f->_fin -= f->_inicio;
+      f->_inicio = 0;
+    }
+    // Siempre queda un byte libre después de lo leído, para el '\0' de una
+    // última línea sin '\n'
+    if (f->_fin + 1 == f->_tam) {
+      char *buffer = realloc(f->_buffer, 2 * f->_tam);
+      if (!buffer) {
+        return false;
+      }
+      f->_buffer = buffer;
+      f->_tam *= 2;
+    }
+    ssize_t n = read(f->fd, f->_buffer + f->_fin, f->_tam - f->_fin - 1);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      f->_fin_archivo = true;
+    } else {
+      f->_fin += (size_t) n;
+    }
+  }
+  if (!fin && f->_inicio == f->_fin) {
+    return false;
+  }
+
+  // Como en csv_siguiente(), se quita el '\n' si la línea lo tiene.
+  char *linea = f->_buffer + f->_inicio;
+  size_t n = fin ? (size_t) (fin - linea) : f->_fin - f->_inicio;
+  f->_inicio += fin ? n + 1 : n;
+  csv_dividir(linea, n, f->delim, &f->primero, &f->segundo);
   return true;
 }
 
+void csv_flujo_terminar(csv_flujo_t *f) {
+  if (f) {
+    free(f->_buffer);
+    f->_buffer = NULL;
+  }
+}
+
 void split(char c, char* string, char** resto) {
   char *pos = strchr(string, c);
 
@@ -34,3 +286,197 @@ void split(char c, char* string, char** resto) {
     *resto = pos;
   }
 }
+
+// Lee 'tam' bytes del archivo en 'destino', aunque read() los entregue de a
+// partes. Devuelve false si hubo un error o el archivo se achicó.
+bool csv_leer_todo(int fd, char *destino, size_t tam) {
+  size_t leidos = 0;
+  while (leidos < tam) {
+    ssize_t n = read(fd, destino + leidos, tam - leidos);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    leidos += (size_t) n;
+  }
+  return true;
+}
+
+bool csv_mapa_abrir(csv_mapa_t *m, const char* ruta) {
+  m->_mapa = NULL;
+  m->_tam = 0;
+  m->_pos = 0;
+  m->_trozo = false;
+  m->linea = 0;
+  m->_indice = NULL;
+  m->_cant_indice = 0;
+  m->_prox_indice = 0;
+  m->_ventana = 0;
+  m->_escaneado = 0;
+
+  int fd = open(ruta, O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    return false;
+  }
+  m->_tam = (size_t) st.st_size;
+  if (m->_tam > 0) {
+    // Un byte más, que termina la última línea aunque no tenga '\n'
+    m->_mapa = malloc(m->_tam + 1);
+    if (!m->_mapa || !csv_leer_todo(fd, m->_mapa, m->_tam)) {
+      free(m->_mapa);
+      m->_mapa = NULL;
+      close(fd);
+      return false;
+    }
+    m->_mapa[m->_tam] = '\0';
+  }
+  close(fd);
+  return true;
+}
+
+// Obtiene la posición del próximo separador o fin de línea sin leer, o el
+// tamaño del archivo si no hay más. Cuando se terminan los ya encontrados,
+// indexa los de los siguientes CSV_VENTANA bytes en una sola pasada.
+// Post: devuelve false si no hubo memoria para el índice.
+static inline bool csv_mapa_proximo(csv_mapa_t *m, size_t *pos) {
+  while (m->_prox_indice == m->_cant_indice) {
+    if (m->_escaneado >= m->_tam) {
+      *pos = m->_tam;
+      return true;
+    }
+    if (!m->_indice) {
+      m->_indice = malloc(CSV_VENTANA * sizeof(size_t));
+      if (!m->_indice) {
+        return false;
+      }
+    }
+    size_t largo = m->_tam - m->_escaneado;
+    if (largo > CSV_VENTANA) {
+      largo = CSV_VENTANA;
+    }
+    m->_ventana = m->_escaneado;
+    m->_cant_indice = csv_indexar(m->_mapa + m->_ventana, largo, m->delim, m->_indice);
+    m->_prox_indice = 0;
+    m->_escaneado += largo;
+  }
+  *pos = m->_ventana + m->_indice[m->_prox_indice++];
+  return true;
+}
+
+// Obtiene las posiciones del separador (o del fin de línea, si la línea no
+// lo tiene) y del fin de línea de la línea actual. Post: devuelve false si no
+// hubo memoria para el índice.
+static inline bool csv_mapa_buscar_linea(csv_mapa_t *m, size_t *pos_sep, size_t *pos_fin) {
+  // Lo más común es que la línea tenga un único separador y que ya esté
+  // indexada entera: sus dos posiciones son las próximas del índice.
+  size_t k = m->_prox_indice;
+  if (k + 1 < m->_cant_indice && m->_mapa[m->_ventana + m->_indice[k]] == m->delim &&
+      m->_mapa[m->_ventana + m->_indice[k + 1]] == '\n') {
+    *pos_sep = m->_ventana + m->_indice[k];
+    *pos_fin = m->_ventana + m->_indice[k + 1];
+    m->_prox_indice = k + 2;
+    return true;
+  }
+
+  // Si no, el primer separador o fin de línea termina el primer campo, y si
+  // era el separador, los demás hasta el fin de línea son parte del segundo.
+  if (!csv_mapa_proximo(m, pos_sep)) {
+    return false;
+  }
+  *pos_fin = *pos_sep;
+  while (*pos_fin < m->_tam && m->_mapa[*pos_fin] != '\n') {
+    if (!csv_mapa_proximo(m, pos_fin)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool csv_mapa_siguiente(csv_mapa_t *m) {
+  if (m->_pos >= m->_tam) {
+    return false;
+  }
+
+  size_t pos_sep, pos_fin;
+  if (!csv_mapa_buscar_linea(m, &pos_sep, &pos_fin)) {
+    return false;
+  }
+  char *inicio = m->_mapa + m->_pos;
+  char *sep = pos_sep < pos_fin ? m->_mapa + pos_sep : NULL;
+  char *fin = m->_mapa + pos_fin;
+
+  // En la última línea sin '\n', el '\0' va en el byte que sobra al final
+  // del buffer
+  m->_pos = pos_fin < m->_tam ? pos_fin + 1 : m->_tam;
+  *fin = '\0';
+  m->linea++;
+
+  m->primero.inicio = inicio;
+  if (sep) {
+    *sep = '\0';
+    m->primero.largo = (size_t) (sep - inicio);
+    m->segundo.inicio = sep + 1;
+    m->segundo.largo = (size_t) (fin - sep - 1);
+  } else {
+    m->primero.largo = (size_t) (fin - inicio);
+    m->segundo.inicio = fin;
+    m->segundo.largo = 0;
+  }
+  return true;
+}
+
+void csv_mapa_cerrar(csv_mapa_t *m) {
+  if (!m) {
+    return;
+  }
+  if (!m->_trozo) {
+    free(m->_mapa);
+  }
+  free(m->_indice);
+  m->_mapa = NULL;
+  m->_indice = NULL;
+}
+
+size_t csv_mapa_partir(const csv_mapa_t *m, csv_mapa_t trozos[], size_t cant, size_t tam_minimo) {
+  size_t desde = m->_pos;
+  size_t n = 0;
+
+  if (tam_minimo > 0 && (m->_tam - desde) / tam_minimo < cant) {
+    cant = (m->_tam - desde) / tam_minimo;
+    if (cant == 0) {
+      cant = 1;
+    }
+  }
+
+  while (n < cant && desde < m->_tam) {
+    // El trozo termina en el primer '\n' a partir de su parte proporcional
+    // de lo que queda; el último llega hasta el final del archivo.
+    size_t hasta = m->_tam;
+    if (n + 1 < cant) {
+      size_t corte = desde + (m->_tam - desde) / (cant - n);
+      char *fin = corte > desde ? memchr(m->_mapa + corte - 1, '\n', m->_tam - corte + 1) : NULL;
+      if (fin) {
+        hasta = (size_t) (fin - m->_mapa) + 1;
+      }
+    }
+    trozos[n] = *m;
+    trozos[n]._pos = desde;
+    trozos[n]._tam = hasta;
+    trozos[n]._trozo = true;
+    trozos[n].linea = 0;
+    trozos[n]._indice = NULL;
+    trozos[n]._cant_indice = 0;
+    trozos[n]._prox_indice = 0;
+    trozos[n]._escaneado = desde;
+    desde = hasta;
+    n++;
+  }
+  return n;
+}
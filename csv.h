@@ -2,11 +2,17 @@
 #define CSV_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
 /* Función para leer un archivo CSV o similar de dos columnas. Al crear
    el parser, se indica cuál es el caracter de separación.
 
+   Las tres formas de lectura (csv_siguiente(), csv_flujo_siguiente() y
+   csv_mapa_siguiente()) quitan el '\n' de cada línea, y devuelven completa
+   una última línea que no lo tiene.
+
 Uso
 ===
 
@@ -46,6 +52,130 @@ typedef struct {
 bool csv_siguiente(csv_t *linea, FILE* fp);
 void csv_terminar(csv_t *linea);
 
+/* Lectura de a líneas igual que csv_siguiente(), pero sin copiarlas: se lee
+   el descriptor de archivo de a bloques grandes en un único buffer, y cada
+   línea se divide en su lugar dentro de él. 'primero' y 'segundo' apuntan al
+   buffer, y son válidos hasta la siguiente llamada. El buffer se reserva en
+   la primera llamada y sólo vuelve a reservarse si una línea no entra en él.
+   Si 'antes_de_leer' no es NULL, se llama con 'extra' antes de cada read(),
+   que puede bloquearse esperando datos (por ejemplo, para vaciar antes la
+   salida en un programa interactivo). Cuando se llama, las líneas ya
+   devueltas siguen siendo válidas.
+
+Uso
+===
+
+    csv_flujo_t cmd = {.delim = ':', .fd = STDIN_FILENO};
+
+    while (csv_flujo_siguiente(&cmd)) {
+      printf("Nombre comando: %s\n", cmd.primero);
+      printf("Parámetros comando: %s\n", cmd.segundo);
+    }
+
+    csv_flujo_terminar(&cmd);
+*/
+
+typedef struct {
+  char delim;
+  int fd;
+  char* primero;
+  char* segundo;
+  char* _buffer;
+  size_t _tam;
+  size_t _inicio;        // Primer byte sin devolver
+  size_t _fin;           // Fin de lo leído
+  void (*antes_de_leer)(void* extra);
+  void* extra;
+  bool _fin_archivo;
+} csv_flujo_t;
+
+bool csv_flujo_siguiente(csv_flujo_t *flujo);
+void csv_flujo_terminar(csv_flujo_t *flujo);
+
+/* Lectura de un archivo completo, que se carga en memoria de una sola vez.
+   Los campos se devuelven como vistas (puntero y largo) dentro de esa copia,
+   sin copiar ninguna línea por separado. Se escribe un '\0' en lugar de
+   cada separador y de cada fin de línea, de modo que cada campo es además
+   una cadena de C válida. Las vistas siguen siendo válidas hasta llamar a
+   csv_mapa_cerrar(), aunque el archivo se modifique o se trunque mientras
+   tanto (cosa que no sucedería con una proyección mmap() del archivo).
+
+Uso
+===
+
+    csv_mapa_t mapa = {.delim = ','};
+    if (!csv_mapa_abrir(&mapa, "doctores.csv")) ...
+
+    while (csv_mapa_siguiente(&mapa)) {
+      printf("Línea %zu: %s (%zu bytes)\n", mapa.linea, mapa.primero.inicio, mapa.primero.largo);
+    }
+
+    csv_mapa_cerrar(&mapa);
+
+Para leer el archivo desde varios hilos, csv_mapa_partir() lo divide en
+trozos que terminan en un fin de línea. Cada trozo es a su vez un csv_mapa_t
+que se recorre con csv_mapa_siguiente() de forma independiente (su número de
+línea cuenta desde el principio del trozo), y que debe cerrarse con
+csv_mapa_cerrar() antes de cerrar el original.
+
+    csv_mapa_t trozos[4];
+    size_t cant = csv_mapa_partir(&mapa, trozos, 4, 1 << 20);
+*/
+
+typedef struct {
+  const char* inicio;
+  size_t largo;
+} csv_campo_t;
+
+typedef struct {
+  char delim;
+  csv_campo_t primero;
+  csv_campo_t segundo;
+  size_t linea;          // Número de la línea actual, empezando en 1.
+  char* _mapa;           // Contenido del archivo, seguido de un byte más.
+  size_t _tam;
+  size_t _pos;
+  bool _trozo;           // El contenido pertenece a otro csv_mapa_t.
+  size_t* _indice;       // Separadores y fines de línea de la ventana actual,
+  size_t _cant_indice;   // relativos a su inicio (ver csv_indexar()).
+  size_t _prox_indice;
+  size_t _ventana;       // Inicio de la ventana indexada.
+  size_t _escaneado;     // Hasta dónde se indexó el archivo.
+} csv_mapa_t;
+
+bool csv_mapa_abrir(csv_mapa_t *mapa, const char* ruta);
+bool csv_mapa_siguiente(csv_mapa_t *mapa);
+void csv_mapa_cerrar(csv_mapa_t *mapa);
+
+// Divide lo que falta leer del archivo en hasta 'cant' trozos de tamaño
+// similar y de al menos 'tam_minimo' bytes, cortando siempre después de un
+// '\n'. Devuelve la cantidad de trozos generados, que puede ser menor si el
+// archivo es chico o las líneas son muy largas.
+size_t csv_mapa_partir(const csv_mapa_t *mapa, csv_mapa_t trozos[], size_t cant, size_t tam_minimo);
+
+// Divide en su lugar una línea de 'largo' bytes en dos cadenas: hasta el
+// primer 'delim' y el resto (vacía si no lo tiene). Escribe un '\0' en
+// linea[largo], que es el '\n' en las líneas que lo tienen.
+void csv_dividir(char *linea, size_t largo, char delim, char **primero, char **segundo);
+
+// Devuelve una máscara con el bit i encendido si inicio[i] es 'delim' o
+// '\n', para los primeros min(largo, 64) bytes. Compara de a 16 bytes con
+// SSE2, de a 32 si se compila con AVX2, y de a 8 (SWAR) en otras
+// arquitecturas. No lee fuera de [inicio, inicio + largo).
+uint64_t csv_separadores(const char* inicio, size_t largo, char delim);
+
+// Guarda en 'posiciones', en orden, la posición (relativa a 'inicio') de
+// cada 'delim' y cada '\n' de [inicio, inicio + largo), recorriendo el texto
+// una sola vez. Devuelve la cantidad encontrada.
+// Pre: 'posiciones' tiene lugar para 'largo' elementos.
+size_t csv_indexar(const char* inicio, size_t largo, char delim, size_t posiciones[]);
+
+// Convierte un campo formado sólo por dígitos decimales (al menos uno) en un
+// número. Devuelve false, sin modificar 'numero', si el campo tiene algún
+// otro carácter (signo, espacios, etc.) o si el número no entra en un
+// unsigned long long. Convierte de a ocho dígitos por vez (SWAR).
+bool csv_campo_numero(csv_campo_t campo, unsigned long long* numero);
+
 // Trunca una cadena en la primera ocurrencia de un determinado carácter, y
 // apunta "resto" al resto. Si el carácter no está presente en la función,
 // "resto" es la cadena vacía. Esta función *no* reserva memoria.
@@ -2,6 +2,7 @@
 #include <string.h>
 #include "hash.h"
 #include "lista.h"
+#include "pool.h"
 #include <stdio.h>
 
 #define TAM_INICIAL 5
@@ -17,6 +18,9 @@ struct hash {
 	size_t cantidad;
 	size_t tamanio;
 	hash_destruir_dato_t destruir_dato;
+	bool copiar_claves;   // false si las claves son prestadas (ver hash_crear_con_claves_prestadas)
+	size_t redimensiones;
+	pool_t* pool;    // Listas de la tabla, sus nodos y los nodos del hash
 };
 
 struct hash_iter{
@@ -30,8 +34,8 @@ struct hash_iter{
  ***********************************/
 
 // Crea un nuevo nodo del hash
-nodo_hash_t* nodo_hash_crear(char *clave, void *dato) {
-	nodo_hash_t* nodo_hash = malloc(sizeof(nodo_hash_t));
+nodo_hash_t* nodo_hash_crear(hash_t *hash, char *clave, void *dato) {
+	nodo_hash_t* nodo_hash = pool_pedir(hash->pool);
 	if (!nodo_hash) return NULL;
 	nodo_hash->clave = clave;
 	nodo_hash->valor = dato;
@@ -55,33 +59,41 @@ unsigned long int fhash(const char* clave, size_t tam) {
 	return hash%tam;
 }
 
-// Devuelve el nodo si la clave existe en la lista hash->tabla[pos_vect], NULL si no
+// Búsqueda de una clave en una lista de la tabla, con lista_iterar
+typedef struct busqueda {
+	const char* clave;
+	nodo_hash_t* nodo;   // NULL mientras no se encontró
+} busqueda_t;
+
+// Función de visita de nodo_en_lista: termina al encontrar la clave
+// (con claves internadas, basta comparar los punteros).
+bool visitar_nodo(void* dato, void* extra) {
+	nodo_hash_t* nodo = dato;
+	busqueda_t* busqueda = extra;
+	if (nodo->clave != busqueda->clave && strcmp(nodo->clave, busqueda->clave) != 0) return true;
+	busqueda->nodo = nodo;
+	return false;
+}
+
+// Devuelve el nodo si la clave existe en la lista hash->tabla[pos_vect], NULL si no.
+// Recorre la lista sin crear un iterador, para no reservar memoria en cada búsqueda.
 nodo_hash_t* nodo_en_lista(const hash_t *hash, const char *clave, size_t *pos_vect) {
-	lista_iter_t* iter = lista_iter_crear(hash->tabla[*pos_vect]);
-	nodo_hash_t* nodo;
-	bool pertenece = false;
-	while (!lista_iter_al_final(iter)) {
-		nodo = lista_iter_ver_actual(iter);
-		// Si la clave del nodo es igual a la pasada por parámetro termino el ciclo
-		if (strcmp(nodo->clave, clave) == 0){ 
-			pertenece = true;
-			break;
-		}
-		lista_iter_avanzar(iter);
-	}
-	lista_iter_destruir(iter);
-	if (pertenece) return nodo;
-	return NULL;
+	busqueda_t busqueda = {clave, NULL};
+	lista_iterar(hash->tabla[*pos_vect], visitar_nodo, &busqueda);
+	return busqueda.nodo;
 }
 
 // Reemplaza el dato de una clave del hash por otro dato pasado
 // como parámetro. En caso de no encontrar la clave, devuelve false.
+// Con claves prestadas, el nodo pasa a usar la clave recibida, ya que
+// la anterior puede pertenecer al dato que se destruye.
 bool hash_reemplazar(hash_t *hash, const char *clave, void *dato) {
 	size_t pos_vect = fhash(clave, hash->tamanio);
 	nodo_hash_t* nodo = nodo_en_lista(hash, clave, &pos_vect);
 	if (!nodo) return false;
 	if (hash->destruir_dato) hash->destruir_dato(nodo->valor);
 	nodo->valor = dato;
+	if (!hash->copiar_claves) nodo->clave = (char*) clave;
 	return true;
 }
 
@@ -93,7 +105,7 @@ bool hash_redimensionar(hash_t* hash) {
 	
 	// Creo una nueva lista por cada posición de la nueva tabla
 	for (unsigned int i = 0; i < nuevo_tamanio; i++) {
-		nueva_tabla[i] = lista_crear();
+		nueva_tabla[i] = lista_crear_con_pool(hash->pool);
 	}
 	// Saco los nodos del hash anterior, los vuelvo a hashear y los inserto
 	// en el nuevo hash
@@ -110,6 +122,7 @@ bool hash_redimensionar(hash_t* hash) {
 	free(hash->tabla);
 	hash->tabla = nueva_tabla;
 	hash->tamanio = nuevo_tamanio;
+	hash->redimensiones++;
 	return true;
 }
 
@@ -123,21 +136,37 @@ hash_t *hash_crear(hash_destruir_dato_t destruir_dato) {
 	hash_t* hash = malloc(sizeof(hash_t));
 	if (!hash) return NULL;
 	
+	// Las listas, sus nodos y los nodos del hash se piden a un mismo pool,
+	// para que cada nodo del hash quede junto al nodo de lista que lo guarda
+	hash->pool = lista_pool_crear();
+	
 	// Genero una tabla inicializada con ceros
 	lista_t** tabla = calloc(TAM_INICIAL, sizeof(lista_t*));
-	if (!tabla) {
+	if (!tabla || !hash->pool) {
+		pool_destruir(hash->pool);
+		free(tabla);
 		free(hash);
 		return NULL;
 	}
 	
 	// Genero una lista por cada posición de la tabla
 	for (unsigned int i = 0; i < TAM_INICIAL; i++){
-		tabla[i] = lista_crear();
+		tabla[i] = lista_crear_con_pool(hash->pool);
 	}
 	hash->tabla = tabla;
 	hash->destruir_dato = destruir_dato;
+	hash->copiar_claves = true;
 	hash->cantidad = 0;
 	hash->tamanio = TAM_INICIAL;
+	hash->redimensiones = 0;
+	return hash;
+}
+
+/* Crea un hash que no copia las claves
+ */
+hash_t *hash_crear_con_claves_prestadas(hash_destruir_dato_t destruir_dato) {
+	hash_t* hash = hash_crear(destruir_dato);
+	if (hash) hash->copiar_claves = false;
 	return hash;
 }
 
@@ -153,16 +182,21 @@ bool hash_guardar(hash_t *hash, const char *clave, void *dato) {
 	}
 	// Obtengo la posición del vector donde guardar el nodo
 	size_t pos_vect = fhash(clave, hash->tamanio);
-	// Creo una copia de la clave en caso de que la modifiquen desde afuera
-	char *clave_copia = strcpy(malloc(strlen(clave) + 1), clave);
 	// Reemplazo en caso de que la clave pertenezca al hash
-	if (hash_reemplazar(hash, clave_copia, dato)) {
-		free(clave_copia);
-		return true;
+	if (hash_reemplazar(hash, clave, dato)) return true;
+	// Creo una copia de la clave en caso de que la modifiquen desde afuera
+	char *clave_copia = (char*) clave;
+	if (hash->copiar_claves) {
+		clave_copia = malloc(strlen(clave) + 1);
+		if (!clave_copia) return false;
+		strcpy(clave_copia, clave);
 	}
 	// Genero un nuevo nodo del hash
-	nodo_hash_t* nodo = nodo_hash_crear(clave_copia, dato);
-	if (!nodo) return false;
+	nodo_hash_t* nodo = nodo_hash_crear(hash, clave_copia, dato);
+	if (!nodo) {
+		if (hash->copiar_claves) free(clave_copia);
+		return false;
+	}
 	
 	// Inserto el nodo en la lista correspondiente
 	lista_insertar_primero(hash->tabla[pos_vect], nodo);
@@ -188,8 +222,8 @@ void *hash_borrar(hash_t *hash, const char *clave) {
 		if (strcmp(nodo_actual->clave, clave) == 0) {
 			lista_borrar(hash->tabla[pos_vect], iter);
 			dato = nodo_actual->valor;
-			free(nodo_actual->clave);
-			free(nodo_actual);
+			if (hash->copiar_claves) free(nodo_actual->clave);
+			pool_devolver(hash->pool, nodo_actual);
 			hash->cantidad--;
 			break;
 		}
@@ -228,23 +262,35 @@ size_t hash_cantidad(const hash_t *hash) {
 	return hash->cantidad;
 }
 
+/* Devuelve la cantidad de veces que se agrandó la tabla del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_redimensiones(const hash_t *hash) {
+	return hash->redimensiones;
+}
+
 /* Destruye la estructura liberando la memoria pedida y llamando a la función
  * destruir para cada par (clave, dato).
  * Pre: La estructura hash fue inicializada
  * Post: La estructura hash fue destruida
  */
 void hash_destruir(hash_t *hash) {
-	size_t largo = hash->tamanio;
-	for (int i = 0; i < largo; i++) {
-		while (!lista_esta_vacia(hash->tabla[i])){
-			nodo_hash_t* nodo = lista_borrar_primero(hash->tabla[i]);
-			if (hash->destruir_dato != NULL)
-				hash->destruir_dato(nodo->valor);
-			free(nodo->clave);
-			free(nodo);
+	// Las listas y los nodos están en el pool: la tabla sólo se recorre si
+	// hay que liberar algo de cada par
+	if (hash->destruir_dato != NULL || hash->copiar_claves) {
+		size_t largo = hash->tamanio;
+		for (int i = 0; i < largo; i++) {
+			while (!lista_esta_vacia(hash->tabla[i])){
+				nodo_hash_t* nodo = lista_borrar_primero(hash->tabla[i]);
+				if (hash->destruir_dato != NULL)
+					hash->destruir_dato(nodo->valor);
+				if (hash->copiar_claves) free(nodo->clave);
+			}
+			lista_destruir(hash->tabla[i], NULL);
 		}
-		lista_destruir(hash->tabla[i], NULL);
 	}
+	// Los nodos se liberan todos juntos con el pool
+	pool_destruir(hash->pool);
 	free(hash->tabla);
 	free(hash);
 }
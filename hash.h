@@ -18,6 +18,14 @@ typedef void (*hash_destruir_dato_t)(void *);
  */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
 
+/* Crea un hash que guarda las claves tal como las recibe, sin copiarlas.
+ * Las claves deben seguir siendo válidas mientras estén en el hash; al
+ * reemplazar el dato de una clave, el hash pasa a usar la nueva.
+ * Sirve para claves que ya viven en otro lado (por ejemplo, cadenas
+ * internadas), y las búsquedas con el mismo puntero evitan el strcmp.
+ */
+hash_t *hash_crear_con_claves_prestadas(hash_destruir_dato_t destruir_dato);
+
 /* Guarda un elemento en el hash, si la clave ya se encuentra en la
  * estructura, la reemplaza. De no poder guardarlo devuelve false.
  * Pre: La estructura hash fue inicializada
@@ -49,6 +57,11 @@ bool hash_pertenece(const hash_t *hash, const char *clave);
  */
 size_t hash_cantidad(const hash_t *hash);
 
+/* Devuelve la cantidad de veces que se agrandó la tabla del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_redimensiones(const hash_t *hash);
+
 /* Destruye la estructura liberando la memoria pedida y llamando a la función
  * destruir para cada par (clave, dato).
  * Pre: La estructura hash fue inicializada
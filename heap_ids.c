@@ -0,0 +1,107 @@
+#include "heap_ids.h"
+#include <stdlib.h>
+
+#define TAM_INICIAL 5
+#define AUMENTAR_TAM 3
+
+		// Definicion estructuras //
+
+struct heap_ids{
+	size_t cantidad;
+	size_t tamanio;
+	uint32_t* tabla_heap;
+	const uint64_t* const* claves;
+};
+
+		// Funciones Auxiliares //
+
+/* Sube el elemento de la posicion pasada mientras su clave sea mayor
+ * que la de su padre.
+ */
+void heap_ids_subir(heap_ids_t* heap, size_t pos_actual){
+	const uint64_t* claves = *heap->claves;
+	uint32_t actual = heap->tabla_heap[pos_actual];
+	while (pos_actual > 0){
+		size_t pos_padre = (pos_actual - 1) / 2;
+		uint32_t padre = heap->tabla_heap[pos_padre];
+		if (claves[actual] <= claves[padre]) break;
+		heap->tabla_heap[pos_actual] = padre;
+		pos_actual = pos_padre;
+	}
+	heap->tabla_heap[pos_actual] = actual;
+}
+
+/* Baja el elemento de la posicion pasada mientras su clave sea menor que
+ * la del mayor de sus hijos (ante hijos iguales, el derecho).
+ */
+void heap_ids_bajar(heap_ids_t* heap, size_t pos_actual){
+	const uint64_t* claves = *heap->claves;
+	uint32_t actual = heap->tabla_heap[pos_actual];
+	while (true){
+		size_t pos_hijo = 2 * pos_actual + 1;
+		if (pos_hijo >= heap->cantidad) break; // Final del arbol
+		size_t pos_der = pos_hijo + 1;
+		if (pos_der < heap->cantidad && claves[heap->tabla_heap[pos_hijo]] <= claves[heap->tabla_heap[pos_der]])
+			pos_hijo = pos_der;
+		uint32_t hijo_mayor = heap->tabla_heap[pos_hijo];
+		if (claves[actual] >= claves[hijo_mayor]) break;
+		heap->tabla_heap[pos_actual] = hijo_mayor;
+		pos_actual = pos_hijo;
+	}
+	heap->tabla_heap[pos_actual] = actual;
+}
+
+		// Primitivas Heap //
+
+heap_ids_t* heap_ids_crear(const uint64_t* const* claves){
+	heap_ids_t* heap = malloc(sizeof(heap_ids_t));
+	if (!heap) return NULL;
+	heap->tabla_heap = malloc(sizeof(uint32_t) * TAM_INICIAL);
+	if (!heap->tabla_heap){
+		free(heap);
+		return NULL;
+	}
+	heap->cantidad = 0;
+	heap->tamanio = TAM_INICIAL;
+	heap->claves = claves;
+	return heap;
+}
+
+void heap_ids_destruir(heap_ids_t* heap){
+	if (!heap) return;
+	free(heap->tabla_heap);
+	free(heap);
+}
+
+size_t heap_ids_cantidad(const heap_ids_t* heap){
+	return heap ? heap->cantidad : 0;
+}
+
+bool heap_ids_encolar(heap_ids_t* heap, uint32_t id){
+	if (heap->cantidad == heap->tamanio){
+		size_t nuevo_tam = heap->tamanio * AUMENTAR_TAM;
+		uint32_t* tabla_nueva = realloc(heap->tabla_heap, nuevo_tam * sizeof(uint32_t));
+		if (!tabla_nueva) return false;
+		heap->tabla_heap = tabla_nueva;
+		heap->tamanio = nuevo_tam;
+	}
+	heap->tabla_heap[heap->cantidad] = id;
+	heap_ids_subir(heap, heap->cantidad);
+	heap->cantidad++;
+	return true;
+}
+
+uint32_t heap_ids_desencolar(heap_ids_t* heap){
+	uint32_t maximo = heap->tabla_heap[0];
+	heap->cantidad--;
+	if (heap->cantidad > 0){
+		heap->tabla_heap[0] = heap->tabla_heap[heap->cantidad];
+		heap_ids_bajar(heap, 0);
+	}
+	return maximo;
+}
+
+const uint32_t* heap_ids_elementos(const heap_ids_t* heap, size_t* cantidad){
+	*cantidad = heap->cantidad;
+	return heap->tabla_heap;
+}
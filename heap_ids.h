@@ -0,0 +1,52 @@
+#ifndef HEAP_IDS_H
+#define HEAP_IDS_H
+
+#include <stdbool.h>  /* bool */
+#include <stddef.h>   /* size_t */
+#include <stdint.h>   /* uint32_t, uint64_t */
+
+/*
+ * Cola de prioridad de números de fila (ids de 4 bytes), usando un max-heap.
+ *
+ * La prioridad de cada id no se guarda en el heap sino en un arreglo aparte
+ * (una columna), indexado por el id: el heap recibe la dirección del puntero
+ * a ese arreglo, de modo que el arreglo puede agrandarse con realloc sin
+ * tener que avisarle. La prioridad de un id no debe cambiar mientras esté
+ * encolado.
+ *
+ * Los elementos se reordenan exactamente igual que en el TAD Heap (heap.h)
+ * con una función de comparación sobre las mismas claves, por lo que ante
+ * claves iguales se desencolan en el mismo orden.
+ */
+
+typedef struct heap_ids heap_ids_t;
+
+/* Crea un heap vacío cuyas prioridades están en (*claves)[id]. Devuelve
+ * NULL en caso de error.
+ */
+heap_ids_t *heap_ids_crear(const uint64_t *const *claves);
+
+/* Elimina el heap. */
+void heap_ids_destruir(heap_ids_t *heap);
+
+/* Devuelve la cantidad de elementos que hay en el heap (0 si es NULL). */
+size_t heap_ids_cantidad(const heap_ids_t *heap);
+
+/* Agrega un id al heap. Devuelve false si no hubo memoria.
+ * Pre: el heap fue creado, y (*claves)[id] es válido.
+ */
+bool heap_ids_encolar(heap_ids_t *heap, uint32_t id);
+
+/* Elimina el id con máxima prioridad y lo devuelve.
+ * Pre: el heap fue creado y no está vacío.
+ */
+uint32_t heap_ids_desencolar(heap_ids_t *heap);
+
+/* Devuelve los ids del heap en el orden de su arreglo, y guarda su cantidad
+ * en 'cantidad'. Encolarlos en ese orden en un heap vacío con las mismas
+ * claves vuelve a armar el mismo arreglo, sin mover ninguno.
+ * Pre: el heap fue creado. El arreglo deja de ser válido al modificar el heap.
+ */
+const uint32_t *heap_ids_elementos(const heap_ids_t *heap, size_t *cantidad);
+
+#endif // HEAP_IDS_H
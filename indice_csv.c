@@ -0,0 +1,331 @@
+#define _POSIX_C_SOURCE 200809L  // Para pread(), mmap() y st_mtim.
+
+#include "indice_csv.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define INDICE_MAGIA "CSVINDX"       // Con su '\0', ocupa los 8 bytes de la cabecera
+#define INDICE_VERSION 1
+#define INDICE_ORDEN_BYTES 0x01020304u
+#define TAM_LECTURA (1 << 20)        // Bytes que se leen por vez al armar el índice
+#define TAM_LINEA 256                // Capacidad inicial del buffer de una línea
+#define ENTRADAS_INICIAL 1024
+
+// Constantes de FNV-1a (64 bits), usadas para las huellas
+#define FNV_BASE 0xcbf29ce484222325u
+#define FNV_PRIMO 0x100000001b3u
+
+/* *****************************************************************
+ *                   DEFINICION TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct indice_entrada {
+	uint64_t huella;
+	uint64_t posicion;
+} indice_entrada_t;
+
+/* El archivo del índice es la cabecera seguida de las entradas, ordenadas
+ * por huella y, ante huellas iguales, por posición. No lleva suma de
+ * verificación, para no tener que recorrerlo entero al abrirlo: cada
+ * búsqueda compara el nombre con el de la línea que lee del archivo, así que
+ * un índice dañado puede no encontrar un nombre, pero nunca da la línea de
+ * otro. */
+
+typedef struct indice_cabecera {
+	char magia[8];
+	uint32_t version;
+	uint32_t orden_bytes;        // INDICE_ORDEN_BYTES en el orden de la máquina
+	uint64_t delim;
+	uint64_t tam_archivo;        // Tamaño y fecha de modificación del CSV
+	int64_t segundos;
+	int64_t nanosegundos;
+	uint64_t cantidad;
+} indice_cabecera_t;
+
+struct indice_csv {
+	int fd;                      // Archivo CSV, abierto para leer las líneas
+	char delim;
+	uint64_t tam_archivo;
+	int64_t segundos;
+	int64_t nanosegundos;
+	const indice_entrada_t* entradas;
+	size_t cantidad;
+	indice_entrada_t* propias;   // Entradas armadas en memoria, NULL si se proyectó
+	void* mapa;                  // Índice guardado proyectado, NULL si se armó
+	size_t tam_mapa;
+	char* linea;                 // Última línea leída del archivo
+	size_t cap_linea;
+};
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Función de hashing de los nombres (FNV-1a).
+uint64_t indice_fhash(const char* nombre, size_t largo) {
+	uint64_t hash = FNV_BASE;
+	for (size_t i = 0; i < largo; i++)
+		hash = (hash ^ (unsigned char) nombre[i]) * FNV_PRIMO;
+	return hash;
+}
+
+// Función que compara dos entradas por huella y posición, para ordenarlas con qsort.
+int indice_comparar_entradas(const void* a, const void* b) {
+	const indice_entrada_t* x = a;
+	const indice_entrada_t* y = b;
+	if (x->huella != y->huella) return x->huella < y->huella ? -1 : 1;
+	if (x->posicion != y->posicion) return x->posicion < y->posicion ? -1 : 1;
+	return 0;
+}
+
+// Crea un índice vacío para el archivo 'ruta', abriéndolo y guardando su
+// tamaño y fecha de modificación. Devuelve NULL si no se pudo abrir.
+indice_csv_t* indice_nuevo(const char* ruta, char delim) {
+	indice_csv_t* indice = calloc(1, sizeof(indice_csv_t));
+	if (!indice) return NULL;
+	indice->fd = open(ruta, O_RDONLY);
+	struct stat info;
+	if (indice->fd < 0 || fstat(indice->fd, &info) < 0) {
+		indice_csv_destruir(indice);
+		return NULL;
+	}
+	indice->delim = delim;
+	indice->tam_archivo = (uint64_t) info.st_size;
+	indice->segundos = (int64_t) info.st_mtim.tv_sec;
+	indice->nanosegundos = (int64_t) info.st_mtim.tv_nsec;
+	return indice;
+}
+
+// Agrega una entrada a las armadas en memoria. Devuelve false si no hubo memoria.
+bool indice_agregar(indice_csv_t* indice, size_t* capacidad, uint64_t huella, uint64_t posicion) {
+	if (indice->cantidad == *capacidad) {
+		size_t nueva = *capacidad ? *capacidad * 2 : ENTRADAS_INICIAL;
+		indice_entrada_t* propias = realloc(indice->propias, nueva * sizeof(indice_entrada_t));
+		if (!propias) return false;
+		indice->propias = propias;
+		*capacidad = nueva;
+	}
+	indice->propias[indice->cantidad].huella = huella;
+	indice->propias[indice->cantidad].posicion = posicion;
+	indice->cantidad++;
+	return true;
+}
+
+// Lee la línea que empieza en 'posicion' en el buffer del índice, de a
+// bloques hasta encontrar su fin, y la termina en '\0' en lugar del '\n'.
+// Devuelve false si no se pudo leer o no hubo memoria.
+bool indice_leer_linea(indice_csv_t* indice, uint64_t posicion) {
+	size_t largo = 0;
+	while (true) {
+		if (largo == indice->cap_linea) {
+			size_t capacidad = indice->cap_linea ? indice->cap_linea * 2 : TAM_LINEA;
+			char* linea = realloc(indice->linea, capacidad + 1);
+			if (!linea) return false;
+			indice->linea = linea;
+			indice->cap_linea = capacidad;
+		}
+		ssize_t leidos = pread(indice->fd, indice->linea + largo, indice->cap_linea - largo, (off_t) (posicion + largo));
+		if (leidos < 0 && errno == EINTR) continue;
+		if (leidos < 0) return false;
+		char* fin = memchr(indice->linea + largo, '\n', (size_t) leidos);
+		largo += (size_t) leidos;
+		if (fin || leidos == 0) {
+			if (fin) largo = (size_t) (fin - indice->linea);
+			indice->linea[largo] = '\0';
+			return true;
+		}
+	}
+}
+
+// Indexa la línea que empieza en la posición 'posicion' del archivo.
+// Devuelve false si la línea no tiene segundo campo (y termina la lectura).
+bool indice_procesar_linea(indice_csv_t* indice, char* inicio, char* fin, uint64_t posicion, size_t linea, indice_csv_filtro_t filtro, void* extra, size_t* capacidad, bool* error) {
+	*fin = '\0';
+	char* sep = memchr(inicio, indice->delim, (size_t) (fin - inicio));
+	if (!sep || sep + 1 == fin) return false;
+	*sep = '\0';
+	csv_campo_t primero = {inicio, (size_t) (sep - inicio)};
+	csv_campo_t segundo = {sep + 1, (size_t) (fin - sep - 1)};
+	if (filtro && !filtro(linea, primero, segundo, extra)) return true;
+	if (!indice_agregar(indice, capacidad, indice_fhash(primero.inicio, primero.largo), posicion)) *error = true;
+	return true;
+}
+
+// Escribe los 'tam' bytes de 'datos' a continuación en el archivo.
+bool indice_escribir(FILE* archivo, const void* datos, size_t tam) {
+	return tam == 0 || fwrite(datos, 1, tam, archivo) == tam;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ÍNDICE
+ * *****************************************************************/
+
+indice_csv_t* indice_csv_crear(const char* ruta, char delim, indice_csv_filtro_t filtro, void* extra) {
+	indice_csv_t* indice = indice_nuevo(ruta, delim);
+	if (!indice) return NULL;
+
+	// Se leen bloques de TAM_LECTURA bytes; la última línea incompleta de un
+	// bloque pasa al principio del siguiente, y el buffer se agranda sólo si
+	// una línea no entra entera (un byte más, para el '\0' del final)
+	size_t capacidad = 0;
+	size_t tam_buffer = TAM_LECTURA;
+	char* buffer = malloc(tam_buffer + 1);
+	size_t usados = 0;
+	uint64_t base = 0;             // Posición en el archivo de buffer[0]
+	size_t linea = 0;
+	bool fin_archivo = false;
+	bool cortado = false;
+	bool error = !buffer;
+	while (!error && !cortado && !fin_archivo) {
+		if (usados == tam_buffer) {
+			char* nuevo = realloc(buffer, 2 * tam_buffer + 1);
+			if (!nuevo) {
+				error = true;
+				break;
+			}
+			buffer = nuevo;
+			tam_buffer *= 2;
+		}
+		ssize_t leidos = read(indice->fd, buffer + usados, tam_buffer - usados);
+		if (leidos < 0 && errno == EINTR) continue;
+		if (leidos < 0) {
+			error = true;
+			break;
+		}
+		fin_archivo = leidos == 0;
+		usados += (size_t) leidos;
+
+		// Se procesan las líneas completas, y al final del archivo también la
+		// última aunque no tenga '\n'
+		size_t pos = 0;
+		while (pos < usados && !cortado && !error) {
+			char* fin = memchr(buffer + pos, '\n', usados - pos);
+			if (!fin && !fin_archivo) break;
+			if (!fin) fin = buffer + usados;
+			linea++;
+			if (!indice_procesar_linea(indice, buffer + pos, fin, base + pos, linea, filtro, extra, &capacidad, &error)) cortado = true;
+			pos = (size_t) (fin - buffer) + 1;
+		}
+		if (pos > usados) pos = usados;
+		memmove(buffer, buffer + pos, usados - pos);
+		usados -= pos;
+		base += pos;
+	}
+	free(buffer);
+	if (error) {
+		indice_csv_destruir(indice);
+		return NULL;
+	}
+	if (indice->cantidad) qsort(indice->propias, indice->cantidad, sizeof(indice_entrada_t), indice_comparar_entradas);
+	indice->entradas = indice->propias;
+	return indice;
+}
+
+indice_csv_t* indice_csv_abrir(const char* ruta_indice, const char* ruta, char delim) {
+	int fd = open(ruta_indice, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat info;
+	if (fstat(fd, &info) < 0 || info.st_size < (off_t) sizeof(indice_cabecera_t)) {
+		close(fd);
+		return NULL;
+	}
+	size_t tam = (size_t) info.st_size;
+	void* mapa = mmap(NULL, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapa == MAP_FAILED) return NULL;
+
+	indice_csv_t* indice = indice_nuevo(ruta, delim);
+	const indice_cabecera_t* cabecera = mapa;
+	if (!indice || memcmp(cabecera->magia, INDICE_MAGIA, sizeof(cabecera->magia)) != 0
+			|| cabecera->version != INDICE_VERSION || cabecera->orden_bytes != INDICE_ORDEN_BYTES
+			|| cabecera->delim != (uint64_t) (unsigned char) delim
+			|| cabecera->tam_archivo != indice->tam_archivo || cabecera->segundos != indice->segundos
+			|| cabecera->nanosegundos != indice->nanosegundos
+			|| cabecera->cantidad != (tam - sizeof(indice_cabecera_t)) / sizeof(indice_entrada_t)
+			|| (tam - sizeof(indice_cabecera_t)) % sizeof(indice_entrada_t) != 0) {
+		munmap(mapa, tam);
+		indice_csv_destruir(indice);
+		return NULL;
+	}
+	indice->mapa = mapa;
+	indice->tam_mapa = tam;
+	indice->entradas = (const void*) ((const char*) mapa + sizeof(indice_cabecera_t));
+	indice->cantidad = (size_t) cabecera->cantidad;
+	return indice;
+}
+
+bool indice_csv_guardar(const indice_csv_t* indice, const char* ruta_indice) {
+	indice_cabecera_t cabecera;
+	memset(&cabecera, 0, sizeof(cabecera));
+	memcpy(cabecera.magia, INDICE_MAGIA, sizeof(cabecera.magia));
+	cabecera.version = INDICE_VERSION;
+	cabecera.orden_bytes = INDICE_ORDEN_BYTES;
+	cabecera.delim = (unsigned char) indice->delim;
+	cabecera.tam_archivo = indice->tam_archivo;
+	cabecera.segundos = indice->segundos;
+	cabecera.nanosegundos = indice->nanosegundos;
+	cabecera.cantidad = indice->cantidad;
+
+	// Escribo en un archivo temporal y lo renombro
+	char* temporal = malloc(strlen(ruta_indice) + sizeof(".tmp"));
+	if (!temporal) return false;
+	strcpy(temporal, ruta_indice);
+	strcat(temporal, ".tmp");
+	FILE* archivo = fopen(temporal, "wb");
+	bool ok = archivo != NULL;
+	ok = ok && indice_escribir(archivo, &cabecera, sizeof(cabecera));
+	ok = ok && indice_escribir(archivo, indice->entradas, indice->cantidad * sizeof(indice_entrada_t));
+	if (archivo && fclose(archivo) != 0) ok = false;
+	if (ok && rename(temporal, ruta_indice) != 0) ok = false;
+	if (!ok) remove(temporal);
+	free(temporal);
+	return ok;
+}
+
+bool indice_csv_buscar(indice_csv_t* indice, const char* clave, csv_campo_t* segundo) {
+	size_t largo = strlen(clave);
+	uint64_t huella = indice_fhash(clave, largo);
+
+	// Primera entrada con la huella buscada, y la siguiente a la última
+	size_t desde = 0;
+	size_t hasta = indice->cantidad;
+	while (desde < hasta) {
+		size_t medio = desde + (hasta - desde) / 2;
+		if (indice->entradas[medio].huella < huella) desde = medio + 1;
+		else hasta = medio;
+	}
+	hasta = desde;
+	while (hasta < indice->cantidad && indice->entradas[hasta].huella == huella) hasta++;
+
+	// Se recorren de la última línea a la primera, para encontrar la última
+	for (size_t i = hasta; i > desde; i--) {
+		uint64_t posicion = indice->entradas[i - 1].posicion;
+		if (posicion >= indice->tam_archivo || !indice_leer_linea(indice, posicion)) continue;
+		char* linea = indice->linea;
+		char* sep = strchr(linea, indice->delim);
+		if (!sep || (size_t) (sep - linea) != largo || memcmp(linea, clave, largo) != 0) continue;
+		segundo->inicio = sep + 1;
+		segundo->largo = strlen(sep + 1);
+		return true;
+	}
+	return false;
+}
+
+size_t indice_csv_cantidad(const indice_csv_t* indice) {
+	return indice->cantidad;
+}
+
+void indice_csv_destruir(indice_csv_t* indice) {
+	if (!indice) return;
+	if (indice->fd >= 0) close(indice->fd);
+	if (indice->mapa) munmap(indice->mapa, indice->tam_mapa);
+	free(indice->propias);
+	free(indice->linea);
+	free(indice);
+}
@@ -0,0 +1,81 @@
+#ifndef INDICE_CSV_H
+#define INDICE_CSV_H
+
+#include "csv.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Índice en disco de un archivo CSV de dos columnas, para buscar líneas por
+ * su primer campo sin cargar el archivo en memoria.
+ *
+ * El índice es un arreglo ordenado de pares (huella, posición): la huella es
+ * un hash de 64 bits del primer campo de una línea, y la posición es dónde
+ * empieza la línea en el archivo. Para buscar un nombre se busca su huella
+ * con búsqueda binaria, y se lee del archivo (con pread) la línea de cada
+ * posición que la tiene, hasta encontrar una cuyo primer campo sea el
+ * nombre buscado; dos nombres con la misma huella nunca se confunden. Ante
+ * nombres repetidos se encuentra el de la última línea, igual que al cargar
+ * el archivo entero.
+ *
+ * Al armarlo, el archivo se lee una sola vez, de a bloques, sin cargarlo
+ * entero, y el índice se puede guardar junto con el tamaño y la fecha de
+ * modificación del archivo. Al abrir un índice guardado se proyecta en
+ * memoria con mmap() y se usa tal cual, siempre que el archivo no haya
+ * cambiado desde que se armó. El archivo no debe modificarse mientras se
+ * usa el índice.
+ *
+ * Uso
+ * ===
+ *
+ *     indice_csv_t* indice = indice_csv_abrir("pacientes.idx", "pacientes.csv", ',');
+ *     if (!indice) {
+ *       indice = indice_csv_crear("pacientes.csv", ',', NULL, NULL);
+ *       if (indice) indice_csv_guardar(indice, "pacientes.idx");
+ *     }
+ *     csv_campo_t segundo;
+ *     if (indice_csv_buscar(indice, "Juan", &segundo))
+ *       printf("%s\n", segundo.inicio);
+ *     indice_csv_destruir(indice);
+ */
+
+typedef struct indice_csv indice_csv_t;
+
+// Decide si se indexa una línea. Recibe su número (empezando en 1) y sus dos
+// campos, que son además cadenas terminadas en '\0'.
+typedef bool (*indice_csv_filtro_t)(size_t linea, csv_campo_t primero, csv_campo_t segundo, void* extra);
+
+// Arma el índice del archivo 'ruta', leyéndolo de a bloques. Igual que al
+// cargar el archivo entero, termina en la primera línea sin segundo campo.
+// Si 'filtro' no es NULL, sólo se indexan las líneas para las que devuelve
+// true.
+// Post: Devuelve el índice, NULL si no se pudo leer el archivo o no hubo memoria.
+indice_csv_t* indice_csv_crear(const char* ruta, char delim, indice_csv_filtro_t filtro, void* extra);
+
+// Abre el índice guardado en 'ruta_indice' para el archivo 'ruta'.
+// Post: Devuelve el índice, NULL si no existe, no es un índice válido de
+// esta versión, o se armó con otro separador o para otro contenido del
+// archivo (otro tamaño o fecha de modificación).
+indice_csv_t* indice_csv_abrir(const char* ruta_indice, const char* ruta, char delim);
+
+// Guarda el índice en 'ruta_indice'. Se escribe primero en un archivo
+// temporal que luego se renombra, como la imagen del catálogo.
+// Pre: El índice fue creado.
+// Post: Devuelve false si no se pudo escribir.
+bool indice_csv_guardar(const indice_csv_t* indice, const char* ruta_indice);
+
+// Busca la última línea cuyo primer campo es 'clave'.
+// Pre: El índice fue creado.
+// Post: Devuelve true y guarda en 'segundo' su segundo campo (terminado en
+// '\0') si la encontró, false si no está o no se pudo leer. El campo es
+// válido hasta la siguiente búsqueda o hasta destruir el índice.
+bool indice_csv_buscar(indice_csv_t* indice, const char* clave, csv_campo_t* segundo);
+
+// Devuelve la cantidad de líneas indexadas.
+// Pre: El índice fue creado.
+size_t indice_csv_cantidad(const indice_csv_t* indice);
+
+// Destruye el índice y cierra el archivo.
+void indice_csv_destruir(indice_csv_t* indice);
+
+#endif // INDICE_CSV_H
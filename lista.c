@@ -1,95 +1,181 @@
 #include "lista.h"
+#include "pool.h"
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Cantidad de valores por nodo en una lista desenrollada.
+#define VALORES_POR_NODO 16
 
 /* *****************************************************************
  *                   DEFINICION TIPOS DE DATOS
  * *****************************************************************/
 
+/* Cada nodo guarda hasta 'capacidad' valores consecutivos de la lista, donde
+ * la capacidad es propia de cada lista: 1 en una lista común, y
+ * VALORES_POR_NODO en una desenrollada. Ningún nodo de la lista está vacío. */
+
 typedef struct nodo {
-	void* valor;
 	struct nodo* siguiente;
+	size_t cant;
+	void* valores[];
 } nodo_t;
 
 struct lista {
 	nodo_t* inicio;
 	nodo_t* fin;
 	size_t largo;
+	size_t capacidad;
+	pool_t* pool;
 };
 
+/* El nodo previo al actual sólo se lee con pos == 0: en otra posición el
+ * valor actual no es el único del nodo, así que borrarlo no lo desenlaza,
+ * y al pasar a otro nodo el previo se vuelve a asignar. */
+
 struct lista_iter {
-	nodo_t* anterior;
-	nodo_t* actual;
+	nodo_t* anterior; // Nodo previo al actual (el último si está al final)
+	nodo_t* actual;   // NULL si el iterador está al final
+	size_t pos;       // Posición del valor actual dentro del nodo
 };
 
-/* Función auxiliar para crear un nuevo nodo */
+/* Funciones auxiliares para crear y destruir un nodo, pidiéndolo al pool
+ * de la lista si tiene uno */
 
-nodo_t* nodo_lista_crear(void* valor){
-	nodo_t* nodo = malloc(sizeof(nodo_t));
+nodo_t* nodo_lista_crear(lista_t* lista){
+	nodo_t* nodo;
+	if (lista->pool) nodo = pool_pedir(lista->pool);
+	else nodo = malloc(offsetof(nodo_t, valores) + lista->capacidad * sizeof(void*));
 	if (!nodo)
 		return NULL;
-	nodo->valor = valor;
-	nodo_t* siguiente = NULL;
-	nodo->siguiente = siguiente;
+	nodo->siguiente = NULL;
+	nodo->cant = 0;
 	return nodo;
 }
 
+void nodo_lista_destruir(lista_t* lista, nodo_t* nodo){
+	if (lista->pool) pool_devolver(lista->pool, nodo);
+	else free(nodo);
+}
+
+// Enlaza un nodo nuevo a continuación de 'anterior', o al principio de la
+// lista si 'anterior' es NULL.
+void nodo_lista_enlazar(lista_t* lista, nodo_t* anterior, nodo_t* nodo){
+	nodo->siguiente = anterior ? anterior->siguiente : lista->inicio;
+	if (!nodo->siguiente) lista->fin = nodo;
+	if (anterior) anterior->siguiente = nodo;
+	else lista->inicio = nodo;
+}
+
+// Quita de la lista el nodo que sigue a 'anterior' (el primero si 'anterior'
+// es NULL) y lo destruye.
+void nodo_lista_desenlazar(lista_t* lista, nodo_t* anterior, nodo_t* nodo){
+	if (anterior) anterior->siguiente = nodo->siguiente;
+	else lista->inicio = nodo->siguiente;
+	if (!nodo->siguiente) lista->fin = anterior;
+	nodo_lista_destruir(lista, nodo);
+}
+
+// Inserta un valor en la posición pos del nodo, corriendo los siguientes.
+// Pre: el nodo tiene lugar para un valor más, pos <= nodo->cant.
+void nodo_lista_insertar(lista_t* lista, nodo_t* nodo, size_t pos, void* valor){
+	if (pos < nodo->cant)
+		memmove(nodo->valores + pos + 1, nodo->valores + pos, (nodo->cant - pos) * sizeof(void*));
+	nodo->valores[pos] = valor;
+	nodo->cant++;
+	lista->largo++;
+}
+
+// Quita y devuelve el valor de la posición pos del nodo. Si el nodo queda
+// vacío, lo quita de la lista.
+// Pre: pos < nodo->cant, 'anterior' es el nodo previo a 'nodo'.
+void* nodo_lista_borrar(lista_t* lista, nodo_t* anterior, nodo_t* nodo, size_t pos){
+	void* valor = nodo->valores[pos];
+	nodo->cant--;
+	if (pos < nodo->cant)
+		memmove(nodo->valores + pos, nodo->valores + pos + 1, (nodo->cant - pos) * sizeof(void*));
+	lista->largo--;
+	if (nodo->cant == 0) nodo_lista_desenlazar(lista, anterior, nodo);
+	return valor;
+}
+
+// Si el nodo quedó ocupado menos de la mitad y el contenido del siguiente
+// entra en él, los une en uno solo para que la lista no se fragmente.
+void nodo_lista_compactar(lista_t* lista, nodo_t* nodo){
+	nodo_t* siguiente = nodo->siguiente;
+	if (!siguiente || nodo->cant >= lista->capacidad / 2 || nodo->cant + siguiente->cant > lista->capacidad)
+		return;
+	memcpy(nodo->valores + nodo->cant, siguiente->valores, siguiente->cant * sizeof(void*));
+	nodo->cant += siguiente->cant;
+	nodo_lista_desenlazar(lista, nodo, siguiente);
+}
+
 /* *****************************************************************
  *                    PRIMITIVAS DE LA LISTA
  * *****************************************************************/
 
 lista_t *lista_crear(void) {
+	return lista_crear_con_pool(NULL);
+}
+
+lista_t *lista_crear_con_pool(pool_t *pool) {
 	lista_t* lista;
-	lista = malloc(sizeof(lista_t));
+	lista = pool ? pool_pedir(pool) : malloc(sizeof(lista_t));
 	if (!lista) return NULL;
 	lista->inicio = NULL;
 	lista->fin = NULL;
-	lista->largo = 0;	
+	lista->largo = 0;
+	lista->capacidad = 1;
+	lista->pool = pool;
+	return lista;
+}
+
+lista_t *lista_crear_desenrollada(void) {
+	lista_t* lista = lista_crear();
+	if (lista) lista->capacidad = VALORES_POR_NODO;
 	return lista;
 }
 
+pool_t *lista_pool_crear(void) {
+	// El pool entrega tanto los nodos (de un valor) como la lista en sí
+	size_t tam_nodo = sizeof(nodo_t) + sizeof(void*);
+	return pool_crear(tam_nodo > sizeof(lista_t) ? tam_nodo : sizeof(lista_t));
+}
+
 bool lista_esta_vacia(const lista_t *lista) {
 	return (lista->largo == 0);
 }
 
 bool lista_insertar_primero(lista_t *lista, void *dato) {
-	nodo_t* nodo = nodo_lista_crear(dato);
-	if (!nodo) return false;
-	nodo->siguiente = lista->inicio;
-	lista->inicio = nodo;
-	if (lista_esta_vacia(lista)) {
-		lista->fin = nodo;
+	nodo_t* nodo = lista->inicio;
+	if (!nodo || nodo->cant == lista->capacidad) {
+		nodo = nodo_lista_crear(lista);
+		if (!nodo) return false;
+		nodo_lista_enlazar(lista, NULL, nodo);
 	}
-	lista->largo++;
+	nodo_lista_insertar(lista, nodo, 0, dato);
 	return true;
 }
 
 bool lista_insertar_ultimo(lista_t *lista, void *dato) {
-	nodo_t* nodo = nodo_lista_crear(dato);
-	if (!nodo) return false;
-	if (lista_esta_vacia(lista)) {
-		lista->inicio = nodo;
-		lista->fin = nodo;
+	nodo_t* nodo = lista->fin;
+	if (!nodo || nodo->cant == lista->capacidad) {
+		nodo = nodo_lista_crear(lista);
+		if (!nodo) return false;
+		nodo_lista_enlazar(lista, lista->fin, nodo);
 	}
-	lista->fin->siguiente = nodo;
-	lista->fin = nodo;
-	lista->largo++;
+	nodo_lista_insertar(lista, nodo, nodo->cant, dato);
 	return true;
 }
 
 void *lista_borrar_primero(lista_t *lista) {
 	if (lista_esta_vacia(lista)) return NULL;
-	nodo_t* nodo_a_borrar = lista->inicio;
-	void* elemento = nodo_a_borrar->valor;
-	lista->inicio = nodo_a_borrar->siguiente;
-	lista->largo--;
-	if (lista_esta_vacia(lista)) lista->fin = NULL;
-	free(nodo_a_borrar);
-	return elemento;
+	return nodo_lista_borrar(lista, NULL, lista->inicio, 0);
 }
 
 void *lista_ver_primero(const lista_t *lista) {
-	if (!lista_esta_vacia(lista)) return lista->inicio->valor;
+	if (!lista_esta_vacia(lista)) return lista->inicio->valores[0];
 	return NULL;
 }
 
@@ -98,11 +184,17 @@ size_t lista_largo(const lista_t *lista) {
 }
 
 void lista_destruir(lista_t *lista, void destruir_dato(void *)) {
-	while (!lista_esta_vacia(lista)) {
-		void* elemento = lista_borrar_primero(lista);
-		if (destruir_dato) destruir_dato(elemento);
+	nodo_t* nodo = lista->inicio;
+	while (nodo) {
+		nodo_t* siguiente = nodo->siguiente;
+		if (destruir_dato) {
+			for (size_t i = 0; i < nodo->cant; i++) destruir_dato(nodo->valores[i]);
+		}
+		nodo_lista_destruir(lista, nodo);
+		nodo = siguiente;
 	}
-	free(lista);
+	if (lista->pool) pool_devolver(lista->pool, lista);
+	else free(lista);
 }
 
 /* ******************************************************************
@@ -111,22 +203,27 @@ void lista_destruir(lista_t *lista, void destruir_dato(void *)) {
 
 lista_iter_t *lista_iter_crear(const lista_t *lista) {
 	lista_iter_t* iter = malloc(sizeof(lista_iter_t));
+	if (!iter) return NULL;
 	iter->anterior = NULL;
 	iter->actual = lista->inicio;
+	iter->pos = 0;
 	return iter;
 }
- 
+
 bool lista_iter_avanzar(lista_iter_t *iter) {
 	if (lista_iter_al_final(iter)) return false;
-	iter->anterior = iter->actual;
-	iter->actual = iter->anterior->siguiente;
+	iter->pos++;
+	if (iter->pos == iter->actual->cant) {
+		iter->anterior = iter->actual;
+		iter->actual = iter->actual->siguiente;
+		iter->pos = 0;
+	}
 	return true;
 }
- 
+
 void *lista_iter_ver_actual(const lista_iter_t *iter) {
 	if (!iter->actual) return NULL;
-	void* valor = iter->actual->valor;
-	return valor;
+	return iter->actual->valores[iter->pos];
 }
 
 bool lista_iter_al_final(const lista_iter_t *iter) {
@@ -139,68 +236,71 @@ void lista_iter_destruir(lista_iter_t *iter) {
 
 /* ******************************************************************
  *              PRIMITIVAS DE LISTAS JUNTO CON ITERADOR
- * *****************************************************************/ 
+ * *****************************************************************/
 
 bool lista_insertar(lista_t *lista, lista_iter_t *iter, void *dato) {
-	// Si estoy en la primera posición del iterador
-	if (!iter->anterior) {
-		if (lista_insertar_primero(lista, dato)) iter->actual = lista->inicio;
-		else return false;
+	// Si estoy al final, el nuevo elemento pasa a ser el último
+	if (lista_iter_al_final(iter)) {
+		nodo_t* fin = lista->fin;
+		if (!lista_insertar_ultimo(lista, dato)) return false;
+		// Si se agregó al último nodo en lugar de a uno nuevo (sólo sucede en
+		// una lista desenrollada), el iterador pasa a estar en ese nodo
+		// detrás de otro valor, y no necesita conocer a su previo
+		if (lista->fin != fin) iter->anterior = fin;
+		iter->actual = lista->fin;
+		iter->pos = lista->fin->cant - 1;
+		return true;
 	}
-	// Si estoy en la última posición del iterador
-	else if (lista_iter_al_final(iter)) {
-		if (lista_insertar_ultimo(lista, dato)) iter->actual = lista->fin;
-		else return false;
-	}
-	// Si estoy en cualquier otra posición del iterador
-	else {
-		nodo_t* nodo = nodo_lista_crear(dato);
-		if (!nodo) return false;
-		iter->anterior->siguiente = nodo;
-		nodo->siguiente = iter->actual;
-		iter->actual = nodo;
-		lista->largo++;
+	nodo_t* nodo = iter->actual;
+	// Si el nodo está lleno, paso su segunda mitad a un nodo nuevo, y el
+	// elemento se inserta en el que corresponda a su posición
+	if (nodo->cant == lista->capacidad) {
+		nodo_t* nuevo = nodo_lista_crear(lista);
+		if (!nuevo) return false;
+		size_t mitad = nodo->cant / 2;
+		memcpy(nuevo->valores, nodo->valores + mitad, (nodo->cant - mitad) * sizeof(void*));
+		nuevo->cant = nodo->cant - mitad;
+		nodo->cant = mitad;
+		nodo_lista_enlazar(lista, nodo, nuevo);
+		if (iter->pos > mitad) {
+			iter->anterior = nodo;
+			iter->actual = nuevo;
+			iter->pos -= mitad;
+		}
 	}
+	nodo_lista_insertar(lista, iter->actual, iter->pos, dato);
 	return true;
 }
 
 void *lista_borrar(lista_t *lista, lista_iter_t *iter) {
-	void* dato_borrado;
 	// Si la lista está vacía o recorrí toda la lista
 	if (lista_esta_vacia(lista) || lista_iter_al_final(iter)) return NULL;
-	// Si estoy en la primera posición del iterador
-	else if (!iter->anterior) {
-		dato_borrado = lista_borrar_primero(lista);
-		iter->actual = lista->inicio;
+	nodo_t* nodo = iter->actual;
+	// Si es el único valor del nodo, el nodo se destruye y sigo en el siguiente
+	if (nodo->cant == 1) {
+		iter->actual = nodo->siguiente;
+		iter->pos = 0;
+		return nodo_lista_borrar(lista, iter->anterior, nodo, 0);
 	}
-	// Si estoy en cualquier otra posición del iterador
-	else {
-		nodo_t *nodo_a_borrar = iter->actual;
-		dato_borrado = nodo_a_borrar->valor;
-		// Si estoy al final de la lista
-		if (!iter->actual->siguiente) {
-			iter->anterior->siguiente = NULL;
-			iter->actual = NULL;
-			lista->fin = iter->anterior;
-		}
-		// Si estoy en cualquier otra posición
-		else {
-			iter->anterior->siguiente = nodo_a_borrar->siguiente;
-			iter->actual = nodo_a_borrar->siguiente; 
-		}
-		free(nodo_a_borrar);
-		lista->largo--;
+	void* dato_borrado = nodo_lista_borrar(lista, iter->anterior, nodo, iter->pos);
+	nodo_lista_compactar(lista, nodo);
+	// Si borré el último valor del nodo, sigo en el siguiente
+	if (iter->pos == nodo->cant) {
+		iter->anterior = nodo;
+		iter->actual = nodo->siguiente;
+		iter->pos = 0;
 	}
 	return dato_borrado;
 }
 
 /* ******************************************************************
  *                 PRIMITIVAS DE ITERADOR INTERNO
- * *****************************************************************/ 
+ * *****************************************************************/
 
 void lista_iterar(lista_t *lista, bool (*visitar)(void *dato, void *extra), void *extra) {
-	lista_iter_t* iter = lista_iter_crear(lista);
-	void* dato = lista_iter_ver_actual(iter);
-	while ((lista_iter_avanzar(iter)) && (visitar(dato, extra))) dato = lista_iter_ver_actual(iter);
-	lista_iter_destruir(iter);
+	for (nodo_t* nodo = lista->inicio; nodo; nodo = nodo->siguiente) {
+		for (size_t i = 0; i < nodo->cant; i++) {
+			if (!visitar(nodo->valores[i], extra)) return;
+		}
+	}
 }
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "pool.h"
 
 /* ******************************************************************
  *                DEFINICION DE LOS TIPOS DE DATOS
@@ -23,6 +24,24 @@ typedef struct lista_iter lista_iter_t;
 // Post: devuelve una nueva lista vacía.
 lista_t *lista_crear(void);
 
+// Crea una lista que pide al pool recibido, en lugar de a malloc, tanto sus
+// nodos como la propia estructura de la lista.
+// Si pool es NULL equivale a lista_crear().
+// Pre: el pool fue creado con lista_pool_crear(), y se destruirá después
+// que la lista.
+// Post: devuelve una nueva lista vacía.
+lista_t *lista_crear_con_pool(pool_t *pool);
+
+// Crea un pool de nodos de lista, que puede compartirse entre varias listas.
+// Post: devuelve el pool, NULL si no se pudo crear.
+pool_t *lista_pool_crear(void);
+
+// Crea una lista desenrollada: cada nodo guarda varios valores consecutivos
+// en lugar de uno solo, por lo que recorrerla sigue muchos menos punteros.
+// Admite las mismas primitivas que una lista común, con el mismo resultado.
+// Post: devuelve una nueva lista vacía.
+lista_t *lista_crear_desenrollada(void);
+
 // Devuelve verdadero o falso, según si la lista tiene o no elementos.
 // Pre: la lista fue creada.
 bool lista_esta_vacia(const lista_t *lista);
@@ -8,9 +8,16 @@
 #define NUM_PACIENTES_ESPERAN "%zu paciente(s) en espera para %s\n"
 #define CERO_PACIENTES_ESPERAN "No hay pacientes en espera\n"
 
+#define RECARGA_EN_CURSO "Recargando %s\n"
+#define RECARGA_APLICADA "%s recargados: %zu agregado(s), %zu modificado(s), %zu borrado(s)\n"
+
 #define NUM_DOCTORES "%zu doctor(es) en el sistema\n"
 #define INFORME_DOCTOR "%d: %s, especialidad %s, %d paciente(s) atendido(s)\n"
 
+#define METRICAS_COMANDO "%s: %zu comando(s), latencia p50 %zu ns, p90 %zu ns, p99 %zu ns, p99.9 %zu ns, máx %zu ns\n"
+#define METRICAS_ERRORES "Errores: %zu doctor(es), %zu paciente(s) y %zu especialidad(es) inexistente(s), %zu comando(s) inexistente(s), %zu línea(s) inválida(s)\n"
+#define METRICAS_ESPERA "%s: hasta %zu paciente(s) en espera\n"
+
 // Mensajes de error.
 #define ENOENT_DOCTOR "ERROR: no existe el doctor '%s'\n"
 #define ENOENT_PACIENTE "ERROR: no existe el paciente '%s'\n"
@@ -19,4 +26,15 @@
 #define ENOENT_CMD "ERROR: no existe el comando '%s:%s'\n"
 #define EINVAL_CMD "ERROR: formato de comando incorrecto\n"
 
+#define EINVAL_LINEA "ERROR: %s:%zu: valor inválido '%s'\n"
+#define ERECARGA "ERROR: no se pudo recargar '%s'\n"
+#define ERECARGA_CATALOGO "ERROR: no se puede recargar un catálogo compilado\n"
+#define ERECARGA_INDICE "ERROR: no se pueden recargar pacientes indexados\n"
+#define EINVAL_CATALOGO "ERROR: '%s' no es un catálogo válido\n"
+#define EBITACORA "ERROR: no se pudo recuperar la bitácora '%s'\n"
+#define EBITACORA_ESCRITURA "ERROR: no se pudo escribir la bitácora, los cambios siguientes no se registran\n"
+#define EMETRICAS "ERROR: no se pudieron guardar las métricas en '%s'\n"
+#define EPERFIL "ERROR: no se pudo guardar el perfil de arranque en '%s'\n"
+#define ESERVIDOR "ERROR: no se pudo atender en el socket '%s'\n"
+
 #endif // MENSAJES_H
@@ -0,0 +1,66 @@
+#define _POSIX_C_SOURCE 200809L  // Para clock_gettime().
+#include "metricas.h"
+#include <time.h>
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Devuelve la posición del bit más alto en 1 de un valor distinto de 0.
+unsigned int bit_mas_alto(uint64_t valor) {
+#ifdef __GNUC__
+	return 63u - (unsigned int) __builtin_clzll(valor);
+#else
+	unsigned int bit = 0;
+	while (valor >>= 1) bit++;
+	return bit;
+#endif
+}
+
+// Devuelve la cubeta de un valor.
+size_t histograma_cubeta(uint64_t valor) {
+	if (valor < 2 * SUBCUBETAS) return (size_t) valor;
+	// Los BITS_SUBCUBETAS + 1 bits más altos del valor, desplazados a su
+	// potencia de 2
+	unsigned int desplazamiento = bit_mas_alto(valor) - BITS_SUBCUBETAS;
+	return (size_t) desplazamiento * SUBCUBETAS + (size_t) (valor >> desplazamiento);
+}
+
+// Devuelve el mayor valor que se cuenta en una cubeta.
+uint64_t histograma_mayor_de_cubeta(size_t cubeta) {
+	if (cubeta < 2 * SUBCUBETAS) return cubeta;
+	unsigned int desplazamiento = (unsigned int) (cubeta / SUBCUBETAS - 1);
+	uint64_t base = cubeta - (size_t) desplazamiento * SUBCUBETAS;
+	// En la última cubeta da la vuelta a 0, y resta 1 desde ahí
+	return ((base + 1) << desplazamiento) - 1;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LAS MÉTRICAS
+ * *****************************************************************/
+
+uint64_t metricas_reloj(void) {
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t) ahora.tv_sec * 1000000000u + (uint64_t) ahora.tv_nsec;
+}
+
+void histograma_agregar(histograma_t* histograma, uint64_t valor) {
+	histograma->cubetas[histograma_cubeta(valor)]++;
+	if (!histograma->cantidad || valor < histograma->minimo) histograma->minimo = valor;
+	if (valor > histograma->maximo) histograma->maximo = valor;
+	histograma->cantidad++;
+	histograma->suma += valor;
+}
+
+uint64_t histograma_percentil(const histograma_t* histograma, unsigned int milesimas) {
+	if (!histograma->cantidad) return 0;
+	// Cantidad de valores que tienen que quedar hasta la cubeta, redondeando para arriba
+	uint64_t buscados = (histograma->cantidad * milesimas + 999) / 1000;
+	if (!buscados) buscados = 1;
+	uint64_t contados = 0;
+	size_t cubeta = 0;
+	while (contados + histograma->cubetas[cubeta] < buscados) contados += histograma->cubetas[cubeta++];
+	uint64_t mayor = histograma_mayor_de_cubeta(cubeta);
+	return mayor < histograma->maximo ? mayor : histograma->maximo;
+}
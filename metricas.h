@@ -0,0 +1,64 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Instrumentos para medir el programa mientras se ejecuta: un reloj
+ * monotónico en nanosegundos, e histogramas de valores (latencias) con
+ * cubetas logarítmico-lineales, como los de HdrHistogram.
+ *
+ * Cada potencia de 2 se divide en SUBCUBETAS cubetas iguales, de modo que
+ * el valor que se informa de una cubeta difiere del real en menos de
+ * 1/SUBCUBETAS (6,25%), sea cual sea su magnitud; los valores menores que
+ * 2 * SUBCUBETAS se cuentan exactos. Agregar un valor es sólo calcular su
+ * cubeta con un par de operaciones de bits, e incrementarla: no reserva
+ * memoria ni recorre nada. Un histograma vacío tiene todo en 0.
+ *
+ * Uso
+ * ===
+ *
+ *     histograma_t latencias = {0};
+ *     uint64_t inicio = metricas_reloj();
+ *     ...
+ *     histograma_agregar(&latencias, metricas_reloj() - inicio);
+ *     uint64_t p99 = histograma_percentil(&latencias, 990);
+ */
+
+#define BITS_SUBCUBETAS 4
+#define SUBCUBETAS (1 << BITS_SUBCUBETAS)
+// Las cubetas exactas, y SUBCUBETAS por cada potencia de 2 hasta 2^64
+#define CANT_CUBETAS ((64 - BITS_SUBCUBETAS + 1) * SUBCUBETAS)
+
+typedef struct histograma {
+	uint64_t cubetas[CANT_CUBETAS];
+	uint64_t cantidad;
+	uint64_t suma;
+	uint64_t minimo;             // Sólo si no está vacío
+	uint64_t maximo;
+} histograma_t;
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LAS MÉTRICAS
+ * *****************************************************************/
+
+// Devuelve los nanosegundos de un reloj monotónico, desde un origen
+// arbitrario.
+uint64_t metricas_reloj(void);
+
+// Cuenta un valor en el histograma.
+void histograma_agregar(histograma_t* histograma, uint64_t valor);
+
+// Devuelve el valor por debajo del cual (o igual) quedan 'milesimas'
+// milésimas de los valores contados: 500 es la mediana, 999 el percentil
+// 99,9. Es el mayor valor de su cubeta, sin pasar del máximo contado.
+// Pre: 'milesimas' no es mayor que 1000.
+// Post: Devuelve 0 si el histograma está vacío.
+uint64_t histograma_percentil(const histograma_t* histograma, unsigned int milesimas);
+
+#endif // METRICAS_H
@@ -0,0 +1,109 @@
+#define _POSIX_C_SOURCE 200809L  // Para getrusage().
+#include "perfil.h"
+#include "metricas.h"
+#include <sys/resource.h>
+
+// Fase en la que cuenta lo que pide cada hilo, NULL si no tiene una
+static __thread perfil_fase_t* fase_del_hilo = NULL;
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Las funciones originales, que el enlazador renombra al envolverlas.
+void* __real_malloc(size_t tam);
+void* __real_calloc(size_t cantidad, size_t tam);
+void* __real_realloc(void* ptr, size_t tam);
+
+// Cuenta un pedido de 'tam' bytes en la fase del hilo, si tiene una.
+void perfil_contar(size_t tam) {
+	perfil_fase_t* fase = fase_del_hilo;
+	if (!fase) return;
+	__atomic_add_fetch(&fase->asignaciones, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&fase->bytes, tam, __ATOMIC_RELAXED);
+}
+
+// Las llamadas del programa a malloc(), calloc() y realloc() llegan a
+// estas funciones (-Wl,--wrap).
+void* __wrap_malloc(size_t tam) {
+	perfil_contar(tam);
+	return __real_malloc(tam);
+}
+
+void* __wrap_calloc(size_t cantidad, size_t tam) {
+	perfil_contar(cantidad * tam);
+	return __real_calloc(cantidad, tam);
+}
+
+void* __wrap_realloc(void* ptr, size_t tam) {
+	perfil_contar(tam);
+	return __real_realloc(ptr, tam);
+}
+
+// Devuelve el máximo de memoria residente que tuvo el proceso, en KiB.
+size_t perfil_max_rss(void) {
+	struct rusage uso;
+	if (getrusage(RUSAGE_SELF, &uso) != 0) return 0;
+	return (size_t) uso.ru_maxrss;
+}
+
+// Escribe una fase (o el arranque) en JSON.
+void perfil_escribir_fase(const perfil_fase_t* fase, salida_t* salida) {
+	salida_formato(salida, "{\"fase\": \"%s\", \"ns\": %zu, \"filas\": %zu, \"asignaciones\": %zu, \"bytes\": %zu, \"redimensiones\": %zu, \"max_rss_kib\": %zu}",
+	               fase->nombre, (size_t) fase->duracion, fase->filas, fase->asignaciones, fase->bytes, fase->redimensiones, fase->max_rss);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL PERFIL
+ * *****************************************************************/
+
+void perfil_activar(perfil_t* perfil) {
+	perfil->cantidad = 0;
+	perfil->inicio = metricas_reloj();
+}
+
+perfil_fase_t* perfil_empezar(perfil_t* perfil, const char* nombre, size_t redimensiones) {
+	perfil_fase_t* fase = &perfil->fases[perfil->cantidad++];
+	*fase = (perfil_fase_t) {.nombre = nombre, .redimensiones = redimensiones};
+	fase->inicio = metricas_reloj();
+	return fase;
+}
+
+void perfil_contar_en(perfil_fase_t* fase) {
+	fase_del_hilo = fase;
+}
+
+perfil_fase_t* perfil_fase_del_hilo(void) {
+	return fase_del_hilo;
+}
+
+void perfil_terminar(perfil_fase_t* fase, size_t filas, size_t redimensiones) {
+	if (fase_del_hilo == fase) fase_del_hilo = NULL;
+	fase->duracion = metricas_reloj() - fase->inicio;
+	fase->filas = filas;
+	fase->redimensiones = redimensiones - fase->redimensiones;
+	fase->max_rss = perfil_max_rss();
+}
+
+void perfil_escribir(const perfil_t* perfil, salida_t* salida) {
+	perfil_fase_t arranque = {.nombre = "arranque"};
+	uint64_t fin = perfil->inicio;
+	salida_cadena(salida, "{\"fases\": [");
+	for (size_t i = 0; i < perfil->cantidad; i++) {
+		const perfil_fase_t* fase = &perfil->fases[i];
+		if (i > 0) salida_cadena(salida, ", ");
+		perfil_escribir_fase(fase, salida);
+		arranque.filas += fase->filas;
+		arranque.asignaciones += fase->asignaciones;
+		arranque.bytes += fase->bytes;
+		arranque.redimensiones += fase->redimensiones;
+		if (fase->inicio + fase->duracion >= fin) {
+			fin = fase->inicio + fase->duracion;
+			arranque.max_rss = fase->max_rss;
+		}
+	}
+	arranque.duracion = fin - perfil->inicio;
+	salida_cadena(salida, "], \"arranque\": ");
+	perfil_escribir_fase(&arranque, salida);
+	salida_cadena(salida, "}\n");
+}
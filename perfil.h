@@ -0,0 +1,105 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include "salida.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Perfil de las fases del arranque del programa: de cada fase se mide lo
+ * que tarda, cuántas filas carga, cuánta memoria pide (cantidad de pedidos
+ * y bytes), cuántas veces se agrandan sus tablas de hash, y el máximo de
+ * memoria residente (RSS) del proceso al terminarla.
+ *
+ * La memoria se cuenta envolviendo malloc(), calloc() y realloc() al
+ * enlazar (-Wl,--wrap, ver Makefile): cuenta lo que piden los módulos del
+ * programa, pero no lo que reserva la biblioteca estándar por su cuenta
+ * (strdup(), getline(), stdio). Cada hilo cuenta lo que pide en la fase
+ * que tiene asignada, si tiene una: así las fases se pueden superponer
+ * (los doctores se cargan mientras otro hilo carga los pacientes), sin
+ * cambiar la forma en que arranca el programa al medirlo. Un hilo sin fase
+ * sólo agrega una comparación a cada pedido.
+ *
+ * Además de las fases, se mide el arranque entero: desde que se activa el
+ * perfil hasta que termina la última fase.
+ *
+ * Uso
+ * ===
+ *
+ *     perfil_t perfil;
+ *     perfil_activar(&perfil);
+ *     perfil_fase_t* fase = perfil_empezar(&perfil, "doctores", redimensiones);
+ *     perfil_contar_en(fase);      // En cada hilo que trabaja en la fase
+ *     ...
+ *     perfil_terminar(fase, filas, redimensiones);
+ *     perfil_escribir(&perfil, &salida);
+ */
+
+#define MAX_FASES 8
+
+typedef struct perfil_fase {
+	const char* nombre;
+	uint64_t inicio;             // En ns, según metricas_reloj()
+	uint64_t duracion;           // En ns
+	size_t filas;
+	size_t asignaciones;         // Se suman mientras está en curso
+	size_t bytes;
+	size_t redimensiones;
+	size_t max_rss;              // En KiB
+} perfil_fase_t;
+
+typedef struct perfil {
+	perfil_fase_t fases[MAX_FASES];
+	size_t cantidad;
+	uint64_t inicio;             // Del arranque
+} perfil_t;
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL PERFIL
+ * *****************************************************************/
+
+// Empieza a medir el arranque.
+// Post: El perfil no tiene fases.
+void perfil_activar(perfil_t* perfil);
+
+// Empieza una fase, que todavía no cuenta lo que pide ningún hilo (ver
+// perfil_contar_en()). 'redimensiones' es la cantidad de veces que se
+// agrandaron hasta ahora las tablas que usa la fase.
+// Pre: El perfil está activo, y tiene menos de MAX_FASES. Las fases se
+// empiezan siempre desde el mismo hilo. El nombre sigue existiendo
+// mientras exista el perfil.
+// Post: Devuelve la fase.
+perfil_fase_t* perfil_empezar(perfil_t* perfil, const char* nombre, size_t redimensiones);
+
+// Cuenta lo que pida desde ahora el hilo que llama en 'fase', o en ninguna
+// si es NULL.
+// Pre: La fase está en curso, o es NULL.
+void perfil_contar_en(perfil_fase_t* fase);
+
+// Devuelve la fase en la que cuenta lo que pide el hilo que llama, NULL si
+// no tiene una.
+perfil_fase_t* perfil_fase_del_hilo(void);
+
+// Termina una fase, que cargó 'filas' filas. 'redimensiones' es la
+// cantidad de veces que se agrandaron hasta ahora sus tablas. El hilo que
+// llama deja de contar en ella.
+// Pre: La fase está en curso, y ningún otro hilo cuenta en ella.
+void perfil_terminar(perfil_fase_t* fase, size_t filas, size_t redimensiones);
+
+// Escribe el perfil en 'salida', en JSON:
+//
+// {"fases": [{"fase": NOMBRE, "ns": N, "filas": N, "asignaciones": N,
+// "bytes": N, "redimensiones": N, "max_rss_kib": N}, ...], "arranque": {...}}
+//
+// donde el arranque suma lo que contaron las fases, su tiempo es el que
+// pasó desde perfil_activar() hasta el fin de la última fase (menos que la
+// suma de las fases si se superponen), y su máximo de RSS es el del fin de
+// la última fase.
+// Pre: No hay fases en curso.
+void perfil_escribir(const perfil_t* perfil, salida_t* salida);
+
+#endif // PERFIL_H
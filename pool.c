@@ -0,0 +1,108 @@
+#include "pool.h"
+#include <stdlib.h>
+
+#define ELEMENTOS_PRIMER_BLOQUE 64
+#define MULTIPLICADOR 2
+// Los bloques no superan este tamaño para que malloc los sirva desde el heap
+// y no con mmap, que obligaría a devolver las páginas al sistema al destruir.
+#define TAM_MAX_BLOQUE 65536
+
+// Cada bloque empieza con un puntero al bloque anterior, seguido de sus
+// elementos. Los elementos libres guardan en sus primeros bytes el puntero
+// al siguiente libre.
+typedef struct bloque {
+	struct bloque* anterior;
+} bloque_t;
+
+typedef struct libre {
+	struct libre* siguiente;
+} libre_t;
+
+struct pool {
+	size_t tam_elemento;
+	size_t elementos_bloque;   // Capacidad del próximo bloque a reservar
+	bloque_t* bloques;         // Último bloque reservado
+	char* proximo;             // Primer elemento nunca entregado del último bloque
+	char* fin;                 // Fin del último bloque
+	libre_t* libres;
+	size_t en_uso;
+};
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Redondea tam al múltiplo de alineacion inmediato superior.
+size_t pool_redondear(size_t tam, size_t alineacion) {
+	return (tam + alineacion - 1) / alineacion * alineacion;
+}
+
+// Reserva un nuevo bloque, duplicando la capacidad del anterior hasta
+// TAM_MAX_BLOQUE. Devuelve false si no hubo memoria.
+bool pool_agregar_bloque(pool_t* pool) {
+	size_t inicio = pool_redondear(sizeof(bloque_t), sizeof(long double));
+	bloque_t* bloque = malloc(inicio + pool->elementos_bloque * pool->tam_elemento);
+	if (!bloque) return false;
+	bloque->anterior = pool->bloques;
+	pool->bloques = bloque;
+	pool->proximo = (char*) bloque + inicio;
+	pool->fin = pool->proximo + pool->elementos_bloque * pool->tam_elemento;
+	if (MULTIPLICADOR * pool->elementos_bloque * pool->tam_elemento <= TAM_MAX_BLOQUE)
+		pool->elementos_bloque *= MULTIPLICADOR;
+	return true;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL POOL
+ * *****************************************************************/
+
+pool_t* pool_crear(size_t tam_elemento) {
+	pool_t* pool = malloc(sizeof(pool_t));
+	if (!pool) return NULL;
+	if (tam_elemento < sizeof(libre_t)) tam_elemento = sizeof(libre_t);
+	pool->tam_elemento = pool_redondear(tam_elemento, sizeof(void*));
+	pool->elementos_bloque = ELEMENTOS_PRIMER_BLOQUE;
+	pool->bloques = NULL;
+	pool->proximo = NULL;
+	pool->fin = NULL;
+	pool->libres = NULL;
+	pool->en_uso = 0;
+	return pool;
+}
+
+void* pool_pedir(pool_t* pool) {
+	void* elemento;
+	if (pool->libres) {
+		elemento = pool->libres;
+		pool->libres = pool->libres->siguiente;
+	}
+	else {
+		if (pool->proximo == pool->fin && !pool_agregar_bloque(pool)) return NULL;
+		elemento = pool->proximo;
+		pool->proximo += pool->tam_elemento;
+	}
+	pool->en_uso++;
+	return elemento;
+}
+
+void pool_devolver(pool_t* pool, void* elemento) {
+	if (!elemento) return;
+	libre_t* libre = elemento;
+	libre->siguiente = pool->libres;
+	pool->libres = libre;
+	pool->en_uso--;
+}
+
+size_t pool_en_uso(const pool_t* pool) {
+	return pool->en_uso;
+}
+
+void pool_destruir(pool_t* pool) {
+	if (!pool) return;
+	while (pool->bloques) {
+		bloque_t* anterior = pool->bloques->anterior;
+		free(pool->bloques);
+		pool->bloques = anterior;
+	}
+	free(pool);
+}
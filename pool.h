@@ -0,0 +1,51 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Pool de elementos de tamaño fijo. Reserva la memoria en bloques grandes
+ * (slabs) de muchos elementos, y guarda los elementos devueltos en una lista
+ * de libres que se enlaza dentro de los propios elementos, por lo que pedir
+ * y devolver un elemento no llama a malloc ni a free. Al destruir el pool se
+ * liberan todos los bloques de una vez, sin recorrer los elementos.
+ *
+ * Las listas y los árboles pueden crearse con un pool para sus nodos
+ * (ver lista_crear_con_pool y abb_crear_con_pool).
+ * Un mismo pool puede compartirse entre varias estructuras cuyos nodos
+ * sean del mismo tamaño, y debe destruirse después que todas ellas. */
+
+typedef struct pool pool_t;
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL POOL
+ * *****************************************************************/
+
+// Crea un pool de elementos de tam_elemento bytes.
+// Post: Devuelve el pool vacío, NULL si no se pudo crear.
+pool_t* pool_crear(size_t tam_elemento);
+
+// Pide un elemento al pool.
+// Pre: El pool fue creado.
+// Post: Devuelve un elemento sin inicializar, NULL si no hubo memoria.
+void* pool_pedir(pool_t* pool);
+
+// Devuelve al pool un elemento pedido con pool_pedir.
+// Pre: El pool fue creado, y elemento fue pedido a este pool (o es NULL).
+// Post: El elemento puede volver a entregarse en un próximo pool_pedir.
+void pool_devolver(pool_t* pool, void* elemento);
+
+// Devuelve la cantidad de elementos pedidos y todavía no devueltos.
+// Pre: El pool fue creado.
+size_t pool_en_uso(const pool_t* pool);
+
+// Destruye el pool, liberando todos sus bloques. Los elementos que no fueron
+// devueltos dejan de ser válidos.
+// Pre: El pool fue creado.
+void pool_destruir(pool_t* pool);
+
+#endif // POOL_H
@@ -3,22 +3,57 @@
 set -eu
 
 PROGRAMA="$1"
+# Opciones con que se corre el programa, por ejemplo OPCIONES="--repartir 4":
+# la salida tiene que ser la misma. Los scripts las agregan al programa
+# donde corresponde.
+export OPCIONES=${OPCIONES:-}
 VALGRIND="valgrind --leak-check=full --track-origins=yes --error-exitcode=2"
 
 RET=0
 OUT=`mktemp`
 trap "rm -f $OUT" EXIT
 
+# Corre la prueba $b con el comando dado (el programa, precedido o no por
+# valgrind). Si la prueba tiene un script ${b}_sh, éste recibe el comando
+# y arma cada ejecución; si no, se corre con los catálogos de la prueba.
+correr() {
+  if [[ -f ${b}_sh ]]; then
+    bash ${b}_sh "$*" <${b}_in
+  else
+    $* $OPCIONES ${b}_doctores ${b}_pacientes <${b}_in
+  fi
+}
+
+# Corre la prueba $b con valgrind, si está instalado. Con --fin-rapido el
+# programa no libera el catálogo a propósito, así que no se buscan pérdidas.
+correr_valgrind() {
+  if command -v valgrind >/dev/null; then
+    if [[ " $OPCIONES " == *" --fin-rapido "* ]] || grep -qs -- --fin-rapido ${b}_sh; then
+      correr $VALGRIND --leak-check=no $PROGRAMA
+    else
+      correr $VALGRIND $PROGRAMA
+    fi
+  else
+    echo "valgrind no está instalado."
+  fi
+}
+
 for x in *_in; do
   b=${x%_in}
   echo -n "Prueba $b... "
 
-  ($PROGRAMA ${b}_doctores ${b}_pacientes <${b}_in || RET=$?) |
-    diff -u --label "${b}_cátedra" --label "${b}_alumno" ${b}_out - >$OUT || :
+  # Con VARIANTE=nombre, se usa ${b}_out_nombre si la prueba lo tiene
+  ESPERADO=${b}_out
+  if [[ -n ${VARIANTE:-} && -f ${b}_out_${VARIANTE} ]]; then
+    ESPERADO=${b}_out_${VARIANTE}
+  fi
+
+  (correr $PROGRAMA || RET=$?) |
+    diff -u --label "${b}_cátedra" --label "${b}_alumno" $ESPERADO - >$OUT || :
 
   if [[ $RET -ne 0 ]]; then
     echo -e "programa abortó con código $RET.\n\nValgrind:"
-    $VALGRIND $PROGRAMA ${b}_doctores ${b}_pacientes <${b}_in
+    correr_valgrind
     exit $RET
 
   elif [[ -s $OUT ]]; then
@@ -28,7 +63,7 @@ for x in *_in; do
 
   else
     echo -e "OK.\n\nValgrind:"
-    $VALGRIND $PROGRAMA ${b}_doctores ${b}_pacientes <${b}_in >/dev/null
+    correr_valgrind >/dev/null
   fi
   echo
 done
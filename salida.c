@@ -0,0 +1,218 @@
+#include "salida.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TAM_SALIDA 65536     // Los datos más largos se escriben sin copiarlos
+#define MAX_DIGITOS 20       // Dígitos de SIZE_MAX con size_t de 64 bits
+#define BLOQUES_HILO 4       // Buffers en el anillo del hilo que escribe
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Escribe 'largo' bytes en el descriptor, aunque write() escriba menos.
+void salida_escribir_todo(salida_t* salida, const char* datos, size_t largo) {
+	while (!salida->_error && largo > 0) {
+		ssize_t n = write(salida->fd, datos, largo);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) {
+			salida->_error = true;
+			break;
+		}
+		datos += n;
+		largo -= (size_t) n;
+	}
+}
+
+// Escribe 'largo' bytes que no pasan por el buffer: los copia en un bloque
+// para el hilo que escribe si hay uno, o los escribe en el descriptor.
+void salida_enviar(salida_t* salida, const char* datos, size_t largo) {
+	if (!salida->_anillo) {
+		salida_escribir_todo(salida, datos, largo);
+		return;
+	}
+	anillo_bloque_t* bloque = anillo_reservar(salida->_anillo);
+	if (bloque->tam < largo) {
+		char* datos_bloque = realloc(bloque->datos, largo);
+		if (!datos_bloque) {
+			// Se publica vacío, para que no quede reservado
+			salida->_error = true;
+			anillo_publicar(salida->_anillo);
+			return;
+		}
+		bloque->datos = datos_bloque;
+		bloque->tam = largo;
+	}
+	memcpy(bloque->datos, datos, largo);
+	bloque->largo = largo;
+	anillo_publicar(salida->_anillo);
+}
+
+// Agrega 'largo' bytes a una salida en memoria, agrandando su buffer si no
+// alcanza. Sin memoria, los descarta.
+void salida_agregar_en_memoria(salida_t* salida, const char* datos, size_t largo) {
+	// Sin nada que agregar, puede no haber buffer todavía
+	if (!largo) return;
+	if (largo > salida->_tam - salida->_usados) {
+		size_t tam = salida->_tam ? 2 * salida->_tam : TAM_SALIDA;
+		if (tam < salida->_usados + largo) tam = salida->_usados + largo;
+		char* buffer = realloc(salida->_buffer, tam);
+		if (!buffer) {
+			salida->_error = true;
+			return;
+		}
+		salida->_buffer = buffer;
+		salida->_tam = tam;
+	}
+	memcpy(salida->_buffer + salida->_usados, datos, largo);
+	salida->_usados += largo;
+}
+
+// Hilo que escribe en el descriptor los bloques del anillo de la salida.
+// Devuelve NULL si todas las escrituras terminaron bien.
+void* salida_escribir_bloques(void* dato) {
+	const salida_t* salida = dato;
+	salida_t descriptor = {.fd = salida->fd};
+	anillo_bloque_t* bloque;
+	while ((bloque = anillo_tomar(salida->_anillo))) {
+		salida_escribir_todo(&descriptor, bloque->datos, bloque->largo);
+		anillo_devolver(salida->_anillo);
+	}
+	return descriptor._error ? dato : NULL;
+}
+
+// Agrega un número, con el signo '-' adelante si 'negativo' es true.
+void salida_numero(salida_t* salida, size_t numero, bool negativo) {
+	char digitos[MAX_DIGITOS + 1];
+	char* inicio = digitos + sizeof(digitos);
+	do {
+		*--inicio = (char) ('0' + numero % 10);
+		numero /= 10;
+	} while (numero > 0);
+	if (negativo) *--inicio = '-';
+	salida_escribir(salida, inicio, (size_t) (digitos + sizeof(digitos) - inicio));
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA SALIDA
+ * *****************************************************************/
+
+void salida_escribir(salida_t* salida, const char* datos, size_t largo) {
+	if (salida->fd == SALIDA_MEMORIA) {
+		salida_agregar_en_memoria(salida, datos, largo);
+		return;
+	}
+	if (largo > TAM_SALIDA - salida->_usados) {
+		salida_vaciar(salida);
+		if (largo >= TAM_SALIDA) {
+			salida_enviar(salida, datos, largo);
+			return;
+		}
+	}
+	// No hay buffer al empezar, ni si el hilo que escribe no devolvió uno
+	if (!salida->_buffer) {
+		salida->_buffer = malloc(TAM_SALIDA);
+		// Sin buffer, se escribe directamente
+		if (!salida->_buffer) {
+			salida_enviar(salida, datos, largo);
+			return;
+		}
+	}
+	memcpy(salida->_buffer + salida->_usados, datos, largo);
+	salida->_usados += largo;
+}
+
+void salida_cadena(salida_t* salida, const char* cadena) {
+	salida_escribir(salida, cadena, strlen(cadena));
+}
+
+void salida_formato(salida_t* salida, const char* formato, ...) {
+	va_list args;
+	va_start(args, formato);
+	const char* marca;
+	while ((marca = strchr(formato, '%'))) {
+		salida_escribir(salida, formato, (size_t) (marca - formato));
+		formato = marca + 2;
+		if (marca[1] == 's') salida_cadena(salida, va_arg(args, const char*));
+		else if (marca[1] == 'd') {
+			int numero = va_arg(args, int);
+			// Sin negar 'numero', que desborda con INT_MIN
+			salida_numero(salida, numero < 0 ? 0u - (unsigned int) numero : (unsigned int) numero, numero < 0);
+		}
+		else if (marca[1] == 'z' && marca[2] == 'u') {
+			salida_numero(salida, va_arg(args, size_t), false);
+			formato++;
+		}
+		else if (marca[1] == '%') salida_escribir(salida, "%", 1);
+		else {
+			salida_escribir(salida, marca, 1);
+			formato = marca + 1;
+		}
+	}
+	salida_cadena(salida, formato);
+	va_end(args);
+}
+
+bool salida_vaciar(salida_t* salida) {
+	if (salida->_usados == 0 || salida->fd == SALIDA_MEMORIA) return !salida->_error;
+	if (!salida->_anillo) salida_escribir_todo(salida, salida->_buffer, salida->_usados);
+	else {
+		// El buffer pasa al bloque, y el del bloque (ya escrito) a la salida
+		anillo_bloque_t* bloque = anillo_reservar(salida->_anillo);
+		char* escrito = bloque->datos;
+		// Si se reservó para datos más cortos que el buffer, no sirve
+		if (bloque->tam < TAM_SALIDA) {
+			free(escrito);
+			escrito = NULL;
+		}
+		bloque->datos = salida->_buffer;
+		bloque->largo = salida->_usados;
+		bloque->tam = TAM_SALIDA;
+		anillo_publicar(salida->_anillo);
+		salida->_buffer = escrito;
+	}
+	salida->_usados = 0;
+	return !salida->_error;
+}
+
+const char* salida_datos(const salida_t* salida, size_t* largo) {
+	*largo = salida->_usados;
+	return salida->_buffer;
+}
+
+void salida_descartar(salida_t* salida) {
+	salida->_usados = 0;
+}
+
+bool salida_en_hilo(salida_t* salida) {
+	if (salida->_anillo) return true;
+	salida_vaciar(salida);
+	salida->_anillo = anillo_crear(BLOQUES_HILO);
+	if (!salida->_anillo) return false;
+	if (pthread_create(&salida->_hilo, NULL, salida_escribir_bloques, salida) != 0) {
+		anillo_destruir(salida->_anillo);
+		salida->_anillo = NULL;
+		return false;
+	}
+	return true;
+}
+
+bool salida_terminar(salida_t* salida) {
+	salida_vaciar(salida);
+	if (salida->_anillo) {
+		anillo_cerrar(salida->_anillo);
+		void* error;
+		pthread_join(salida->_hilo, &error);
+		if (error) salida->_error = true;
+		anillo_destruir(salida->_anillo);
+		salida->_anillo = NULL;
+	}
+	free(salida->_buffer);
+	salida->_buffer = NULL;
+	salida->_usados = 0;
+	salida->_tam = 0;
+	return !salida->_error;
+}
@@ -0,0 +1,90 @@
+#ifndef SALIDA_H
+#define SALIDA_H
+
+#include "anillo.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Escritura con buffer propio en un descriptor de archivo, en lugar de
+ * printf(): lo escrito se acumula en un único buffer que se reserva la
+ * primera vez y se reutiliza, y sólo se pasa al descriptor (con write())
+ * cuando se llena o al vaciarlo explícitamente con salida_vaciar().
+ *
+ * Los mensajes se arman con salida_formato(), que entiende sólo los
+ * formatos de los mensajes del programa (%s, %d, %zu y %%) y convierte los
+ * números a mano, sin pasar por stdio.
+ *
+ * Con salida_en_hilo(), las escrituras en el descriptor pasan a hacerse en
+ * un hilo aparte: al vaciar la salida, su buffer se entrega entero a ese
+ * hilo por un anillo (ver anillo.h), a cambio de uno ya escrito, sin
+ * copiarlo.
+ *
+ * Una salida cuyo fd es SALIDA_MEMORIA no escribe nada: acumula todo en su
+ * buffer, que crece lo que haga falta, hasta descartarlo.
+ *
+ * Uso
+ * ===
+ *
+ *     salida_t salida = {.fd = STDOUT_FILENO};
+ *     salida_formato(&salida, "%zu paciente(s) en espera para %s\n", cant, nombre);
+ *     salida_vaciar(&salida);
+ *     salida_terminar(&salida);
+ */
+
+#define SALIDA_MEMORIA (-1)
+
+typedef struct salida {
+	int fd;
+	char* _buffer;
+	size_t _usados;
+	size_t _tam;        // Bytes reservados, sólo en memoria
+	bool _error;        // Falló una escritura: se descarta el resto
+	anillo_t* _anillo;  // Buffers para el hilo que escribe, NULL si no hay
+	pthread_t _hilo;
+} salida_t;
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LA SALIDA
+ * *****************************************************************/
+
+// Agrega 'largo' bytes a la salida.
+void salida_escribir(salida_t* salida, const char* datos, size_t largo);
+
+// Agrega una cadena a la salida.
+void salida_cadena(salida_t* salida, const char* cadena);
+
+// Agrega un mensaje a la salida, reemplazando en 'formato' cada %s por una
+// cadena, cada %d por un int, cada %zu por un size_t y cada %% por '%'.
+// Cualquier otro formato se copia tal cual.
+void salida_formato(salida_t* salida, const char* formato, ...);
+
+// Escribe en el descriptor todo lo acumulado, o se lo pasa al hilo que
+// escribe si hay uno. En memoria, no hace nada.
+// Post: Devuelve false si alguna escritura falló (las del hilo que escribe
+// se informan recién en salida_terminar).
+bool salida_vaciar(salida_t* salida);
+
+// Devuelve lo acumulado en una salida en memoria, y guarda su largo en
+// 'largo'. Es válido hasta la siguiente escritura.
+const char* salida_datos(const salida_t* salida, size_t* largo);
+
+// Descarta lo acumulado en una salida en memoria, sin liberar su buffer.
+void salida_descartar(salida_t* salida);
+
+// Lanza un hilo que hace las escrituras en el descriptor a partir de ahora.
+// Pre: La salida no es en memoria.
+// Post: Devuelve false si no se pudo lanzar, y se sigue escribiendo desde
+// el hilo que llama.
+bool salida_en_hilo(salida_t* salida);
+
+// Vacía la salida, espera a que termine el hilo que escribe si hay uno, y
+// libera su buffer. Puede volver a usarse después, sin hilo.
+// Post: Devuelve false si alguna escritura falló.
+bool salida_terminar(salida_t* salida);
+
+#endif // SALIDA_H
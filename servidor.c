@@ -0,0 +1,286 @@
+#define _POSIX_C_SOURCE 200809L  // Para sigaction(), strdup() y MSG_NOSIGNAL.
+#include "servidor.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_EVENTOS 256          // Conexiones listas que se atienden por ronda
+#define TAM_LECTURA 65536        // Bytes que se leen de una conexión por ronda
+#define MAX_LINEA (1 << 20)      // Una línea más larga cierra la conexión
+#define MAX_PENDIENTE (1 << 20)  // Con más respuesta sin enviar, no se leen pedidos
+#define COLA_CONEXIONES 128      // Conexiones sin aceptar que admite listen()
+
+typedef struct conexion {
+	int fd;
+	char* entrada;              // Lo recibido que todavía no se ejecutó
+	size_t recibidos;
+	size_t tam;
+	salida_t respuesta;         // En memoria
+	size_t enviados;            // Parte de la respuesta que ya se envió
+	uint32_t eventos;           // Eventos que se esperan de epoll
+	bool fin_entrada;           // El cliente no va a mandar más
+	bool quedan_lineas;         // Hay líneas completas sin ejecutar
+	bool error;
+	struct conexion* anterior;  // Lista de las conexiones abiertas
+	struct conexion* siguiente;
+} conexion_t;
+
+struct servidor {
+	int fd;                     // Socket que escucha
+	int epoll;
+	char* ruta;                 // NULL hasta que se crea el archivo del socket
+	conexion_t* conexiones;
+};
+
+// Señal que terminó servidor_atender(), 0 si no llegó ninguna
+static volatile sig_atomic_t senial_recibida = 0;
+
+/* *****************************************************************
+ *                    FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+void servidor_anotar_senial(int senial) {
+	senial_recibida = senial;
+}
+
+// Pone un descriptor en modo no bloqueante.
+bool servidor_no_bloquear(int fd) {
+	int flags = fcntl(fd, F_GETFL);
+	return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Devuelve cuántos bytes de la respuesta de la conexión falta enviar.
+size_t conexion_pendiente(const conexion_t* conexion) {
+	size_t largo;
+	salida_datos(&conexion->respuesta, &largo);
+	return largo - conexion->enviados;
+}
+
+// Cierra la conexión y la saca de la lista del servidor.
+void conexion_cerrar(servidor_t* servidor, conexion_t* conexion) {
+	// Al cerrar el descriptor, epoll deja de informar sus eventos
+	close(conexion->fd);
+	if (conexion->anterior) conexion->anterior->siguiente = conexion->siguiente;
+	else servidor->conexiones = conexion->siguiente;
+	if (conexion->siguiente) conexion->siguiente->anterior = conexion->anterior;
+	salida_terminar(&conexion->respuesta);
+	free(conexion->entrada);
+	free(conexion);
+}
+
+// Acepta todas las conexiones que estén esperando.
+void servidor_aceptar(servidor_t* servidor) {
+	while (true) {
+		int fd = accept(servidor->fd, NULL, NULL);
+		if (fd < 0 && errno == EINTR) continue;
+		// Sin más conexiones, o sin descriptores: se reintenta en la próxima ronda
+		if (fd < 0) return;
+		conexion_t* conexion = calloc(1, sizeof(conexion_t));
+		struct epoll_event evento = {.events = EPOLLIN, .data.ptr = conexion};
+		if (!conexion || !servidor_no_bloquear(fd) || epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, fd, &evento) != 0) {
+			free(conexion);
+			close(fd);
+			continue;
+		}
+		conexion->fd = fd;
+		conexion->respuesta.fd = SALIDA_MEMORIA;
+		conexion->eventos = EPOLLIN;
+		conexion->siguiente = servidor->conexiones;
+		if (servidor->conexiones) servidor->conexiones->anterior = conexion;
+		servidor->conexiones = conexion;
+	}
+}
+
+// Lee lo que haya llegado por la conexión, hasta TAM_LECTURA bytes.
+void conexion_leer(conexion_t* conexion) {
+	if (conexion->tam - conexion->recibidos < TAM_LECTURA) {
+		size_t tam = conexion->tam ? 2 * conexion->tam : TAM_LECTURA;
+		if (tam < conexion->recibidos + TAM_LECTURA) tam = conexion->recibidos + TAM_LECTURA;
+		char* entrada = realloc(conexion->entrada, tam);
+		if (!entrada) {
+			conexion->error = true;
+			return;
+		}
+		conexion->entrada = entrada;
+		conexion->tam = tam;
+	}
+	ssize_t n;
+	do {
+		n = read(conexion->fd, conexion->entrada + conexion->recibidos, TAM_LECTURA);
+	} while (n < 0 && errno == EINTR);
+	if (n > 0) conexion->recibidos += (size_t) n;
+	else if (n == 0) conexion->fin_entrada = true;
+	else if (errno != EAGAIN && errno != EWOULDBLOCK) conexion->error = true;
+}
+
+// Ejecuta las líneas completas recibidas por la conexión, mientras no
+// tenga demasiada respuesta pendiente. Si el cliente ya no va a mandar más,
+// lo que quede sin '\n' es la última línea, igual que al leer de stdin.
+void conexion_ejecutar(conexion_t* conexion, servidor_ejecutar_t ejecutar, void* extra) {
+	size_t inicio = 0;
+	conexion->quedan_lineas = false;
+	while (inicio < conexion->recibidos) {
+		char* fin = memchr(conexion->entrada + inicio, '\n', conexion->recibidos - inicio);
+		if (!fin && !conexion->fin_entrada) break;
+		if (conexion_pendiente(conexion) > MAX_PENDIENTE) {
+			conexion->quedan_lineas = true;
+			break;
+		}
+		// La última línea puede usar el byte siguiente como su '\n': la
+		// lectura que encontró el fin de la entrada dejó lugar libre
+		size_t largo = fin ? (size_t) (fin - (conexion->entrada + inicio)) : conexion->recibidos - inicio;
+		ejecutar(conexion->entrada + inicio, largo, &conexion->respuesta, extra);
+		salida_escribir(&conexion->respuesta, "\n", 1);
+		inicio += fin ? largo + 1 : largo;
+	}
+	if (inicio > 0) {
+		memmove(conexion->entrada, conexion->entrada + inicio, conexion->recibidos - inicio);
+		conexion->recibidos -= inicio;
+	}
+	if (conexion->recibidos > MAX_LINEA) conexion->error = true;
+}
+
+// Envía lo que se pueda de la respuesta de la conexión.
+void conexion_enviar(conexion_t* conexion) {
+	size_t largo;
+	const char* datos = salida_datos(&conexion->respuesta, &largo);
+	while (conexion->enviados < largo) {
+		ssize_t n = send(conexion->fd, datos + conexion->enviados, largo - conexion->enviados, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+		if (n <= 0) {
+			conexion->error = true;
+			return;
+		}
+		conexion->enviados += (size_t) n;
+	}
+	salida_descartar(&conexion->respuesta);
+	conexion->enviados = 0;
+}
+
+// Envía la respuesta de una conexión que estuvo lista en la ronda, y
+// actualiza los eventos que se esperan de ella, o la cierra si terminó.
+void servidor_terminar_conexion(servidor_t* servidor, conexion_t* conexion) {
+	if (!conexion->error) conexion_enviar(conexion);
+	size_t pendiente = conexion_pendiente(conexion);
+	bool termino = conexion->fin_entrada && !pendiente && !conexion->quedan_lineas;
+	if (conexion->error || termino) {
+		conexion_cerrar(servidor, conexion);
+		return;
+	}
+	// Con líneas sin ejecutar, se espera a poder escribir para volver a
+	// tenerla en una ronda
+	uint32_t eventos = 0;
+	if (!conexion->fin_entrada && pendiente <= MAX_PENDIENTE) eventos |= EPOLLIN;
+	if (pendiente || conexion->quedan_lineas) eventos |= EPOLLOUT;
+	if (eventos == conexion->eventos) return;
+	struct epoll_event evento = {.events = eventos, .data.ptr = conexion};
+	if (epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, conexion->fd, &evento) != 0) {
+		conexion_cerrar(servidor, conexion);
+		return;
+	}
+	conexion->eventos = eventos;
+}
+
+// Atiende una ronda con las conexiones listas en 'eventos'.
+void servidor_ronda(servidor_t* servidor, struct epoll_event eventos[], int cantidad, servidor_ejecutar_t ejecutar, servidor_ronda_t empezar_ronda, servidor_ronda_t terminar_ronda, void* extra) {
+	for (int i = 0; i < cantidad; i++) {
+		conexion_t* conexion = eventos[i].data.ptr;
+		if (!conexion) servidor_aceptar(servidor);
+		else if (eventos[i].events & EPOLLERR) conexion->error = true;
+		else if (eventos[i].events & (EPOLLIN | EPOLLHUP) && !conexion->fin_entrada) conexion_leer(conexion);
+	}
+	if (empezar_ronda) empezar_ronda(extra);
+	for (int i = 0; i < cantidad; i++) {
+		conexion_t* conexion = eventos[i].data.ptr;
+		if (conexion && !conexion->error) conexion_ejecutar(conexion, ejecutar, extra);
+	}
+	if (terminar_ronda) terminar_ronda(extra);
+	for (int i = 0; i < cantidad; i++) {
+		conexion_t* conexion = eventos[i].data.ptr;
+		if (conexion) servidor_terminar_conexion(servidor, conexion);
+	}
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL SERVIDOR
+ * *****************************************************************/
+
+servidor_t* servidor_crear(const char* ruta) {
+	struct sockaddr_un direccion = {.sun_family = AF_UNIX};
+	if (strlen(ruta) >= sizeof(direccion.sun_path)) return NULL;
+	strcpy(direccion.sun_path, ruta);
+	servidor_t* servidor = calloc(1, sizeof(servidor_t));
+	if (!servidor) return NULL;
+	servidor->epoll = epoll_create1(0);
+	servidor->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (servidor->epoll < 0 || servidor->fd < 0) {
+		servidor_destruir(servidor);
+		return NULL;
+	}
+	unlink(ruta);
+	if (bind(servidor->fd, (struct sockaddr*) &direccion, sizeof(direccion)) != 0) {
+		servidor_destruir(servidor);
+		return NULL;
+	}
+	servidor->ruta = strdup(ruta);
+	struct epoll_event evento = {.events = EPOLLIN, .data.ptr = NULL};
+	if (!servidor->ruta || !servidor_no_bloquear(servidor->fd) || listen(servidor->fd, COLA_CONEXIONES) != 0
+	    || epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, servidor->fd, &evento) != 0) {
+		if (!servidor->ruta) unlink(ruta);
+		servidor_destruir(servidor);
+		return NULL;
+	}
+	return servidor;
+}
+
+bool servidor_atender(servidor_t* servidor, servidor_ejecutar_t ejecutar, servidor_ronda_t empezar_ronda, servidor_ronda_t terminar_ronda, void* extra) {
+	// Las señales quedan bloqueadas salvo mientras se espera en epoll, para
+	// no perder una que llegue entre que se mira si llegó y se espera
+	sigset_t bloqueadas, anteriores, al_esperar;
+	sigemptyset(&bloqueadas);
+	sigaddset(&bloqueadas, SIGINT);
+	sigaddset(&bloqueadas, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &bloqueadas, &anteriores);
+	al_esperar = anteriores;
+	sigdelset(&al_esperar, SIGINT);
+	sigdelset(&al_esperar, SIGTERM);
+	struct sigaction accion = {.sa_handler = servidor_anotar_senial}, accion_int, accion_term;
+	sigemptyset(&accion.sa_mask);
+	sigaction(SIGINT, &accion, &accion_int);
+	sigaction(SIGTERM, &accion, &accion_term);
+	senial_recibida = 0;
+
+	bool ok = true;
+	struct epoll_event eventos[MAX_EVENTOS];
+	while (!senial_recibida) {
+		int cantidad = epoll_pwait(servidor->epoll, eventos, MAX_EVENTOS, -1, &al_esperar);
+		if (cantidad < 0 && errno == EINTR) continue;
+		if (cantidad < 0) {
+			ok = false;
+			break;
+		}
+		servidor_ronda(servidor, eventos, cantidad, ejecutar, empezar_ronda, terminar_ronda, extra);
+	}
+
+	sigaction(SIGINT, &accion_int, NULL);
+	sigaction(SIGTERM, &accion_term, NULL);
+	pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+	return ok;
+}
+
+void servidor_destruir(servidor_t* servidor) {
+	while (servidor->conexiones) conexion_cerrar(servidor, servidor->conexiones);
+	if (servidor->fd >= 0) close(servidor->fd);
+	if (servidor->epoll >= 0) close(servidor->epoll);
+	if (servidor->ruta) unlink(servidor->ruta);
+	free(servidor->ruta);
+	free(servidor);
+}
@@ -0,0 +1,65 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include "salida.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Servidor de líneas en un socket local (AF_UNIX), que atiende a muchos
+ * clientes a la vez desde un único hilo, con sockets no bloqueantes y
+ * epoll.
+ *
+ * El servidor trabaja por rondas: espera a que alguna conexión esté lista,
+ * lee lo que llegó por cada una de las que lo están, y ejecuta todas las
+ * líneas completas recibidas, de a una conexión por vez y en orden. Cada
+ * línea se pasa a la función de ejecución sin su '\n', y su respuesta se
+ * escribe en la salida en memoria de la conexión (ver salida.h), seguida
+ * de una línea vacía para que el cliente sepa dónde termina. Al terminar
+ * la ronda se envían las respuestas; lo que no se pudo enviar queda para
+ * cuando la conexión acepte más datos, y mientras tenga demasiado
+ * pendiente no se leen sus pedidos.
+ *
+ * Uso
+ * ===
+ *
+ *     servidor_t* servidor = servidor_crear("/tmp/clinica.sock");
+ *     servidor_atender(servidor, ejecutar, empezar_ronda, terminar_ronda, extra);
+ *     servidor_destruir(servidor);
+ */
+
+typedef struct servidor servidor_t;
+
+// Función que ejecuta una línea de 'largo' bytes (sin contar su '\n', que
+// puede reemplazar) y escribe la respuesta en 'respuesta'. La respuesta no
+// debe tener líneas vacías.
+typedef void (*servidor_ejecutar_t)(char* linea, size_t largo, salida_t* respuesta, void* extra);
+
+// Función que se llama en cada ronda, antes de ejecutar sus líneas o
+// después de ejecutarlas (antes de enviar las respuestas).
+typedef void (*servidor_ronda_t)(void* extra);
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL SERVIDOR
+ * *****************************************************************/
+
+// Crea el socket 'ruta', y empieza a escuchar en él. Si ya existía un
+// archivo con ese nombre, lo reemplaza.
+// Post: Devuelve el servidor, NULL si no se pudo crear.
+servidor_t* servidor_crear(const char* ruta);
+
+// Atiende a los clientes hasta recibir SIGINT o SIGTERM. 'empezar_ronda' y
+// 'terminar_ronda' pueden ser NULL.
+// Pre: El servidor fue creado.
+// Post: Devuelve false si terminó por un error.
+bool servidor_atender(servidor_t* servidor, servidor_ejecutar_t ejecutar, servidor_ronda_t empezar_ronda, servidor_ronda_t terminar_ronda, void* extra);
+
+// Cierra todas las conexiones y el socket, borra su archivo, y destruye
+// el servidor.
+// Pre: El servidor fue creado.
+void servidor_destruir(servidor_t* servidor);
+
+#endif // SERVIDOR_H